@@ -1,187 +1,562 @@
-/********************************************************************************
-* button.h: Innehller funktionsdefinitioner fr enkel implementering av 
-*           tryckknappar samt andra digitala inportar via strukten button.
-********************************************************************************/
-#include "button.h"
-
-/********************************************************************************
-* button_init: Initierar ny tryckknapp p angiven pin.
-*
-*              - self: Pekare till tryckknappen som ska initieras.
-*              - pin : Tryckknappens pin-nummer p Arduino Uno, exempelvis 13.
-*                      Alternativt kan motsvarande port-nummer p ATmega328P
-*                      anges, exempelvis B5 fr pin 13 eller D3 fr pin 3.
-********************************************************************************/
-void button_init(struct button* self,
-                 const uint8_t pin)
-{
-   if (pin >= 0 && pin <= 7)
-   {
-      self->io_port = IO_PORTD;
-      self->pin = pin;
-      PORTD |= (1 << self->pin);
-   }
-   else if (pin >= 8 && pin <= 13)
-   {
-      self->io_port = IO_PORTB;
-      self->pin = pin - 8;
-      PORTB |= (1 << self->pin);
-   }
-   else if (pin >= 14 && pin <= 19)
-   {
-      self->io_port = IO_PORTC;
-      self->pin = pin - 14;
-      PORTC |= (1 << self->pin);
-   }
-   else
-   {
-      self->io_port = IO_PORT_NONE;
-      self->pin = 0;
-   }
-
-   self->interrupt_enabled = false;
-   return;
-}
-
-/********************************************************************************
-* button_clear: Nollstller tryckknapp samt motsvarande pin.
-*
-*               - self: Pekare till tryckknappen som ska nollstllas.
-********************************************************************************/
-void button_clear(struct button* self)
-{
-   button_disable_interrupt(self);
-
-   if (self->io_port == IO_PORTB)
-   {
-      PORTB &= ~(1 << self->pin);
-   }
-   else if (self->io_port == IO_PORTC)
-   {
-      PORTC &= ~(1 << self->pin);
-   }
-   else if (self->io_port == IO_PORTD)
-   {
-      PORTD &= ~(1 << self->pin);
-   }
-
-   self->io_port = IO_PORT_NONE;
-   self->pin = 0;
-   return;
-}
-
-/********************************************************************************
-* button_is_pressed: Lser av tryckknappens pin och indikerar ifall denna r
-*                    nedtryckt. I s fall returneras true, annars false.
-*
-*                    - self: Pekare till tryckknappen som ska lsas av.
-********************************************************************************/
-bool button_is_pressed(const struct button* self)
-{
-   if (self->io_port == IO_PORTB)
-   {
-      return (PINB & (1 << self->pin));
-   }
-   else if (self->io_port == IO_PORTC)
-   {
-      return (PINC & (1 << self->pin));
-   }
-   else if (self->io_port == IO_PORTD)
-   {
-      return (PIND & (1 << self->pin));
-   }
-   else
-   {
-      return false;
-   }
-}
-
-/********************************************************************************
-* button_enable_interrupt: Aktiverar PCI-avbrott p angiven tryckknapp s att
-*                          event p tryckknappens pin medfr avbrott, bde p
-*                          stigande och fallande flank. Kontroll av flank mste
-*                          sktas av anvndaren, frslagsvis via avlsning i
-*                          motsvarande avbrottsrutin.
-*
-*                          Nedan visas sambandet mellan anvnd I/O-port samt
-*                          avbrottsvektorn fr motsvarande avbrottsrutin:
-*
-*                          I/O-port     pin (Arduino Uno)     Avbrottsvektor
-*                             B              8 - 13             PCINT0_vect
-*                             C             A0 - A5             PCINT1_vect
-*                             D              0 - 7              PCINT2_vect
-*
-*                          - self: Pekare till tryckknappen som PCI-avbrott
-*                                  ska aktiveras p.
-********************************************************************************/
-void button_enable_interrupt(struct button* self)
-{
-   asm("SEI");
-
-   if (self->io_port == IO_PORTB)
-   {
-      PCICR |= (1 << PCIE0);
-      PCMSK0 |= (1 << self->pin);
-   }
-   else if (self->io_port == IO_PORTC)
-   {
-      PCICR |= (1 << PCIE1);
-      PCMSK1 |= (1 << self->pin);
-   }
-   else if (self->io_port == IO_PORTD)
-   {
-      PCICR |= (1 << PCIE2);
-      PCMSK2 |= (1 << self->pin);
-   }
-
-   self->interrupt_enabled = true;
-   return;
-}
-
-/********************************************************************************
-* button_disable_interrupt: Inaktiverar PCI-avbrott p angiven tryckknapp.
-*
-*                           - self: Pekare till tryckknappen som PCI-avbrott
-*                                  ska inaktiveras p.
-********************************************************************************/
-void button_disable_interrupt(struct button* self)
-{
-   if (self->io_port == IO_PORTB)
-   {
-      PCMSK0 &= ~(1 << self->pin);
-   }
-   else if (self->io_port == IO_PORTC)
-   {
-      PCMSK1 &= ~(1 << self->pin);
-   }
-   else if (self->io_port == IO_PORTD)
-   {
-      PCMSK2 &= ~(1 << self->pin);
-   }
-
-   self->interrupt_enabled = false;
-   return;
-}
-
-/********************************************************************************
-* button_togglar_interrupt: Togglar aktivering av PCI-avbrott p angiven
-*                           tryckknapp. Om avbrott r aktiverat vid anrop
-*                           s sker inaktivering. P samma stt gller att om
-*                           avbrott r inaktiverat vid anrop s sker aktivering.
-*
-*                           - self: Pekare till tryckknappen som aktivering av
-*                                   PCI-avbrott ska inaktiveras p.
-********************************************************************************/
-void button_toggle_interrupt(struct button* self)
-{
-   if (self->interrupt_enabled)
-   {
-      button_disable_interrupt(self);
-   }
-   else
-   {
-      button_enable_interrupt(self);
-   }
-
-   return;
+/********************************************************************************
+* button.h: Innehåller funktionsdefinitioner för enkel implementering av 
+*           tryckknappar samt andra digitala inportar via strukten button.
+********************************************************************************/
+#include "button.h"
+
+/* Statiska funktioner: */
+static uint8_t button_port_read(const enum io_port io_port);
+static void button_pcint_handle(const enum io_port io_port,
+                                const uint8_t pins,
+                                const uint8_t enabled_pins);
+static void button_debounce_tick(void);
+static uint8_t button_debounce_sample(const enum io_port io_port);
+
+/* Statiska variabler för PCI-avbrott (index motsvarar enum io_port samt pin): */
+static struct button* button_interrupt_buttons[IO_PORT_NONE][8];    /* Registrerade tryckknappar. */
+static uint8_t button_pcint_snapshots[IO_PORT_NONE];                /* Senast avlästa portvärden. */
+static struct button_event button_event_queue[BUTTON_EVENT_QUEUE_SIZE]; /* Händelsekö (ringbuffert). */
+static volatile uint8_t button_event_head = 0;                      /* Nästa plats att skriva (avbrott). */
+static volatile uint8_t button_event_tail = 0;                      /* Nästa plats att läsa (huvudloop). */
+static volatile uint16_t button_event_num_dropped = 0;              /* Förkastade händelser vid full kö. */
+
+/* Statiska variabler för avstudsning (index motsvarar enum io_port): */
+static volatile uint8_t button_debounce_states[IO_PORT_NONE];   /* Avstudsat tillstånd. */
+static volatile uint8_t button_debounce_presses[IO_PORT_NONE];  /* Okvitterade nedtryckningar. */
+static volatile uint8_t button_debounce_releases[IO_PORT_NONE]; /* Okvitterade släpp. */
+static uint8_t button_debounce_count0[IO_PORT_NONE];            /* Vertikal räknare, bit 0. */
+static uint8_t button_debounce_count1[IO_PORT_NONE];            /* Vertikal räknare, bit 1. */
+static uint8_t button_debounce_divider = 0;                     /* Millisekunder till nästa avläsning. */
+
+/********************************************************************************
+* button_init: Initierar ny tryckknapp på angiven pin.
+*
+*              - self: Pekare till tryckknappen som ska initieras.
+*              - pin : Tryckknappens pin-nummer på Arduino Uno, exempelvis 13.
+*                      Alternativt kan motsvarande port-nummer på ATmega328P
+*                      anges, exempelvis B5 för pin 13 eller D3 för pin 3.
+********************************************************************************/
+void button_init(struct button* self,
+                 const uint8_t pin)
+{
+   if (pin >= 0 && pin <= 7)
+   {
+      self->io_port = IO_PORTD;
+      self->pin = pin;
+      REG_SET(PORTD, 1 << self->pin);
+   }
+   else if (pin >= 8 && pin <= 13)
+   {
+      self->io_port = IO_PORTB;
+      self->pin = pin - 8;
+      REG_SET(PORTB, 1 << self->pin);
+   }
+   else if (pin >= 14 && pin <= 19)
+   {
+      self->io_port = IO_PORTC;
+      self->pin = pin - 14;
+      REG_SET(PORTC, 1 << self->pin);
+   }
+   else
+   {
+      self->io_port = IO_PORT_NONE;
+      self->pin = 0;
+   }
+
+   self->interrupt_enabled = false;
+   return;
+}
+
+/********************************************************************************
+* button_clear: Nollställer tryckknapp samt motsvarande pin.
+*
+*               - self: Pekare till tryckknappen som ska nollställas.
+********************************************************************************/
+void button_clear(struct button* self)
+{
+   button_disable_interrupt(self);
+
+   if (self->io_port == IO_PORTB)
+   {
+      REG_CLEAR(PORTB, 1 << self->pin);
+   }
+   else if (self->io_port == IO_PORTC)
+   {
+      REG_CLEAR(PORTC, 1 << self->pin);
+   }
+   else if (self->io_port == IO_PORTD)
+   {
+      REG_CLEAR(PORTD, 1 << self->pin);
+   }
+
+   self->io_port = IO_PORT_NONE;
+   self->pin = 0;
+   return;
+}
+
+/********************************************************************************
+* button_is_pressed: Läser av tryckknappens pin och indikerar ifall denna är
+*                    nedtryckt. I så fall returneras true, annars false.
+*
+*                    - self: Pekare till tryckknappen som ska läsas av.
+********************************************************************************/
+bool button_is_pressed(const struct button* self)
+{
+   if (self->io_port == IO_PORTB)
+   {
+      return (REG_READ(PINB) & (1 << self->pin));
+   }
+   else if (self->io_port == IO_PORTC)
+   {
+      return (REG_READ(PINC) & (1 << self->pin));
+   }
+   else if (self->io_port == IO_PORTD)
+   {
+      return (REG_READ(PIND) & (1 << self->pin));
+   }
+   else
+   {
+      return false;
+   }
+}
+
+/********************************************************************************
+* button_enable_interrupt: Aktiverar PCI-avbrott på angiven tryckknapp så att
+*                          event på tryckknappens pin medför avbrott, både på
+*                          stigande och fallande flank. Kontroll av flank måste
+*                          skötas av användaren, förslagsvis via avläsning i
+*                          motsvarande avbrottsrutin.
+*
+*                          Nedan visas sambandet mellan använd I/O-port samt
+*                          avbrottsvektorn för motsvarande avbrottsrutin:
+*
+*                          I/O-port     pin (Arduino Uno)     Avbrottsvektor
+*                             B              8 - 13             PCINT0_vect
+*                             C             A0 - A5             PCINT1_vect
+*                             D              0 - 7              PCINT2_vect
+*
+*                          - self: Pekare till tryckknappen som PCI-avbrott
+*                                  ska aktiveras på.
+********************************************************************************/
+void button_enable_interrupt(struct button* self)
+{
+   timer_init();
+
+   if (self->io_port != IO_PORT_NONE)
+   {
+      const uint8_t mask = 1 << self->pin;
+
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+      {
+         button_interrupt_buttons[self->io_port][self->pin] = self;
+         button_pcint_snapshots[self->io_port] &= ~mask;
+         button_pcint_snapshots[self->io_port] |= button_port_read(self->io_port) & mask;
+      }
+   }
+
+   sei();
+
+   if (self->io_port == IO_PORTB)
+   {
+      REG_SET(PCICR, 1 << PCIE0);
+      REG_SET(PCMSK0, 1 << self->pin);
+   }
+   else if (self->io_port == IO_PORTC)
+   {
+      REG_SET(PCICR, 1 << PCIE1);
+      REG_SET(PCMSK1, 1 << self->pin);
+   }
+   else if (self->io_port == IO_PORTD)
+   {
+      REG_SET(PCICR, 1 << PCIE2);
+      REG_SET(PCMSK2, 1 << self->pin);
+   }
+
+   self->interrupt_enabled = true;
+   return;
+}
+
+/********************************************************************************
+* button_disable_interrupt: Inaktiverar PCI-avbrott på angiven tryckknapp.
+*
+*                           - self: Pekare till tryckknappen som PCI-avbrott
+*                                  ska inaktiveras på.
+********************************************************************************/
+void button_disable_interrupt(struct button* self)
+{
+   if (self->io_port == IO_PORTB)
+   {
+      REG_CLEAR(PCMSK0, 1 << self->pin);
+   }
+   else if (self->io_port == IO_PORTC)
+   {
+      REG_CLEAR(PCMSK1, 1 << self->pin);
+   }
+   else if (self->io_port == IO_PORTD)
+   {
+      REG_CLEAR(PCMSK2, 1 << self->pin);
+   }
+
+   if (self->io_port != IO_PORT_NONE)
+   {
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+      {
+         button_interrupt_buttons[self->io_port][self->pin] = 0;
+      }
+   }
+
+   self->interrupt_enabled = false;
+   return;
+}
+
+/********************************************************************************
+* button_togglar_interrupt: Togglar aktivering av PCI-avbrott på angiven
+*                           tryckknapp. Om avbrott är aktiverat vid anrop
+*                           så sker inaktivering. På samma sätt gäller att om
+*                           avbrott är inaktiverat vid anrop så sker aktivering.
+*
+*                           - self: Pekare till tryckknappen som aktivering av
+*                                   PCI-avbrott ska inaktiveras på.
+********************************************************************************/
+void button_toggle_interrupt(struct button* self)
+{
+   if (self->interrupt_enabled)
+   {
+      button_disable_interrupt(self);
+   }
+   else
+   {
+      button_enable_interrupt(self);
+   }
+
+   return;
+}
+
+/********************************************************************************
+* button_pin_read: Läser av tryckknapp ansluten till angiven pin, där
+*                  pin-numret inte är känt vid kompilering.
+*
+*                  - pin: Tryckknappens pin-nummer på Arduino Uno.
+********************************************************************************/
+bool button_pin_read(const uint8_t pin)
+{
+   if (pin <= 7) return REG_READ(PIND) & PIN_MASK(pin);
+   if (pin <= 13) return REG_READ(PINB) & PIN_MASK(pin);
+   if (pin <= 19) return REG_READ(PINC) & PIN_MASK(pin);
+   return false;
+}
+
+/********************************************************************************
+* button_event_poll: Hämtar äldsta händelse ur händelsekön. Ifall kön är tom
+*                    returneras false, annars true. Endast huvudloopen
+*                    skriver till button_event_tail och endast
+*                    avbrottsrutinerna till button_event_head, varför
+*                    avbrott inte behöver inaktiveras. Kompilatorbarriärer
+*                    säkerställer att platsen läses efter att
+*                    button_event_head har lästs och innan den lämnas
+*                    tillbaka till avbrottsrutinerna via button_event_tail.
+*
+*                    - event: Pekare till strukt där händelsen lagras.
+********************************************************************************/
+bool button_event_poll(struct button_event* event)
+{
+   const uint8_t tail = button_event_tail;
+   if (tail == button_event_head) return false;
+
+   COMPILER_BARRIER();
+   *event = button_event_queue[tail];
+   COMPILER_BARRIER();
+   button_event_tail = (tail + 1) & (BUTTON_EVENT_QUEUE_SIZE - 1);
+   return true;
+}
+
+/********************************************************************************
+* button_event_dropped: Returnerar antalet händelser som har förkastats
+*                       eftersom händelsekön var full.
+********************************************************************************/
+uint16_t button_event_dropped(void)
+{
+   uint16_t dropped;
+
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      dropped = button_event_num_dropped;
+   }
+
+   return dropped;
+}
+
+/********************************************************************************
+* button_debounce_start: Startar avstudsning av samtliga inportar på I/O-port
+*                        B, C och D. Aktuellt tillstånd på portarna används
+*                        som avstudsat utgångsläge. Ifall systemticken saknar
+*                        ledig plats returneras felkod 1, annars returneras 0.
+********************************************************************************/
+int button_debounce_start(void)
+{
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      for (uint8_t i = 0; i < IO_PORT_NONE; ++i)
+      {
+         button_debounce_states[i] = button_debounce_sample(i);
+         button_debounce_presses[i] = 0;
+         button_debounce_releases[i] = 0;
+         button_debounce_count0[i] = 0xFF;
+         button_debounce_count1[i] = 0xFF;
+      }
+
+      button_debounce_divider = BUTTON_DEBOUNCE_INTERVAL_MS;
+   }
+
+   return timer_attach(button_debounce_tick);
+}
+
+/********************************************************************************
+* button_debounce_stop: Stoppar avstudsningen. Senast avstudsade tillstånd
+*                       behålls.
+********************************************************************************/
+void button_debounce_stop(void)
+{
+   timer_detach(button_debounce_tick);
+   return;
+}
+
+/********************************************************************************
+* button_debounce_is_stable: Indikerar ifall samtliga tryckknappars avstudsade
+*                            tillstånd överensstämmer med aktuell insignal,
+*                            dvs. att ingen avstudsning pågår.
+********************************************************************************/
+bool button_debounce_is_stable(void)
+{
+   return button_debounce_states[IO_PORTB] == button_debounce_sample(IO_PORTB) &&
+          button_debounce_states[IO_PORTC] == button_debounce_sample(IO_PORTC) &&
+          button_debounce_states[IO_PORTD] == button_debounce_sample(IO_PORTD);
+}
+
+/********************************************************************************
+* button_debounce_state: Returnerar avstudsat tillstånd för angiven I/O-port,
+*                        där ettställda bitar motsvarar nedtryckta knappar.
+*
+*                        - io_port: I/O-porten vars tillstånd ska returneras.
+********************************************************************************/
+uint8_t button_debounce_state(const enum io_port io_port)
+{
+   return io_port < IO_PORT_NONE ? button_debounce_states[io_port] : 0;
+}
+
+/********************************************************************************
+* button_debounce_pressed: Returnerar bitmask över pinnar på angiven I/O-port
+*                          som har tryckts ned sedan föregående anrop, och
+*                          nollställer därefter masken.
+*
+*                          - io_port: I/O-porten vars flanker ska returneras.
+********************************************************************************/
+uint8_t button_debounce_pressed(const enum io_port io_port)
+{
+   uint8_t presses = 0;
+   if (io_port >= IO_PORT_NONE) return 0;
+
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      presses = button_debounce_presses[io_port];
+      button_debounce_presses[io_port] = 0;
+   }
+
+   return presses;
+}
+
+/********************************************************************************
+* button_debounce_released: Returnerar bitmask över pinnar på angiven I/O-port
+*                           som har släppts sedan föregående anrop, och
+*                           nollställer därefter masken.
+*
+*                           - io_port: I/O-porten vars flanker ska returneras.
+********************************************************************************/
+uint8_t button_debounce_released(const enum io_port io_port)
+{
+   uint8_t releases = 0;
+   if (io_port >= IO_PORT_NONE) return 0;
+
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      releases = button_debounce_releases[io_port];
+      button_debounce_releases[io_port] = 0;
+   }
+
+   return releases;
+}
+
+/********************************************************************************
+* button_is_pressed_debounced: Indikerar ifall angiven tryckknapp är nedtryckt
+*                              enligt avstudsat tillstånd.
+*
+*                              - self: Pekare till tryckknappen.
+********************************************************************************/
+bool button_is_pressed_debounced(const struct button* self)
+{
+   return button_debounce_state(self->io_port) & (1 << self->pin);
+}
+
+/********************************************************************************
+* button_was_pressed: Indikerar ifall angiven tryckknapp har tryckts ned sedan
+*                     föregående anrop enligt avstudsat tillstånd. Flanken
+*                     kvitteras, övriga pinnars flanker påverkas inte.
+*
+*                     - self: Pekare till tryckknappen.
+********************************************************************************/
+bool button_was_pressed(const struct button* self)
+{
+   const uint8_t mask = 1 << self->pin;
+   bool pressed = false;
+   if (self->io_port >= IO_PORT_NONE) return false;
+
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      pressed = button_debounce_presses[self->io_port] & mask;
+      button_debounce_presses[self->io_port] &= ~mask;
+   }
+
+   return pressed;
+}
+
+/********************************************************************************
+* button_debounce_tick: Callbackrutin som anropas från systemticken en gång
+*                       per millisekund. Var BUTTON_DEBOUNCE_INTERVAL_MS:e
+*                       millisekund läses tryckknapparna på samtliga portar
+*                       av (se button_debounce_sample) och matas genom
+*                       de vertikala räknarna, där bit n i count0 och count1
+*                       utgör en 2-bitars räknare för pin n. Räknaren för en
+*                       pin räknas ned vid varje avläsning som skiljer sig
+*                       från avstudsat tillstånd och nollställs annars. När
+*                       räknaren slår runt byts tillståndet för pinnen.
+********************************************************************************/
+static void button_debounce_tick(void)
+{
+   if (--button_debounce_divider) return;
+   button_debounce_divider = BUTTON_DEBOUNCE_INTERVAL_MS;
+
+   const uint8_t samples[IO_PORT_NONE] =
+   {
+      button_debounce_sample(IO_PORTB),
+      button_debounce_sample(IO_PORTC),
+      button_debounce_sample(IO_PORTD)
+   };
+
+   for (uint8_t i = 0; i < IO_PORT_NONE; ++i)
+   {
+      uint8_t changed = button_debounce_states[i] ^ samples[i];
+      button_debounce_count0[i] = ~(button_debounce_count0[i] & changed);
+      button_debounce_count1[i] = button_debounce_count0[i] ^ (button_debounce_count1[i] & changed);
+      changed &= button_debounce_count0[i] & button_debounce_count1[i];
+
+      const uint8_t state = button_debounce_states[i] ^ changed;
+      button_debounce_states[i] = state;
+      button_debounce_presses[i] |= state & changed;
+      button_debounce_releases[i] |= ~state & changed;
+   }
+
+   return;
+}
+
+/********************************************************************************
+* button_port_read: Läser av insignalerna på angiven I/O-port.
+*
+*                   - io_port: I/O-porten som ska läsas av.
+********************************************************************************/
+static uint8_t button_port_read(const enum io_port io_port)
+{
+   if (io_port == IO_PORTB) return REG_READ(PINB);
+   if (io_port == IO_PORTC) return REG_READ(PINC);
+   if (io_port == IO_PORTD) return REG_READ(PIND);
+   return 0;
+}
+
+/********************************************************************************
+* button_debounce_sample: Läser av insignalerna på angiven I/O-port för
+*                         avstudsning. Endast inportar med aktiverad
+*                         pullup-resistor, dvs. pinnar initierade via
+*                         button_init eller button_pin_init, tas med.
+*                         Utportar, exempelvis lysdioder, samt oanvända
+*                         inportar utan pullup-resistor läses alltid som 0,
+*                         så att de varken ger händelser eller hindrar
+*                         avstudsningen från att bli stabil.
+*
+*                         - io_port: I/O-porten som ska läsas av.
+********************************************************************************/
+static uint8_t button_debounce_sample(const enum io_port io_port)
+{
+   if (io_port == IO_PORTB) return REG_READ(PINB) & REG_READ(PORTB) & ~REG_READ(DDRB);
+   if (io_port == IO_PORTC) return REG_READ(PINC) & REG_READ(PORTC) & ~REG_READ(DDRC);
+   if (io_port == IO_PORTD) return REG_READ(PIND) & REG_READ(PORTD) & ~REG_READ(DDRD);
+   return 0;
+}
+
+/********************************************************************************
+* button_pcint_handle: Jämför angivet portvärde mot senast avlästa värde och
+*                      lägger en händelse i händelsekön för varje
+*                      registrerad tryckknapp vars pin har ändrats. Ifall kön
+*                      är full förkastas händelsen och räknas. Platsen
+*                      fylls i innan den publiceras via button_event_head.
+*
+*                      - io_port     : I/O-porten som avbrottet avser.
+*                      - pins        : Aktuellt värde på porten.
+*                      - enabled_pins: Pinnar med aktiverat PCI-avbrott.
+********************************************************************************/
+static void button_pcint_handle(const enum io_port io_port,
+                                const uint8_t pins,
+                                const uint8_t enabled_pins)
+{
+   const uint8_t changed = (pins ^ button_pcint_snapshots[io_port]) & enabled_pins;
+   button_pcint_snapshots[io_port] = pins;
+   if (!changed) return;
+
+   const uint32_t now = timer_ticks();
+
+   for (uint8_t i = 0; i < 8; ++i)
+   {
+      const uint8_t mask = 1 << i;
+      struct button* button = button_interrupt_buttons[io_port][i];
+      if (!(changed & mask) || !button) continue;
+
+      const uint8_t head = button_event_head;
+      const uint8_t next = (head + 1) & (BUTTON_EVENT_QUEUE_SIZE - 1);
+
+      if (next == button_event_tail)
+      {
+         button_event_num_dropped++;
+         continue;
+      }
+
+      button_event_queue[head].button = button;
+      button_event_queue[head].timestamp_ms = now;
+      button_event_queue[head].rising = pins & mask;
+      COMPILER_BARRIER();
+      button_event_head = next;
+   }
+
+   return;
+}
+
+/********************************************************************************
+* ISR (PCINT0_vect): Avbrottsrutin som äger rum vid PCI-avbrott på I/O-port B.
+********************************************************************************/
+ISR (PCINT0_vect)
+{
+   button_pcint_handle(IO_PORTB, REG_READ(PINB), REG_READ(PCMSK0));
+}
+
+/********************************************************************************
+* ISR (PCINT1_vect): Avbrottsrutin som äger rum vid PCI-avbrott på I/O-port C.
+********************************************************************************/
+ISR (PCINT1_vect)
+{
+   button_pcint_handle(IO_PORTC, REG_READ(PINC), REG_READ(PCMSK1));
+}
+
+/********************************************************************************
+* ISR (PCINT2_vect): Avbrottsrutin som äger rum vid PCI-avbrott på I/O-port D.
+********************************************************************************/
+ISR (PCINT2_vect)
+{
+   button_pcint_handle(IO_PORTD, REG_READ(PIND), REG_READ(PCMSK2));
 }
\ No newline at end of file
@@ -1,92 +1,312 @@
-/********************************************************************************
-* button.h: Innehller funktionalitet fr enkel implementering av tryckknappar
-*           via strukten button samt associerade funktioner. Denna strukt 
-*           fungerar ocks utmrkt fr andra digitala inportar dr insignalen
-*           ska kunna lsas av samt avbrott ska kunna genereras vid ett
-*           godtyckligt event.
-********************************************************************************/
-#ifndef BUTTON_H_
-#define BUTTON_H_
-
-/* Inkluderingsdirektiv: */
-#include "misc.h"
-
-/********************************************************************************
-* button: Strukt fr implementering av tryckknappar och andra digitala inportar.
-*         PCI-avbrott kan aktiveras p aktuell pin. Drmed fr eventdetektering 
-*         implementeras av anvndaren, d PCI-avbrott inte mjliggr kontroll
-*         av vilken flank som avbrott ska ske p.
-********************************************************************************/
-struct button
-{
-   uint8_t pin;            /* Tryckknappens pin-nummer p aktuell I/O-port. */
-   enum io_port io_port;   /* I/O-port som lysdioden r ansluten till. */
-   bool interrupt_enabled; /* Indikerar ifall PCI-avbrott r aktiverat. */
-};
-
-/********************************************************************************
-* button_init: Initierar ny tryckknapp p angiven pin.
-*
-*              - self: Pekare till tryckknappen som ska initieras.
-*              - pin : Tryckknappens pin-nummer p Arduino Uno, exempelvis 13.
-*                      Alternativt kan motsvarande port-nummer p ATmega328P
-*                      anges, exempelvis B5 fr pin 13 eller D3 fr pin 3.
-********************************************************************************/
-void button_init(struct button* self,
-                 const uint8_t pin);
-
-/********************************************************************************
-* button_clear: Nollstller tryckknapp samt motsvarande pin.
-*
-*               - self: Pekare till tryckknappen som ska nollstllas.
-********************************************************************************/
-void button_clear(struct button* self);
-
-/********************************************************************************
-* button_is_pressed: Lser av tryckknappens pin och indikerar ifall denna r
-*                    nedtryckt. I s fall returneras true, annars false.
-*
-*                    - self: Pekare till tryckknappen som ska lsas av.
-********************************************************************************/
-bool button_is_pressed(const struct button* self);
-
-/********************************************************************************
-* button_enable_interrupt: Aktiverar PCI-avbrott p angiven tryckknapp s att
-*                          event p tryckknappens pin medfr avbrott, bde p
-*                          stigande och fallande flank. Kontroll av flank mste
-*                          sktas av anvndaren, frslagsvis via avlsning i
-*                          motsvarande avbrottsrutin.
-*
-*                          Nedan visas sambandet mellan anvnd I/O-port samt
-*                          avbrottsvektorn fr motsvarande avbrottsrutin:
-*
-*                          I/O-port     pin (Arduino Uno)     Avbrottsvektor
-*                             B              8 - 13             PCINT0_vect
-*                             C             A0 - A5             PCINT1_vect
-*                             D              0 - 7              PCINT2_vect
-*
-*                          - self: Pekare till tryckknappen som PCI-avbrott
-*                                  ska aktiveras p.
-********************************************************************************/
-void button_enable_interrupt(struct button* self);
-
-/********************************************************************************
-* button_disable_interrupt: Inaktiverar PCI-avbrott p angiven tryckknapp. 
-*
-*                           - self: Pekare till tryckknappen som PCI-avbrott
-*                                  ska inaktiveras p.
-********************************************************************************/
-void button_disable_interrupt(struct button* self);
-
-/********************************************************************************
-* button_toggle_interrupt: Togglar aktivering av PCI-avbrott p angiven 
-*                          tryckknapp. Om avbrott r aktiverat vid anrop
-*                          s sker inaktivering. P samma stt gller att om
-*                          avbrott r inaktiverat vid anrop s sker aktivering.
-*
-*                          - self: Pekare till tryckknappen som aktivering av 
-*                                  PCI-avbrott ska inaktiveras p.
-********************************************************************************/
-void button_toggle_interrupt(struct button* self);
-
+/********************************************************************************
+* button.h: Innehåller funktionalitet för enkel implementering av tryckknappar
+*           via strukten button samt associerade funktioner. Denna strukt 
+*           fungerar också utmärkt för andra digitala inportar där insignalen
+*           ska kunna läsas av samt avbrott ska kunna genereras vid ett
+*           godtyckligt event.
+********************************************************************************/
+#ifndef BUTTON_H_
+#define BUTTON_H_
+
+/* Inkluderingsdirektiv: */
+#include "misc.h"
+#include "timer.h"
+
+/* Antal millisekunder mellan avläsningar vid avstudsning (4 stabila avläsningar krävs): */
+#ifndef BUTTON_DEBOUNCE_INTERVAL_MS
+#define BUTTON_DEBOUNCE_INTERVAL_MS 5
+#endif
+
+/* Antalet platser i händelsekön för PCI-avbrott (måste vara en tvåpotens): */
+#ifndef BUTTON_EVENT_QUEUE_SIZE
+#define BUTTON_EVENT_QUEUE_SIZE 16
+#endif
+
+/********************************************************************************
+* button: Strukt för implementering av tryckknappar och andra digitala inportar.
+*         PCI-avbrott kan aktiveras på aktuell pin. Biblioteket implementerar
+*         då avbrottsrutinerna, avgör vilken flank som har uppstått och
+*         lägger en händelse i en kö, som läses av via button_event_poll.
+********************************************************************************/
+struct button
+{
+   uint8_t pin;            /* Tryckknappens pin-nummer på aktuell I/O-port. */
+   enum io_port io_port;   /* I/O-port som lysdioden är ansluten till. */
+   bool interrupt_enabled; /* Indikerar ifall PCI-avbrott är aktiverat. */
+};
+
+/********************************************************************************
+* button_event: Strukt för en flank på en tryckknapp, detekterad via PCI-avbrott.
+********************************************************************************/
+struct button_event
+{
+   struct button* button; /* Tryckknappen som flanken uppstod på. */
+   uint32_t timestamp_ms; /* Systemtickens värde när flanken detekterades. */
+   bool rising;           /* Indikerar stigande flank (nedtryckning). */
+};
+
+/********************************************************************************
+* button_init: Initierar ny tryckknapp på angiven pin.
+*
+*              - self: Pekare till tryckknappen som ska initieras.
+*              - pin : Tryckknappens pin-nummer på Arduino Uno, exempelvis 13.
+*                      Alternativt kan motsvarande port-nummer på ATmega328P
+*                      anges, exempelvis B5 för pin 13 eller D3 för pin 3.
+********************************************************************************/
+void button_init(struct button* self,
+                 const uint8_t pin);
+
+/********************************************************************************
+* button_clear: Nollställer tryckknapp samt motsvarande pin.
+*
+*               - self: Pekare till tryckknappen som ska nollställas.
+********************************************************************************/
+void button_clear(struct button* self);
+
+/********************************************************************************
+* button_is_pressed: Läser av tryckknappens pin och indikerar ifall denna är
+*                    nedtryckt. I så fall returneras true, annars false.
+*
+*                    - self: Pekare till tryckknappen som ska läsas av.
+********************************************************************************/
+bool button_is_pressed(const struct button* self);
+
+/********************************************************************************
+* button_enable_interrupt: Aktiverar PCI-avbrott på angiven tryckknapp så att
+*                          event på tryckknappens pin medför avbrott, både på
+*                          stigande och fallande flank. Avbrottsrutinerna
+*                          implementeras av biblioteket, som jämför porten
+*                          mot senast avlästa värde, avgör flanken och lägger
+*                          en tidsstämplad händelse i händelsekön. Händelserna
+*                          läses av via button_event_poll. Systemticken
+*                          startas för tidsstämplingen.
+*
+*                          Nedan visas sambandet mellan använd I/O-port samt
+*                          avbrottsvektorn för motsvarande avbrottsrutin:
+*
+*                          I/O-port     pin (Arduino Uno)     Avbrottsvektor
+*                             B              8 - 13             PCINT0_vect
+*                             C             A0 - A5             PCINT1_vect
+*                             D              0 - 7              PCINT2_vect
+*
+*                          - self: Pekare till tryckknappen som PCI-avbrott
+*                                  ska aktiveras på.
+********************************************************************************/
+void button_enable_interrupt(struct button* self);
+
+/********************************************************************************
+* button_disable_interrupt: Inaktiverar PCI-avbrott på angiven tryckknapp. 
+*
+*                           - self: Pekare till tryckknappen som PCI-avbrott
+*                                  ska inaktiveras på.
+********************************************************************************/
+void button_disable_interrupt(struct button* self);
+
+/********************************************************************************
+* button_toggle_interrupt: Togglar aktivering av PCI-avbrott på angiven 
+*                          tryckknapp. Om avbrott är aktiverat vid anrop
+*                          så sker inaktivering. På samma sätt gäller att om
+*                          avbrott är inaktiverat vid anrop så sker aktivering.
+*
+*                          - self: Pekare till tryckknappen som aktivering av 
+*                                  PCI-avbrott ska inaktiveras på.
+********************************************************************************/
+void button_toggle_interrupt(struct button* self);
+
+/********************************************************************************
+* button_event_poll: Hämtar äldsta händelse ur händelsekön. Ifall kön är tom
+*                    returneras false, annars true. Kön fylls från
+*                    avbrottsrutinerna och töms från huvudloopen utan att
+*                    avbrott behöver inaktiveras.
+*
+*                    - event: Pekare till strukt där händelsen lagras.
+********************************************************************************/
+bool button_event_poll(struct button_event* event);
+
+/********************************************************************************
+* button_event_dropped: Returnerar antalet händelser som har förkastats
+*                       eftersom händelsekön var full.
+********************************************************************************/
+uint16_t button_event_dropped(void);
+
+/********************************************************************************
+* button_debounce_start: Startar avstudsning av samtliga inportar på I/O-port
+*                        B, C och D. PINB, PINC och PIND läses av var
+*                        BUTTON_DEBOUNCE_INTERVAL_MS:e millisekund från
+*                        systemticken, maskerade med de inportar som har
+*                        aktiverad pullup-resistor, dvs. pinnar initierade
+*                        via button_init eller button_pin_init. Utportar,
+*                        exempelvis lysdioder, samt oanvända inportar ger
+*                        därmed inga händelser och påverkar inte
+*                        button_debounce_is_stable. Varje bit matas genom en
+*                        2-bitars vertikal räknare. En pin anses ha bytt
+*                        tillstånd först efter fyra avläsningar i följd med
+*                        samma nya värde. Samtliga pinnar avstudsas
+*                        parallellt via bitoperationer på hela portbytes,
+*                        så att kostnaden är densamma oavsett antalet
+*                        tryckknappar.
+*
+*                        Ifall systemticken saknar ledig plats returneras
+*                        felkod 1, annars returneras 0.
+********************************************************************************/
+int button_debounce_start(void);
+
+/********************************************************************************
+* button_debounce_stop: Stoppar avstudsningen. Senast avstudsade tillstånd
+*                       behålls.
+********************************************************************************/
+void button_debounce_stop(void);
+
+/********************************************************************************
+* button_debounce_is_stable: Indikerar ifall samtliga tryckknappars avstudsade
+*                            tillstånd överensstämmer med aktuell insignal,
+*                            dvs. att ingen avstudsning pågår. Används för
+*                            att avgöra när systemticken inte längre behövs.
+********************************************************************************/
+bool button_debounce_is_stable(void);
+
+/********************************************************************************
+* button_debounce_state: Returnerar avstudsat tillstånd för angiven I/O-port,
+*                        där ettställda bitar motsvarar nedtryckta knappar.
+*
+*                        - io_port: I/O-porten vars tillstånd ska returneras.
+********************************************************************************/
+uint8_t button_debounce_state(const enum io_port io_port);
+
+/********************************************************************************
+* button_debounce_pressed: Returnerar bitmask över pinnar på angiven I/O-port
+*                          som har tryckts ned sedan föregående anrop, och
+*                          nollställer därefter masken.
+*
+*                          - io_port: I/O-porten vars flanker ska returneras.
+********************************************************************************/
+uint8_t button_debounce_pressed(const enum io_port io_port);
+
+/********************************************************************************
+* button_debounce_released: Returnerar bitmask över pinnar på angiven I/O-port
+*                           som har släppts sedan föregående anrop, och
+*                           nollställer därefter masken.
+*
+*                           - io_port: I/O-porten vars flanker ska returneras.
+********************************************************************************/
+uint8_t button_debounce_released(const enum io_port io_port);
+
+/********************************************************************************
+* button_is_pressed_debounced: Indikerar ifall angiven tryckknapp är nedtryckt
+*                              enligt avstudsat tillstånd. Kräver att
+*                              avstudsning har startats via
+*                              button_debounce_start.
+*
+*                              - self: Pekare till tryckknappen.
+********************************************************************************/
+bool button_is_pressed_debounced(const struct button* self);
+
+/********************************************************************************
+* button_was_pressed: Indikerar ifall angiven tryckknapp har tryckts ned sedan
+*                     föregående anrop enligt avstudsat tillstånd. Flanken
+*                     kvitteras, övriga pinnars flanker påverkas inte.
+*
+*                     - self: Pekare till tryckknappen.
+********************************************************************************/
+bool button_was_pressed(const struct button* self);
+
+/********************************************************************************
+* BUTTON_DEFINE: Definierar en tryckknapp vars pin är känd vid kompilering,
+*                exempelvis BUTTON_DEFINE(button1, B3). Namnet blir en
+*                heltalskonstant som passeras till button_pin_init samt
+*                button_pin_is_pressed, där avläsningen då kompileras till en
+*                enda sbis- eller sbic-instruktion.
+*
+*                - name: Tryckknappens namn.
+*                - pin : Tryckknappens pin-nummer på Arduino Uno, exempelvis
+*                        11, alternativt port-nummer på ATmega328P, exempelvis B3.
+********************************************************************************/
+#define BUTTON_DEFINE(name, pin) enum { name = (pin) }
+
+/********************************************************************************
+* button_pin_read: Läser av tryckknapp ansluten till angiven pin, där
+*                  pin-numret inte är känt vid kompilering. Anropas av
+*                  button_pin_is_pressed vid icke-konstant pin.
+*
+*                  - pin: Tryckknappens pin-nummer på Arduino Uno.
+********************************************************************************/
+bool button_pin_read(const uint8_t pin);
+
+/********************************************************************************
+* button_pin_init: Aktiverar den interna pullup-resistorn på angiven pin för
+*                  en tryckknapp. Vid konstant pin blir detta en sbi-instruktion.
+*
+*                  - pin: Tryckknappens pin-nummer, exempelvis definierat via
+*                         BUTTON_DEFINE.
+********************************************************************************/
+ALWAYS_INLINE void button_pin_init(const uint8_t pin)
+{
+   if (pin <= 7) REG_SET(PORTD, PIN_MASK(pin));
+   else if (pin <= 13) REG_SET(PORTB, PIN_MASK(pin));
+   else if (pin <= 19) REG_SET(PORTC, PIN_MASK(pin));
+   return;
+}
+
+/********************************************************************************
+* button_pin_is_pressed: Läser av tryckknapp ansluten till angiven pin och
+*                        indikerar ifall denna är nedtryckt. Vid konstant pin
+*                        sker avläsningen inline, annars via button_pin_read.
+*
+*                        - pin: Tryckknappens pin-nummer, exempelvis definierat
+*                               via BUTTON_DEFINE.
+********************************************************************************/
+ALWAYS_INLINE bool button_pin_is_pressed(const uint8_t pin)
+{
+   if (!__builtin_constant_p(pin)) return button_pin_read(pin);
+   if (pin <= 7) return REG_READ(PIND) & PIN_MASK(pin);
+   if (pin <= 13) return REG_READ(PINB) & PIN_MASK(pin);
+   if (pin <= 19) return REG_READ(PINC) & PIN_MASK(pin);
+   return false;
+}
+
+/********************************************************************************
+* button_pin_is_pressed_debounced: Indikerar ifall tryckknapp ansluten till
+*                                  angiven pin är nedtryckt enligt avstudsat
+*                                  tillstånd.
+*
+*                                  - pin: Tryckknappens pin-nummer,
+*                                         exempelvis definierat via
+*                                         BUTTON_DEFINE.
+********************************************************************************/
+ALWAYS_INLINE bool button_pin_is_pressed_debounced(const uint8_t pin)
+{
+   return button_debounce_state(PIN_IO_PORT(pin)) & PIN_MASK(pin);
+}
+
+/********************************************************************************
+* button_pin_enable_interrupt: Aktiverar PCI-avbrott på angiven pin utan att
+*                              någon tryckknapp registreras, exempelvis för
+*                              att väcka mikrodatorn ur viloläge vid
+*                              nedtryckning. Inga händelser läggs i
+*                              händelsekön för pinnen.
+*
+*                              - pin: Tryckknappens pin-nummer, exempelvis
+*                                     definierat via BUTTON_DEFINE.
+********************************************************************************/
+ALWAYS_INLINE void button_pin_enable_interrupt(const uint8_t pin)
+{
+   if (pin <= 7)
+   {
+      REG_SET(PCICR, 1 << PCIE2);
+      REG_SET(PCMSK2, PIN_MASK(pin));
+   }
+   else if (pin <= 13)
+   {
+      REG_SET(PCICR, 1 << PCIE0);
+      REG_SET(PCMSK0, PIN_MASK(pin));
+   }
+   else if (pin <= 19)
+   {
+      REG_SET(PCICR, 1 << PCIE1);
+      REG_SET(PCMSK1, PIN_MASK(pin));
+   }
+
+   return;
+}
+
 #endif /* BUTTON_H_ */
\ No newline at end of file
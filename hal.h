@@ -0,0 +1,52 @@
+/********************************************************************************
+* hal.h: Tunt hårdvaruabstraktionslager för åtkomst av I/O-register, avbrott
+*        samt fördröjningsrutiner. Samtliga registeråtkomster i biblioteket
+*        sker via makrona nedan, vilket möjliggör två backends:
+*
+*        - AVR  : Makrona expanderar direkt till registeråtkomst via
+*                 <avr/io.h>, så att genererad kod blir identisk med direkt
+*                 skrivning till registren (exempelvis sbi/cbi).
+*        - Värd : Vid kompilering för annan plattform än AVR (exempelvis
+*                 Linux) emuleras registren av host/hal_host.c, som även för
+*                 logg över registerskrivningar samt en virtuell klocka mätt
+*                 i CPU-cykler. Därmed kan biblioteket köras och mätas utan
+*                 mikrodator, se host/Makefile.
+*
+*        Register anges med sina vanliga namn, exempelvis PORTB eller PCICR.
+*        16-bitars register (exempelvis OCR1A) läses och skrivs via
+*        REG16_READ samt REG16_WRITE. Konstanta data i programminnet
+*        deklareras med PROGMEM och läses via pgm_read_byte.
+********************************************************************************/
+#ifndef HAL_H_
+#define HAL_H_
+
+#if defined(__AVR__)
+
+/* Inkluderingsdirektiv: */
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <avr/sleep.h>
+#include <util/atomic.h>
+#include <util/delay.h>
+
+/* Makrodefinitioner för registeråtkomst: */
+#define REG_READ(reg)           (reg)                /* Läser av register. */
+#define REG_WRITE(reg, value)   ((reg) = (value))    /* Skriver till register. */
+#define REG_SET(reg, mask)      ((reg) |= (mask))    /* Ettställer bitar. */
+#define REG_CLEAR(reg, mask)    ((reg) &= ~(mask))   /* Nollställer bitar. */
+#define REG_TOGGLE(reg, mask)   ((reg) ^= (mask))    /* Togglar bitar. */
+#define REG16_READ(reg)         (reg)                /* Läser 16-bitars register. */
+#define REG16_WRITE(reg, value) ((reg) = (value))    /* Skriver 16-bitars register. */
+
+/* Indikerar ifall avbrott är aktiverade globalt (I-biten i SREG): */
+#define INTERRUPTS_ENABLED()    (SREG & (1 << SREG_I))
+
+#else
+
+/* Inkluderingsdirektiv: */
+#include "host/hal_host.h"
+
+#endif /* defined(__AVR__) */
+
+#endif /* HAL_H_ */
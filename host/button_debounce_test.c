@@ -0,0 +1,107 @@
+/********************************************************************************
+* button_debounce_test.c: Test av avstudsningen i button.c mot den emulerade
+*                         värdbackenden. En lista med lysdioder blinkar via
+*                         systemticken på samma I/O-port som en tryckknapp,
+*                         medan en oanvänd inport utan pullup-resistor
+*                         växlar. Varken lysdioderna eller den oanvända
+*                         inporten får ge några händelser eller hindra
+*                         avstudsningen från att bli stabil, medan en
+*                         nedtryckning av tryckknappen ska ge exakt en
+*                         nedtryckning respektive ett släpp.
+*
+*                         Programmet returnerar 0 om samtliga kontroller
+*                         lyckas, annars 1.
+********************************************************************************/
+#include "../button.h"
+#include "../led_list.h"
+
+#include <stdio.h>
+
+/* Antalet misslyckade kontroller: */
+static int test_failures = 0;
+
+/********************************************************************************
+* test_check: Skriver ut resultatet av angiven kontroll och räknar eventuellt
+*             misslyckande.
+*
+*             - ok  : Indikerar ifall kontrollen lyckades.
+*             - what: Beskrivning av kontrollen.
+********************************************************************************/
+static void test_check(const bool ok,
+                       const char* what)
+{
+   printf("%s: %s\n", ok ? "OK  " : "FAIL", what);
+   if (!ok) test_failures++;
+   return;
+}
+
+/********************************************************************************
+* test_events: Kvitterar samtliga avstudsade flanker och returnerar antalet
+*              pinnar med nedtryckning eller släpp sedan föregående anrop.
+********************************************************************************/
+static uint8_t test_events(void)
+{
+   uint8_t events = 0;
+
+   for (uint8_t i = 0; i < IO_PORT_NONE; ++i)
+   {
+      const uint8_t flanks = button_debounce_pressed(i) | button_debounce_released(i);
+
+      for (uint8_t j = 0; j < 8; ++j)
+      {
+         if (flanks & (1 << j)) events++;
+      }
+   }
+
+   return events;
+}
+
+/********************************************************************************
+* main: Blinkar lysdioderna på pin 8 - 10 med en tryckknapp på pin 11, växlar
+*       den oanvända inporten A0 och kontrollerar avstudsningens händelser.
+********************************************************************************/
+int main(void)
+{
+   struct led l1, l2, l3;
+   struct led_list leds;
+   struct button button;
+
+   led_init(&l1, 8);
+   led_init(&l2, 9);
+   led_init(&l3, 10);
+   button_init(&button, 11);
+
+   struct led* const led_array[] = { &l1, &l2, &l3 };
+   led_list_init(&leds);
+   led_list_assign(&leds, led_array, sizeof(led_array) / sizeof(led_array[0]));
+
+   sei();
+   button_debounce_start();
+   led_list_blink_start(&leds, LED_LIST_BLINK_FORWARD, 50);
+
+   bool stable = true;
+
+   for (uint16_t i = 0; i < 500; ++i)
+   {
+      if (i % 3 == 0) hal_host_set_input(IO_PORTC, 0, i % 2);
+      delay_ms(1);
+      if (i > 2 * 4 * BUTTON_DEBOUNCE_INTERVAL_MS && !button_debounce_is_stable()) stable = false;
+   }
+
+   test_check(test_events() == 0, "blinkande lysdioder ger inga händelser");
+   test_check(stable, "avstudsningen är stabil trots lysdioder och oanvänd inport");
+
+   hal_host_set_input(IO_PORTB, 3, true);
+   delay_ms(10 * BUTTON_DEBOUNCE_INTERVAL_MS);
+   test_check(button_was_pressed(&button), "nedtryckning av tryckknappen detekteras");
+   test_check(button_is_pressed_debounced(&button), "tryckknappen är nedtryckt enligt avstudsat tillstånd");
+
+   hal_host_set_input(IO_PORTB, 3, false);
+   delay_ms(10 * BUTTON_DEBOUNCE_INTERVAL_MS);
+   test_check(button_debounce_released(IO_PORTB) == (1 << 3), "släpp av tryckknappen detekteras");
+   test_check(test_events() == 0, "inga övriga händelser");
+
+   led_list_blink_stop(&leds);
+   button_debounce_stop();
+   return test_failures ? 1 : 0;
+}
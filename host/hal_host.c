@@ -0,0 +1,916 @@
+/********************************************************************************
+* hal_host.c: Innehåller funktionsdefinitioner för värdbackenden, dvs.
+*             emulering av I/O-register, timers, PCI-avbrott, SPI med en
+*             kedja av skiftregister samt en virtuell klocka mätt i
+*             CPU-cykler.
+********************************************************************************/
+#include "../misc.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* Antalet cykler som förbrukas vid inhopp i samt återhopp från en avbrottsrutin: */
+#define HAL_HOST_ISR_OVERHEAD_CYCLES 10
+
+/* Maximalt antal schemalagda insignaler via HAL_HOST_INPUT: */
+#define HAL_HOST_MAX_INPUTS 64
+
+/********************************************************************************
+* hal_host_reg_info: Strukt med information om ett emulerat register.
+********************************************************************************/
+struct hal_host_reg_info
+{
+   const char* name; /* Registrets namn. */
+   uint8_t address;  /* Registrets adress i dataminnet. */
+};
+
+/********************************************************************************
+* hal_host_timer: Strukt med registeradresser samt tillstånd för en emulerad
+*                 timer.
+********************************************************************************/
+struct hal_host_timer
+{
+   enum hal_reg tccra;   /* Kontrollregister A. */
+   enum hal_reg tccrb;   /* Kontrollregister B. */
+   enum hal_reg tcnt;    /* Räknarregister (lågbyte). */
+   enum hal_reg ocra;    /* Jämförelseregister A (lågbyte). */
+   enum hal_reg timsk;   /* Avbrottsmaskregister. */
+   enum hal_reg tifr;    /* Avbrottsflaggregister. */
+   bool wide;            /* Indikerar 16-bitars timer. */
+   uint32_t remainder;   /* Cykler sedan senaste uppräkning av räknaren. */
+};
+
+/********************************************************************************
+* hal_host_input: Strukt för en schemalagd insignal.
+********************************************************************************/
+struct hal_host_input
+{
+   uint64_t cycle;  /* Tidpunkt mätt i cykler. */
+   uint8_t io_port; /* I/O-port (0 = B, 1 = C, 2 = D). */
+   uint8_t pin;     /* Pin-nummer på aktuell I/O-port. */
+   bool high;       /* Insignalens nivå. */
+};
+
+/* Registerinformation i samma ordning som enumerationen hal_reg: */
+static const struct hal_host_reg_info hal_host_regs[HAL_REG_COUNT] =
+{
+   { "PINB",   0x23 }, { "DDRB",   0x24 }, { "PORTB",  0x25 },
+   { "PINC",   0x26 }, { "DDRC",   0x27 }, { "PORTC",  0x28 },
+   { "PIND",   0x29 }, { "DDRD",   0x2A }, { "PORTD",  0x2B },
+   { "TIFR0",  0x35 }, { "TIFR1",  0x36 }, { "TIFR2",  0x37 }, { "PCIFR",  0x3B },
+   { "TCCR0A", 0x44 }, { "TCCR0B", 0x45 }, { "TCNT0",  0x46 }, { "OCR0A",  0x47 },
+   { "SPCR",   0x4C }, { "SPSR",   0x4D }, { "SPDR",   0x4E }, { "SMCR",   0x53 },
+   { "PCICR",  0x68 }, { "PCMSK0", 0x6B }, { "PCMSK1", 0x6C }, { "PCMSK2", 0x6D },
+   { "TIMSK0", 0x6E }, { "TIMSK1", 0x6F }, { "TIMSK2", 0x70 },
+   { "TCCR1A", 0x80 }, { "TCCR1B", 0x81 }, { "TCNT1L", 0x84 }, { "TCNT1H", 0x85 },
+   { "OCR1AL", 0x88 }, { "OCR1AH", 0x89 },
+   { "TCCR2A", 0xB0 }, { "TCCR2B", 0xB1 }, { "TCNT2",  0xB2 }, { "OCR2A",  0xB3 }
+};
+
+/* Emulerade timers 0 - 2: */
+static struct hal_host_timer hal_host_timers[3] =
+{
+   { TCCR0A, TCCR0B, TCNT0, OCR0A, TIMSK0, TIFR0, false, 0 },
+   { TCCR1A, TCCR1B, TCNT1, OCR1A, TIMSK1, TIFR1, true,  0 },
+   { TCCR2A, TCCR2B, TCNT2, OCR2A, TIMSK2, TIFR2, false, 0 }
+};
+
+/* Statiska variabler: */
+static uint8_t hal_host_reg[HAL_REG_COUNT];            /* Registrens innehåll. */
+static uint64_t hal_host_reg_reads[HAL_REG_COUNT];     /* Läsningar per register. */
+static uint64_t hal_host_reg_writes[HAL_REG_COUNT];    /* Skrivningar per register. */
+static uint8_t hal_host_inputs[3];                     /* Externa insignaler. */
+static uint8_t hal_host_pins[3];                       /* Senast avlästa pinnivåer. */
+static bool hal_host_i_flag = false;                   /* Global avbrottsflagga. */
+static bool hal_host_in_isr = false;                   /* Indikerar avbrottskontext. */
+static uint64_t hal_host_now = 0;                      /* Virtuell klocka i cykler. */
+static uint64_t hal_host_run_cycles = 0;               /* Körtid, 0 = obegränsad. */
+static struct hal_host_stats hal_host_stats;           /* Statistik. */
+static FILE* hal_host_log = 0;                         /* Logg över skrivningar. */
+static struct hal_host_input hal_host_schedule[HAL_HOST_MAX_INPUTS];
+static size_t hal_host_num_scheduled = 0;              /* Antalet insignaler. */
+static size_t hal_host_next_scheduled = 0;             /* Nästa insignal. */
+static bool hal_host_clock_stopped = false;            /* Indikerar power-down. */
+static uint64_t hal_host_spi_done = 0;                 /* Slut på SPI-överföring, 0 = ingen. */
+static uint8_t hal_host_spi_data = 0;                  /* Byte som skiftas ut via SPI. */
+static uint8_t hal_host_shift_stage[HAL_HOST_SHIFT_REGISTER_CHIPS];  /* Skiftsteg. */
+static uint8_t hal_host_shift_output[HAL_HOST_SHIFT_REGISTER_CHIPS]; /* Låsta utgångar. */
+static uint64_t hal_host_shift_latches = 0;            /* Antalet låsningar. */
+
+/* Avbrottsrutiner, som ersätts av bibliotekets rutiner då dessa länkas in: */
+__attribute__((weak)) void hal_host_isr_timer0_compa(void) { }
+__attribute__((weak)) void hal_host_isr_timer1_compa(void) { }
+__attribute__((weak)) void hal_host_isr_timer2_compa(void) { }
+__attribute__((weak)) void hal_host_isr_pcint0(void) { }
+__attribute__((weak)) void hal_host_isr_pcint1(void) { }
+__attribute__((weak)) void hal_host_isr_pcint2(void) { }
+__attribute__((weak)) void hal_host_isr_spi_stc(void) { }
+
+/* Statiska funktioner: */
+static void hal_host_charge(const uint64_t cycles);
+static void hal_host_advance(uint64_t cycles);
+static void hal_host_dispatch(void);
+static uint64_t hal_host_cycles_to_wakeup(void);
+static void hal_host_update_pins(void);
+static uint8_t hal_host_pin_value(const uint8_t io_port);
+static void hal_host_spi_start(const uint8_t value);
+static void hal_host_spi_complete(void);
+
+/********************************************************************************
+* hal_host_read: Läser av emulerat register.
+*
+*                - reg: Registret som ska läsas av.
+********************************************************************************/
+uint8_t hal_host_read(const enum hal_reg reg)
+{
+   uint8_t value = hal_host_reg[reg];
+
+   if (reg == PINB || reg == PINC || reg == PIND)
+   {
+      value = hal_host_pin_value((uint8_t)((reg - PINB) / 3));
+   }
+   else if (reg == SPDR)
+   {
+      hal_host_reg[SPSR] &= ~((1 << SPIF) | (1 << WCOL));
+   }
+
+   hal_host_reg_reads[reg]++;
+   hal_host_stats.reads++;
+   hal_host_charge(hal_host_regs[reg].address < 0x60 ? 1 : 2);
+   return value;
+}
+
+/********************************************************************************
+* hal_host_write: Skriver till emulerat register. Skrivning till PINx togglar
+*                 motsvarande bitar i PORTx, medan skrivning av ettor till
+*                 flaggregister nollställer flaggorna, i likhet med
+*                 ATmega328P. Skrivning till SPDR startar en SPI-överföring,
+*                 medan endast SPI2X är skrivbar i SPSR.
+*
+*                 - reg  : Registret som ska skrivas till.
+*                 - value: Värdet som ska skrivas.
+********************************************************************************/
+void hal_host_write(const enum hal_reg reg,
+                    const uint8_t value)
+{
+   const uint8_t old = hal_host_reg[reg];
+
+   if (reg == PINB || reg == PINC || reg == PIND)
+   {
+      hal_host_reg[reg + 2] ^= value;
+   }
+   else if (reg == TIFR0 || reg == TIFR1 || reg == TIFR2 || reg == PCIFR)
+   {
+      hal_host_reg[reg] &= ~value;
+   }
+   else if (reg == SPDR)
+   {
+      hal_host_spi_start(value);
+   }
+   else if (reg == SPSR)
+   {
+      hal_host_reg[reg] = (uint8_t)((old & ~(1 << SPI2X)) | (value & (1 << SPI2X)));
+   }
+   else
+   {
+      hal_host_reg[reg] = value;
+   }
+
+   if (hal_host_log)
+   {
+      fprintf(hal_host_log, "%llu %s %02X -> %02X\n", (unsigned long long)hal_host_now,
+              hal_host_regs[reg].name, old, hal_host_reg[reg]);
+   }
+
+   hal_host_reg_writes[reg]++;
+   hal_host_stats.writes++;
+   hal_host_update_pins();
+   hal_host_charge(hal_host_regs[reg].address < 0x60 ? 1 : 2);
+   return;
+}
+
+/********************************************************************************
+* hal_host_modify: Genomför läs-modifiera-skriv på emulerat register. En
+*                  enskild bit i låg I/O motsvarar sbi/cbi och kostar därmed
+*                  2 cykler, medan övriga fall räknas som läsning, en
+*                  ALU-instruktion samt skrivning.
+*
+*                  - reg      : Registret som ska modifieras.
+*                  - mask     : Bitmask för de bitar som ska påverkas.
+*                  - operation: Bitoperation som ska genomföras.
+********************************************************************************/
+void hal_host_modify(const enum hal_reg reg,
+                     const uint8_t mask,
+                     const enum hal_host_operation operation)
+{
+   const bool single_bit = mask && !(mask & (mask - 1));
+
+   if (single_bit && hal_host_regs[reg].address < 0x40 && operation != HAL_HOST_TOGGLE &&
+       reg != PINB && reg != PINC && reg != PIND)
+   {
+      const uint8_t old = hal_host_reg[reg];
+      if (operation == HAL_HOST_SET) hal_host_reg[reg] |= mask;
+      else hal_host_reg[reg] &= ~mask;
+
+      if (hal_host_log)
+      {
+         fprintf(hal_host_log, "%llu %s %02X -> %02X\n", (unsigned long long)hal_host_now,
+                 hal_host_regs[reg].name, old, hal_host_reg[reg]);
+      }
+
+      hal_host_reg_writes[reg]++;
+      hal_host_stats.writes++;
+      hal_host_update_pins();
+      hal_host_charge(2);
+   }
+   else
+   {
+      const uint8_t value = hal_host_read(reg);
+      hal_host_charge(1);
+
+      if (operation == HAL_HOST_SET) hal_host_write(reg, value | mask);
+      else if (operation == HAL_HOST_CLEAR) hal_host_write(reg, value & ~mask);
+      else hal_host_write(reg, value ^ mask);
+   }
+
+   return;
+}
+
+/********************************************************************************
+* hal_host_read16: Läser av emulerat 16-bitars register.
+*
+*                  - reg: Registrets lågbyte.
+********************************************************************************/
+uint16_t hal_host_read16(const enum hal_reg reg)
+{
+   const uint8_t low = hal_host_read(reg);
+   return (uint16_t)(low | (hal_host_read(reg + 1) << 8));
+}
+
+/********************************************************************************
+* hal_host_write16: Skriver till emulerat 16-bitars register.
+*
+*                   - reg  : Registrets lågbyte.
+*                   - value: Värdet som ska skrivas.
+********************************************************************************/
+void hal_host_write16(const enum hal_reg reg,
+                      const uint16_t value)
+{
+   hal_host_write(reg + 1, (uint8_t)(value >> 8));
+   hal_host_write(reg, (uint8_t)value);
+   return;
+}
+
+/********************************************************************************
+* hal_host_set_interrupts: Aktiverar eller inaktiverar avbrott globalt
+*                          (I-flaggan). Vid aktivering exekveras eventuella
+*                          väntande avbrott direkt.
+*
+*                          - enabled: Indikerar ifall avbrott ska aktiveras.
+********************************************************************************/
+void hal_host_set_interrupts(const bool enabled)
+{
+   hal_host_i_flag = enabled;
+   hal_host_charge(1);
+   return;
+}
+
+/********************************************************************************
+* hal_host_interrupts_enabled: Indikerar ifall avbrott är aktiverade globalt.
+********************************************************************************/
+bool hal_host_interrupts_enabled(void)
+{
+   return hal_host_i_flag;
+}
+
+/********************************************************************************
+* hal_host_save_state: Sparar I-flaggan och inaktiverar avbrott. Används av
+*                      ATOMIC_BLOCK.
+********************************************************************************/
+uint8_t hal_host_save_state(void)
+{
+   const uint8_t state = hal_host_i_flag;
+   hal_host_i_flag = false;
+   hal_host_charge(2);
+   return state;
+}
+
+/********************************************************************************
+* hal_host_restore_state: Återställer sparad I-flagga vid slutet av ett
+*                         atomärt block (ATOMIC_RESTORESTATE).
+*
+*                         - state: Pekare till sparad I-flagga.
+********************************************************************************/
+void hal_host_restore_state(const uint8_t* state)
+{
+   hal_host_i_flag = *state;
+   hal_host_charge(1);
+   return;
+}
+
+/********************************************************************************
+* hal_host_force_on: Aktiverar avbrott vid slutet av ett atomärt block
+*                    (ATOMIC_FORCEON).
+*
+*                    - state: Pekare till sparad I-flagga (används ej).
+********************************************************************************/
+void hal_host_force_on(const uint8_t* state)
+{
+   (void)state;
+   hal_host_i_flag = true;
+   hal_host_charge(1);
+   return;
+}
+
+/********************************************************************************
+* hal_host_delay_cycles: Stegar fram den virtuella klockan angivet antal
+*                        cykler, varvid emulerade timers räknas upp och
+*                        eventuella avbrott exekveras.
+*
+*                        - cycles: Antalet cykler som ska förbrukas.
+********************************************************************************/
+void hal_host_delay_cycles(const uint64_t cycles)
+{
+   hal_host_charge(cycles);
+   return;
+}
+
+/********************************************************************************
+* hal_host_sleep: Emulerar instruktionen sleep. Ifall SE är ettställt i SMCR
+*                 och avbrott är aktiverade stegas den virtuella klockan fram
+*                 till nästa avbrott, utan att cyklerna räknas som aktiva.
+*                 I power-down (SM = 010) stoppas timrarna, varvid endast
+*                 PCI-avbrott från schemalagda insignaler kan väcka
+*                 processorn. Ifall inget avbrott kan inträffa avslutas
+*                 programmet vid angiven körtid, alternativt sker retur direkt.
+********************************************************************************/
+void hal_host_sleep(void)
+{
+   const uint8_t smcr = hal_host_reg[SMCR];
+   const uint64_t interrupts = hal_host_stats.interrupts;
+   hal_host_charge(1);
+
+   if (!(smcr & (1 << SE)) || !hal_host_i_flag || hal_host_in_isr) return;
+   hal_host_clock_stopped = ((smcr >> SM0) & 0x07) == 0x02;
+   hal_host_stats.sleeps++;
+
+   while (hal_host_stats.interrupts == interrupts)
+   {
+      const uint64_t cycles = hal_host_cycles_to_wakeup();
+      if (!cycles) break;
+      hal_host_stats.sleep_cycles += cycles;
+      hal_host_advance(cycles);
+   }
+
+   hal_host_clock_stopped = false;
+   return;
+}
+
+/********************************************************************************
+* hal_host_set_input: Sätter extern insignal på angiven pin, exempelvis för
+*                     simulering av nedtryckt tryckknapp. Eventuella
+*                     PCI-avbrott genereras.
+*
+*                     - io_port: I/O-port (0 = B, 1 = C, 2 = D).
+*                     - pin    : Pin-nummer på aktuell I/O-port.
+*                     - high   : Indikerar ifall insignalen ska vara hög.
+********************************************************************************/
+void hal_host_set_input(const uint8_t io_port,
+                        const uint8_t pin,
+                        const bool high)
+{
+   if (io_port > 2 || pin > 7) return;
+   if (high) hal_host_inputs[io_port] |= (1 << pin);
+   else hal_host_inputs[io_port] &= ~(1 << pin);
+   hal_host_update_pins();
+   hal_host_dispatch();
+   return;
+}
+
+/********************************************************************************
+* hal_host_cycles: Returnerar den virtuella klockans värde mätt i cykler
+*                  sedan programstart.
+********************************************************************************/
+uint64_t hal_host_cycles(void)
+{
+   return hal_host_now;
+}
+
+/********************************************************************************
+* hal_host_get_stats: Läser av statistik sedan senaste nollställning.
+*
+*                     - stats: Pekare till strukt där statistiken lagras.
+********************************************************************************/
+void hal_host_get_stats(struct hal_host_stats* stats)
+{
+   *stats = hal_host_stats;
+   return;
+}
+
+/********************************************************************************
+* hal_host_reset_stats: Nollställer statistiken, men inte den virtuella klockan
+*                       eller registrens innehåll.
+********************************************************************************/
+void hal_host_reset_stats(void)
+{
+   memset(&hal_host_stats, 0, sizeof(hal_host_stats));
+   memset(hal_host_reg_reads, 0, sizeof(hal_host_reg_reads));
+   memset(hal_host_reg_writes, 0, sizeof(hal_host_reg_writes));
+   return;
+}
+
+/********************************************************************************
+* hal_host_print_report: Skriver ut statistik per register till stderr.
+********************************************************************************/
+void hal_host_print_report(void)
+{
+   fprintf(stderr, "virtual time: %.3f ms (%llu cycles)\n",
+           hal_host_now / (F_CPU / 1000.0), (unsigned long long)hal_host_now);
+   fprintf(stderr, "register reads: %llu, writes: %llu, interrupts: %llu\n",
+           (unsigned long long)hal_host_stats.reads, (unsigned long long)hal_host_stats.writes,
+           (unsigned long long)hal_host_stats.interrupts);
+   fprintf(stderr, "active cycles: %llu, sleep cycles: %llu (%llu sleeps)\n",
+           (unsigned long long)hal_host_stats.cycles, (unsigned long long)hal_host_stats.sleep_cycles,
+           (unsigned long long)hal_host_stats.sleeps);
+
+   if (hal_host_shift_latches)
+   {
+      fprintf(stderr, "shift register latches: %llu\n", (unsigned long long)hal_host_shift_latches);
+   }
+
+   fprintf(stderr, "%-8s %12s %12s %6s\n", "register", "reads", "writes", "value");
+
+   for (int i = 0; i < HAL_REG_COUNT; ++i)
+   {
+      if (hal_host_reg_reads[i] || hal_host_reg_writes[i])
+      {
+         const uint8_t value = (i == PINB || i == PINC || i == PIND) ?
+            hal_host_pin_value((uint8_t)((i - PINB) / 3)) : hal_host_reg[i];
+         fprintf(stderr, "%-8s %12llu %12llu   0x%02X\n", hal_host_regs[i].name,
+                 (unsigned long long)hal_host_reg_reads[i],
+                 (unsigned long long)hal_host_reg_writes[i], value);
+      }
+   }
+
+   return;
+}
+
+/********************************************************************************
+* hal_host_shift_register_output: Returnerar låsta utgångar (Q0 - Q7) för
+*                                 angivet skiftregister i den emulerade
+*                                 kedjan, där 0 är skiftregistret närmast
+*                                 mikrodatorn. Ifall index ligger utanför
+*                                 kedjan returneras 0.
+*
+*                                 - chip: Skiftregistrets index i kedjan.
+********************************************************************************/
+uint8_t hal_host_shift_register_output(const uint8_t chip)
+{
+   return chip < HAL_HOST_SHIFT_REGISTER_CHIPS ? hal_host_shift_output[chip] : 0;
+}
+
+/********************************************************************************
+* hal_host_shift_register_latches: Returnerar antalet gånger som kedjans
+*                                  utgångar har låsts sedan programstart.
+********************************************************************************/
+uint64_t hal_host_shift_register_latches(void)
+{
+   return hal_host_shift_latches;
+}
+
+/********************************************************************************
+* hal_host_pin_value: Returnerar aktuella pinnivåer på angiven I/O-port. Pins
+*                     konfigurerade som utportar läser tillbaka PORTx, övriga
+*                     läser av den externa insignalen.
+*
+*                     - io_port: I/O-port (0 = B, 1 = C, 2 = D).
+********************************************************************************/
+static uint8_t hal_host_pin_value(const uint8_t io_port)
+{
+   const uint8_t ddr = hal_host_reg[DDRB + io_port * 3];
+   const uint8_t port = hal_host_reg[PORTB + io_port * 3];
+   return (uint8_t)((ddr & port) | (~ddr & hal_host_inputs[io_port]));
+}
+
+/********************************************************************************
+* hal_host_update_pins: Uppdaterar lagrade pinnivåer och ettställer
+*                       PCI-flaggan för de portar där en maskerad pin har
+*                       ändrats, vilket motsvarar hårdvarans pin change-logik.
+*                       Vid positiv flank på PORTB2 (RCLK) låses
+*                       skiftregisterkedjans skiftsteg till utgångarna,
+*                       förutsatt att SPI är aktiverat, så att PORTB2 kan
+*                       användas som vanlig utport utan skiftregister.
+********************************************************************************/
+static void hal_host_update_pins(void)
+{
+   static const enum hal_reg pcmsk[3] = { PCMSK0, PCMSK1, PCMSK2 };
+
+   for (uint8_t i = 0; i < 3; ++i)
+   {
+      const uint8_t value = hal_host_pin_value(i);
+      const uint8_t changed = (uint8_t)(value ^ hal_host_pins[i]);
+      hal_host_pins[i] = value;
+
+      if (i == IO_PORTB && (changed & value & (1 << 2)) && (hal_host_reg[SPCR] & (1 << SPE)))
+      {
+         memcpy(hal_host_shift_output, hal_host_shift_stage, sizeof(hal_host_shift_output));
+         hal_host_shift_latches++;
+      }
+
+      if ((changed & hal_host_reg[pcmsk[i]]) && (hal_host_reg[PCICR] & (1 << i)))
+      {
+         hal_host_reg[PCIFR] |= (1 << i);
+      }
+   }
+
+   return;
+}
+
+/********************************************************************************
+* hal_host_spi_start: Startar utskiftning av angiven byte via SPI, förutsatt
+*                     att SPI är aktiverat i master-mode. Överföringen tar
+*                     8 SCK-perioder enligt SPR1:0 samt SPI2X. Åtkomst av
+*                     SPDR nollställer SPIF, vilket förenklar hårdvarans krav
+*                     på föregående läsning av SPSR. Pågår redan en
+*                     överföring ettställs WCOL och byten ignoreras.
+*
+*                     - value: Byten som ska skiftas ut.
+********************************************************************************/
+static void hal_host_spi_start(const uint8_t value)
+{
+   static const uint32_t dividers[4] = { 4, 16, 64, 128 };
+   const uint8_t spcr = hal_host_reg[SPCR];
+   uint32_t divider = dividers[spcr & ((1 << SPR1) | (1 << SPR0))];
+
+   hal_host_reg[SPSR] &= ~((1 << SPIF) | (1 << WCOL));
+   if (!(spcr & (1 << SPE)) || !(spcr & (1 << MSTR))) return;
+
+   if (hal_host_spi_done)
+   {
+      hal_host_reg[SPSR] |= (1 << WCOL);
+      return;
+   }
+
+   if (hal_host_reg[SPSR] & (1 << SPI2X)) divider /= 2;
+   hal_host_reg[SPDR] = value;
+   hal_host_spi_data = value;
+   hal_host_spi_done = hal_host_now + 8 * divider;
+   return;
+}
+
+/********************************************************************************
+* hal_host_spi_complete: Slutför pågående SPI-överföring. Byten skiftas in i
+*                        första skiftregistret, medan övriga skiftregister
+*                        skiftas ett steg längre ut i kedjan, varefter SPIF
+*                        ettställs.
+********************************************************************************/
+static void hal_host_spi_complete(void)
+{
+   memmove(hal_host_shift_stage + 1, hal_host_shift_stage, sizeof(hal_host_shift_stage) - 1);
+   hal_host_shift_stage[0] = hal_host_spi_data;
+   hal_host_spi_done = 0;
+   hal_host_reg[SPSR] |= (1 << SPIF);
+   return;
+}
+
+/********************************************************************************
+* hal_host_timer_prescaler: Returnerar aktuell prescaler för angiven timer,
+*                           eller 0 ifall timern är stoppad.
+*
+*                           - index: Timerns nummer (0 - 2).
+********************************************************************************/
+static uint32_t hal_host_timer_prescaler(const uint8_t index)
+{
+   static const uint32_t prescalers[8] = { 0, 1, 8, 64, 256, 1024, 0, 0 };
+   static const uint32_t prescalers2[8] = { 0, 1, 8, 32, 64, 128, 256, 1024 };
+   const uint8_t cs = hal_host_reg[hal_host_timers[index].tccrb] & 0x07;
+   return index == 2 ? prescalers2[cs] : prescalers[cs];
+}
+
+/********************************************************************************
+* hal_host_timer_ctc: Indikerar ifall angiven timer är konfigurerad för
+*                     CTC-mode med OCRxA som toppvärde.
+*
+*                     - index: Timerns nummer (0 - 2).
+********************************************************************************/
+static bool hal_host_timer_ctc(const uint8_t index)
+{
+   if (index == 1) return hal_host_reg[TCCR1B] & (1 << WGM12);
+   return hal_host_reg[hal_host_timers[index].tccra] & (1 << 1);
+}
+
+/********************************************************************************
+* hal_host_timer_get: Läser av angivet register för angiven timer utan att
+*                     belasta den virtuella klockan.
+********************************************************************************/
+static uint32_t hal_host_timer_get(const struct hal_host_timer* self,
+                                   const enum hal_reg reg)
+{
+   if (self->wide) return hal_host_reg[reg] | (hal_host_reg[reg + 1] << 8);
+   return hal_host_reg[reg];
+}
+
+/********************************************************************************
+* hal_host_timer_set: Skriver räknarvärde för angiven timer utan att belasta
+*                     den virtuella klockan.
+********************************************************************************/
+static void hal_host_timer_set(const struct hal_host_timer* self,
+                               const uint32_t value)
+{
+   hal_host_reg[self->tcnt] = (uint8_t)value;
+   if (self->wide) hal_host_reg[self->tcnt + 1] = (uint8_t)(value >> 8);
+   return;
+}
+
+/********************************************************************************
+* hal_host_timer_ticks_to_match: Returnerar antalet uppräkningar av angiven
+*                                timer innan nästa compare match. Liksom i
+*                                hårdvaran ettställs flaggan vid klockpulsen
+*                                efter att TCNTx har nått OCRxA, då räknaren
+*                                i CTC-mode samtidigt nollställs.
+*
+*                                - index: Timerns nummer (0 - 2).
+********************************************************************************/
+static uint32_t hal_host_timer_ticks_to_match(const uint8_t index)
+{
+   const struct hal_host_timer* self = &hal_host_timers[index];
+   const uint32_t max = self->wide ? 0xFFFF : 0xFF;
+   const uint32_t tcnt = hal_host_timer_get(self, self->tcnt);
+   const uint32_t ocr = hal_host_timer_get(self, self->ocra);
+
+   if (tcnt <= ocr) return ocr - tcnt + 1;
+   return (max - tcnt) + 1 + ocr + 1;
+}
+
+/********************************************************************************
+* hal_host_timer_advance: Räknar upp angiven timer angivet antal steg, som
+*                         maximalt får motsvara tiden till nästa compare match.
+*
+*                         - index: Timerns nummer (0 - 2).
+*                         - ticks: Antalet uppräkningar.
+********************************************************************************/
+static void hal_host_timer_advance(const uint8_t index,
+                                   const uint32_t ticks)
+{
+   const struct hal_host_timer* self = &hal_host_timers[index];
+   const uint32_t max = self->wide ? 0xFFFF : 0xFF;
+   const uint32_t tcnt = hal_host_timer_get(self, self->tcnt);
+   const uint32_t ocr = hal_host_timer_get(self, self->ocra);
+
+   if (ticks == hal_host_timer_ticks_to_match(index))
+   {
+      hal_host_timer_set(self, hal_host_timer_ctc(index) ? 0 : (ocr + 1) & max);
+      hal_host_reg[self->tifr] |= (1 << 1);
+   }
+   else
+   {
+      hal_host_timer_set(self, (tcnt + ticks) & max);
+   }
+
+   return;
+}
+
+/********************************************************************************
+* hal_host_charge: Belastar den virtuella klockan med angivet antal cykler.
+********************************************************************************/
+static void hal_host_charge(const uint64_t cycles)
+{
+   hal_host_stats.cycles += cycles;
+   hal_host_advance(cycles);
+   return;
+}
+
+/********************************************************************************
+* hal_host_advance: Stegar fram den virtuella klockan i delsteg fram till
+*                   respektive timers nästa compare match samt slutet av
+*                   pågående SPI-överföring, så att avbrott exekveras vid
+*                   rätt tidpunkt. Schemalagda insignaler
+*                   tillämpas och körtiden kontrolleras efter varje delsteg.
+*
+*                   - cycles: Antalet cykler som ska förbrukas.
+********************************************************************************/
+static void hal_host_advance(uint64_t cycles)
+{
+   while (cycles > 0)
+   {
+      uint64_t step = cycles;
+
+      for (uint8_t i = 0; i < 3 && !hal_host_clock_stopped; ++i)
+      {
+         const uint32_t prescaler = hal_host_timer_prescaler(i);
+         if (!prescaler) continue;
+         const uint64_t until_match = (uint64_t)hal_host_timer_ticks_to_match(i) * prescaler -
+            hal_host_timers[i].remainder;
+         if (until_match < step) step = until_match;
+      }
+
+      if (hal_host_next_scheduled < hal_host_num_scheduled)
+      {
+         const uint64_t next = hal_host_schedule[hal_host_next_scheduled].cycle;
+         if (next > hal_host_now && next - hal_host_now < step) step = next - hal_host_now;
+      }
+
+      if (hal_host_spi_done && hal_host_spi_done - hal_host_now < step)
+      {
+         step = hal_host_spi_done - hal_host_now;
+      }
+
+      for (uint8_t i = 0; i < 3 && !hal_host_clock_stopped; ++i)
+      {
+         const uint32_t prescaler = hal_host_timer_prescaler(i);
+         if (!prescaler) continue;
+         const uint64_t total = hal_host_timers[i].remainder + step;
+         hal_host_timers[i].remainder = (uint32_t)(total % prescaler);
+         if (total / prescaler) hal_host_timer_advance(i, (uint32_t)(total / prescaler));
+      }
+
+      hal_host_now += step;
+      cycles -= step;
+
+      if (hal_host_spi_done && hal_host_now >= hal_host_spi_done)
+      {
+         hal_host_spi_complete();
+      }
+
+      while (hal_host_next_scheduled < hal_host_num_scheduled &&
+             hal_host_schedule[hal_host_next_scheduled].cycle <= hal_host_now)
+      {
+         const struct hal_host_input* input = &hal_host_schedule[hal_host_next_scheduled++];
+         if (input->high) hal_host_inputs[input->io_port] |= (1 << input->pin);
+         else hal_host_inputs[input->io_port] &= ~(1 << input->pin);
+         hal_host_update_pins();
+      }
+
+      if (hal_host_run_cycles && hal_host_now >= hal_host_run_cycles)
+      {
+         exit(0);
+      }
+
+      hal_host_dispatch();
+   }
+
+   return;
+}
+
+/********************************************************************************
+* hal_host_dispatch: Exekverar väntande avbrott i samma prioritetsordning som
+*                    avbrottsvektorerna på ATmega328P, förutsatt att avbrott
+*                    är aktiverade och att inget avbrott redan exekveras.
+********************************************************************************/
+static void hal_host_dispatch(void)
+{
+   static const struct
+   {
+      enum hal_reg flag_reg;
+      enum hal_reg mask_reg;
+      uint8_t bit;
+      void (*isr)(void);
+   } vectors[] =
+   {
+      { PCIFR, PCICR,  PCIF0, hal_host_isr_pcint0 },
+      { PCIFR, PCICR,  PCIF1, hal_host_isr_pcint1 },
+      { PCIFR, PCICR,  PCIF2, hal_host_isr_pcint2 },
+      { TIFR2, TIMSK2, OCF2A, hal_host_isr_timer2_compa },
+      { TIFR1, TIMSK1, OCF1A, hal_host_isr_timer1_compa },
+      { TIFR0, TIMSK0, OCF0A, hal_host_isr_timer0_compa },
+      { SPSR,  SPCR,   SPIF,  hal_host_isr_spi_stc }
+   };
+
+   while (hal_host_i_flag && !hal_host_in_isr)
+   {
+      bool found = false;
+
+      for (size_t i = 0; i < sizeof(vectors) / sizeof(vectors[0]); ++i)
+      {
+         const uint8_t bit = (1 << vectors[i].bit);
+
+         if ((hal_host_reg[vectors[i].flag_reg] & bit) && (hal_host_reg[vectors[i].mask_reg] & bit))
+         {
+            hal_host_reg[vectors[i].flag_reg] &= ~bit;
+            hal_host_in_isr = true;
+            hal_host_i_flag = false;
+            hal_host_stats.interrupts++;
+            hal_host_charge(HAL_HOST_ISR_OVERHEAD_CYCLES);
+            vectors[i].isr();
+            hal_host_i_flag = true;
+            hal_host_in_isr = false;
+            found = true;
+            break;
+         }
+      }
+
+      if (!found) break;
+   }
+
+   return;
+}
+
+/********************************************************************************
+* hal_host_cycles_to_wakeup: Returnerar antalet cykler till nästa händelse som
+*                            kan väcka processorn ur viloläge, dvs. nästa
+*                            compare match för en timer med aktiverat avbrott
+*                            (ej i power-down), slutet av pågående
+*                            SPI-överföring med aktiverat avbrott (ej i
+*                            power-down), nästa schemalagda insignal
+*                            eller slutet av körtiden. Ifall ingen sådan
+*                            händelse finns returneras 0.
+********************************************************************************/
+static uint64_t hal_host_cycles_to_wakeup(void)
+{
+   uint64_t cycles = UINT64_MAX;
+
+   for (uint8_t i = 0; i < 3 && !hal_host_clock_stopped; ++i)
+   {
+      const uint32_t prescaler = hal_host_timer_prescaler(i);
+      if (!prescaler || !(hal_host_reg[hal_host_timers[i].timsk] & (1 << 1))) continue;
+      const uint64_t until_match = (uint64_t)hal_host_timer_ticks_to_match(i) * prescaler -
+         hal_host_timers[i].remainder;
+      if (until_match < cycles) cycles = until_match;
+   }
+
+   if (hal_host_spi_done && (hal_host_reg[SPCR] & (1 << SPIE)) && !hal_host_clock_stopped)
+   {
+      const uint64_t until_spi = hal_host_spi_done - hal_host_now;
+      if (until_spi < cycles) cycles = until_spi;
+   }
+
+   if (hal_host_next_scheduled < hal_host_num_scheduled)
+   {
+      const uint64_t next = hal_host_schedule[hal_host_next_scheduled].cycle;
+      const uint64_t until_input = next > hal_host_now ? next - hal_host_now : 1;
+      if (until_input < cycles) cycles = until_input;
+   }
+
+   if (hal_host_run_cycles && hal_host_run_cycles > hal_host_now)
+   {
+      const uint64_t until_end = hal_host_run_cycles - hal_host_now;
+      if (until_end < cycles) cycles = until_end;
+   }
+
+   return cycles == UINT64_MAX ? 0 : cycles;
+}
+
+/********************************************************************************
+* hal_host_parse_inputs: Tolkar schemalagda insignaler från HAL_HOST_INPUT i
+*                        formatet "ms:pin=nivå,...", där pin anges som
+*                        portbokstav följt av bitnummer, exempelvis B3.
+*                        Insignalerna förutsätts vara angivna i tidsordning.
+*
+*                        - text: Textsträngen som ska tolkas.
+********************************************************************************/
+static void hal_host_parse_inputs(const char* text)
+{
+   while (*text && hal_host_num_scheduled < HAL_HOST_MAX_INPUTS)
+   {
+      unsigned long ms;
+      char port;
+      unsigned pin, level;
+      int length = 0;
+
+      if (sscanf(text, "%lu:%c%u=%u%n", &ms, &port, &pin, &level, &length) != 4) break;
+
+      if ((port == 'B' || port == 'C' || port == 'D') && pin < 8)
+      {
+         struct hal_host_input* input = &hal_host_schedule[hal_host_num_scheduled++];
+         input->cycle = (uint64_t)ms * (F_CPU / 1000);
+         input->io_port = (uint8_t)(port - 'B');
+         input->pin = (uint8_t)pin;
+         input->high = level != 0;
+      }
+
+      text += length;
+      if (*text == ',') text++;
+   }
+
+   return;
+}
+
+/********************************************************************************
+* hal_host_exit: Skriver ut statistik och stänger loggfilen vid programslut.
+********************************************************************************/
+static void hal_host_exit(void)
+{
+   hal_host_print_report();
+   if (hal_host_log) fclose(hal_host_log);
+   return;
+}
+
+/********************************************************************************
+* hal_host_setup: Läser in konfiguration från miljövariabler före main.
+********************************************************************************/
+__attribute__((constructor)) static void hal_host_setup(void)
+{
+   const char* run_ms = getenv("HAL_HOST_RUN_MS");
+   const char* log = getenv("HAL_HOST_LOG");
+   const char* inputs = getenv("HAL_HOST_INPUT");
+
+   if (run_ms)
+   {
+      hal_host_run_cycles = strtoull(run_ms, 0, 10) * (F_CPU / 1000);
+      atexit(hal_host_exit);
+   }
+
+   if (log) hal_host_log = fopen(log, "w");
+   if (inputs) hal_host_parse_inputs(inputs);
+   return;
+}
@@ -0,0 +1,366 @@
+/********************************************************************************
+* hal_host.h: Värdbackend för hårdvaruabstraktionslagret i hal.h. Samtliga
+*             I/O-register som används av biblioteket emuleras i RAM, där
+*             varje åtkomst räknas, loggas samt belastar en virtuell klocka
+*             med det antal CPU-cykler som motsvarande AVR-instruktion tar.
+*
+*             Kostnadsmodell (ATmega328P):
+*
+*             Registertyp          Adress (data)   Läs   Skriv   Bit (sbi/cbi)
+*             Låg I/O              0x20 - 0x3F      1      1          2
+*             I/O                  0x40 - 0x5F      1      1          -
+*             Utökad I/O           0x60 -           2      2          -
+*
+*             Ettställning, nollställning samt toggling av en enskild bit i
+*             låg I/O motsvarar sbi/cbi (2 cykler). Övriga bitoperationer
+*             räknas som läsning + en ALU-instruktion + skrivning.
+*
+*             Timer 0 - 2 emuleras i CTC-mode, inklusive compare match-avbrott,
+*             och stegas fram i takt med den virtuella klockan. Avbrott
+*             exekveras då globala avbrott är aktiverade, både under
+*             fördröjningsrutiner och mellan registeråtkomster i huvudloopen.
+*
+*             SPI emuleras i master-mode, där en skrivning till SPDR skiftar
+*             ut byten under 8 SCK-perioder, varefter SPIF ettställs.
+*             Utskiftade byte matas in i en emulerad kedja av 74HC595
+*             (SER = MOSI, SRCLK = SCK), vars utgångar låses vid positiv
+*             flank på PORTB2 (RCLK) då SPI är aktiverat, se
+*             hal_host_shift_register_output.
+*
+*             Följande miljövariabler påverkar körningen:
+*
+*             - HAL_HOST_RUN_MS: Avslutar programmet då den virtuella klockan
+*                                har nått angivet antal millisekunder, varefter
+*                                statistik skrivs ut.
+*             - HAL_HOST_LOG   : Filnamn där samtliga registerskrivningar loggas
+*                                med tidsstämpel i cykler.
+*             - HAL_HOST_INPUT : Schemalagda insignaler i formatet
+*                                "ms:pin=nivå,...", exempelvis "100:B3=1"
+*                                för att sätta PORTB3 hög efter 100 ms.
+********************************************************************************/
+#ifndef HAL_HOST_H_
+#define HAL_HOST_H_
+
+/* Inkluderingsdirektiv: */
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Klockfrekvens ifall denna inte redan är definierad: */
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+/********************************************************************************
+* hal_reg: Enumeration över emulerade register. 16-bitars register lagras som
+*          låg- och högbyte i följd.
+********************************************************************************/
+enum hal_reg
+{
+   HAL_REG_PINB,   HAL_REG_DDRB,   HAL_REG_PORTB,
+   HAL_REG_PINC,   HAL_REG_DDRC,   HAL_REG_PORTC,
+   HAL_REG_PIND,   HAL_REG_DDRD,   HAL_REG_PORTD,
+   HAL_REG_TIFR0,  HAL_REG_TIFR1,  HAL_REG_TIFR2,  HAL_REG_PCIFR,
+   HAL_REG_TCCR0A, HAL_REG_TCCR0B, HAL_REG_TCNT0,  HAL_REG_OCR0A,
+   HAL_REG_SPCR,   HAL_REG_SPSR,   HAL_REG_SPDR,   HAL_REG_SMCR,
+   HAL_REG_PCICR,  HAL_REG_PCMSK0, HAL_REG_PCMSK1, HAL_REG_PCMSK2,
+   HAL_REG_TIMSK0, HAL_REG_TIMSK1, HAL_REG_TIMSK2,
+   HAL_REG_TCCR1A, HAL_REG_TCCR1B, HAL_REG_TCNT1L, HAL_REG_TCNT1H,
+   HAL_REG_OCR1AL, HAL_REG_OCR1AH,
+   HAL_REG_TCCR2A, HAL_REG_TCCR2B, HAL_REG_TCNT2,  HAL_REG_OCR2A,
+   HAL_REG_COUNT
+};
+
+/* Registernamn enligt <avr/io.h>: */
+#define PINB   HAL_REG_PINB
+#define DDRB   HAL_REG_DDRB
+#define PORTB  HAL_REG_PORTB
+#define PINC   HAL_REG_PINC
+#define DDRC   HAL_REG_DDRC
+#define PORTC  HAL_REG_PORTC
+#define PIND   HAL_REG_PIND
+#define DDRD   HAL_REG_DDRD
+#define PORTD  HAL_REG_PORTD
+#define TIFR0  HAL_REG_TIFR0
+#define TIFR1  HAL_REG_TIFR1
+#define TIFR2  HAL_REG_TIFR2
+#define PCIFR  HAL_REG_PCIFR
+#define TCCR0A HAL_REG_TCCR0A
+#define TCCR0B HAL_REG_TCCR0B
+#define TCNT0  HAL_REG_TCNT0
+#define OCR0A  HAL_REG_OCR0A
+#define SPCR   HAL_REG_SPCR
+#define SPSR   HAL_REG_SPSR
+#define SPDR   HAL_REG_SPDR
+#define SMCR   HAL_REG_SMCR
+#define PCICR  HAL_REG_PCICR
+#define PCMSK0 HAL_REG_PCMSK0
+#define PCMSK1 HAL_REG_PCMSK1
+#define PCMSK2 HAL_REG_PCMSK2
+#define TIMSK0 HAL_REG_TIMSK0
+#define TIMSK1 HAL_REG_TIMSK1
+#define TIMSK2 HAL_REG_TIMSK2
+#define TCCR1A HAL_REG_TCCR1A
+#define TCCR1B HAL_REG_TCCR1B
+#define TCNT1  HAL_REG_TCNT1L
+#define OCR1A  HAL_REG_OCR1AL
+#define TCCR2A HAL_REG_TCCR2A
+#define TCCR2B HAL_REG_TCCR2B
+#define TCNT2  HAL_REG_TCNT2
+#define OCR2A  HAL_REG_OCR2A
+
+/* Bitnamn enligt <avr/io.h>: */
+#define PCIE0  0
+#define PCIE1  1
+#define PCIE2  2
+#define PCIF0  0
+#define PCIF1  1
+#define PCIF2  2
+#define WGM01  1
+#define CS00   0
+#define CS01   1
+#define CS02   2
+#define OCIE0A 1
+#define OCF0A  1
+#define WGM12  3
+#define CS10   0
+#define CS11   1
+#define CS12   2
+#define OCIE1A 1
+#define OCF1A  1
+#define WGM21  1
+#define CS20   0
+#define CS21   1
+#define CS22   2
+#define OCIE2A 1
+#define OCF2A  1
+#define SE     0
+#define SM0    1
+#define SM1    2
+#define SM2    3
+#define SPR0   0
+#define SPR1   1
+#define MSTR   4
+#define SPE    6
+#define SPIE   7
+#define SPI2X  0
+#define WCOL   6
+#define SPIF   7
+
+/* Antalet skiftregister i den emulerade kedjan: */
+#define HAL_HOST_SHIFT_REGISTER_CHIPS 32
+
+/* Avbrottsvektorer, som på värden realiseras som vanliga funktioner: */
+#define TIMER0_COMPA_vect hal_host_isr_timer0_compa
+#define TIMER1_COMPA_vect hal_host_isr_timer1_compa
+#define TIMER2_COMPA_vect hal_host_isr_timer2_compa
+#define PCINT0_vect       hal_host_isr_pcint0
+#define PCINT1_vect       hal_host_isr_pcint1
+#define PCINT2_vect       hal_host_isr_pcint2
+#define SPI_STC_vect      hal_host_isr_spi_stc
+#define ISR(vector)       void vector(void)
+
+/* Makrodefinitioner för registeråtkomst, se hal.h: */
+#define REG_READ(reg)           hal_host_read(reg)
+#define REG_WRITE(reg, value)   hal_host_write(reg, value)
+#define REG_SET(reg, mask)      hal_host_modify(reg, mask, HAL_HOST_SET)
+#define REG_CLEAR(reg, mask)    hal_host_modify(reg, mask, HAL_HOST_CLEAR)
+#define REG_TOGGLE(reg, mask)   hal_host_modify(reg, mask, HAL_HOST_TOGGLE)
+#define REG16_READ(reg)         hal_host_read16(reg)
+#define REG16_WRITE(reg, value) hal_host_write16(reg, value)
+
+/* Avbrottshantering samt fördröjning: */
+#define sei()                   hal_host_set_interrupts(true)
+#define cli()                   hal_host_set_interrupts(false)
+#define INTERRUPTS_ENABLED()    hal_host_interrupts_enabled()
+#define _delay_ms(ms)           hal_host_delay_cycles((uint64_t)((ms) * (F_CPU / 1000.0)))
+#define _delay_us(us)           hal_host_delay_cycles((uint64_t)((us) * (F_CPU / 1000000.0)))
+#define sleep_cpu()             hal_host_sleep()
+
+/* Programminne enligt <avr/pgmspace.h>, som på värden är vanligt minne: */
+#define PROGMEM
+#define pgm_read_byte(address)  (*(const uint8_t*)(address))
+
+/* Atomära block enligt <util/atomic.h>: */
+#define ATOMIC_RESTORESTATE     hal_host_restore_state
+#define ATOMIC_FORCEON          hal_host_force_on
+#define ATOMIC_BLOCK(type) \
+   for (uint8_t hal_host_sreg __attribute__((__cleanup__(type))) = hal_host_save_state(), \
+        hal_host_once = 1; hal_host_once; hal_host_once = 0)
+
+/********************************************************************************
+* hal_host_operation: Enumeration för bitoperationer vid registeråtkomst.
+********************************************************************************/
+enum hal_host_operation
+{
+   HAL_HOST_SET,   /* Ettställning av bitar. */
+   HAL_HOST_CLEAR, /* Nollställning av bitar. */
+   HAL_HOST_TOGGLE /* Toggling av bitar. */
+};
+
+/********************************************************************************
+* hal_host_stats: Strukt för statistik över emulerade registeråtkomster.
+********************************************************************************/
+struct hal_host_stats
+{
+   uint64_t cycles;            /* Förbrukade CPU-cykler sedan nollställning. */
+   uint64_t reads;             /* Antalet registerläsningar. */
+   uint64_t writes;            /* Antalet registerskrivningar. */
+   uint64_t interrupts;        /* Antalet exekverade avbrottsrutiner. */
+   uint64_t sleep_cycles;      /* Cykler i viloläge (idle eller power-down). */
+   uint64_t sleeps;            /* Antalet gånger processorn har gått i viloläge. */
+};
+
+/********************************************************************************
+* hal_host_read: Läser av emulerat register.
+*
+*                - reg: Registret som ska läsas av.
+********************************************************************************/
+uint8_t hal_host_read(const enum hal_reg reg);
+
+/********************************************************************************
+* hal_host_write: Skriver till emulerat register.
+*
+*                 - reg  : Registret som ska skrivas till.
+*                 - value: Värdet som ska skrivas.
+********************************************************************************/
+void hal_host_write(const enum hal_reg reg,
+                    const uint8_t value);
+
+/********************************************************************************
+* hal_host_modify: Genomför läs-modifiera-skriv på emulerat register.
+*
+*                  - reg      : Registret som ska modifieras.
+*                  - mask     : Bitmask för de bitar som ska påverkas.
+*                  - operation: Bitoperation som ska genomföras.
+********************************************************************************/
+void hal_host_modify(const enum hal_reg reg,
+                     const uint8_t mask,
+                     const enum hal_host_operation operation);
+
+/********************************************************************************
+* hal_host_read16: Läser av emulerat 16-bitars register.
+*
+*                  - reg: Registrets lågbyte.
+********************************************************************************/
+uint16_t hal_host_read16(const enum hal_reg reg);
+
+/********************************************************************************
+* hal_host_write16: Skriver till emulerat 16-bitars register.
+*
+*                   - reg  : Registrets lågbyte.
+*                   - value: Värdet som ska skrivas.
+********************************************************************************/
+void hal_host_write16(const enum hal_reg reg,
+                      const uint16_t value);
+
+/********************************************************************************
+* hal_host_set_interrupts: Aktiverar eller inaktiverar avbrott globalt
+*                          (I-flaggan). Vid aktivering exekveras eventuella
+*                          väntande avbrott direkt.
+*
+*                          - enabled: Indikerar ifall avbrott ska aktiveras.
+********************************************************************************/
+void hal_host_set_interrupts(const bool enabled);
+
+/********************************************************************************
+* hal_host_interrupts_enabled: Indikerar ifall avbrott är aktiverade globalt.
+********************************************************************************/
+bool hal_host_interrupts_enabled(void);
+
+/********************************************************************************
+* hal_host_save_state: Sparar I-flaggan och inaktiverar avbrott. Används av
+*                      ATOMIC_BLOCK.
+********************************************************************************/
+uint8_t hal_host_save_state(void);
+
+/********************************************************************************
+* hal_host_restore_state: Återställer sparad I-flagga vid slutet av ett
+*                         atomärt block (ATOMIC_RESTORESTATE).
+*
+*                         - state: Pekare till sparad I-flagga.
+********************************************************************************/
+void hal_host_restore_state(const uint8_t* state);
+
+/********************************************************************************
+* hal_host_force_on: Aktiverar avbrott vid slutet av ett atomärt block
+*                    (ATOMIC_FORCEON).
+*
+*                    - state: Pekare till sparad I-flagga (används ej).
+********************************************************************************/
+void hal_host_force_on(const uint8_t* state);
+
+/********************************************************************************
+* hal_host_delay_cycles: Stegar fram den virtuella klockan angivet antal
+*                        cykler, varvid emulerade timers räknas upp och
+*                        eventuella avbrott exekveras.
+*
+*                        - cycles: Antalet cykler som ska förbrukas.
+********************************************************************************/
+void hal_host_delay_cycles(const uint64_t cycles);
+
+/********************************************************************************
+* hal_host_sleep: Emulerar instruktionen sleep. Ifall SE är ettställt i SMCR
+*                 och avbrott är aktiverade stegas den virtuella klockan fram
+*                 till nästa avbrott, utan att cyklerna räknas som aktiva.
+*                 I power-down (SM = 010) stoppas timrarna, varvid endast
+*                 PCI-avbrott från schemalagda insignaler kan väcka
+*                 processorn. Ifall inget avbrott kan inträffa avslutas
+*                 programmet vid angiven körtid, alternativt sker retur direkt.
+********************************************************************************/
+void hal_host_sleep(void);
+
+/********************************************************************************
+* hal_host_set_input: Sätter extern insignal på angiven pin, exempelvis för
+*                     simulering av nedtryckt tryckknapp. Eventuella
+*                     PCI-avbrott genereras.
+*
+*                     - io_port: I/O-port (0 = B, 1 = C, 2 = D).
+*                     - pin    : Pin-nummer på aktuell I/O-port.
+*                     - high   : Indikerar ifall insignalen ska vara hög.
+********************************************************************************/
+void hal_host_set_input(const uint8_t io_port,
+                        const uint8_t pin,
+                        const bool high);
+
+/********************************************************************************
+* hal_host_cycles: Returnerar den virtuella klockans värde mätt i cykler
+*                  sedan programstart.
+********************************************************************************/
+uint64_t hal_host_cycles(void);
+
+/********************************************************************************
+* hal_host_get_stats: Läser av statistik sedan senaste nollställning.
+*
+*                     - stats: Pekare till strukt där statistiken lagras.
+********************************************************************************/
+void hal_host_get_stats(struct hal_host_stats* stats);
+
+/********************************************************************************
+* hal_host_reset_stats: Nollställer statistiken, men inte den virtuella klockan
+*                       eller registrens innehåll.
+********************************************************************************/
+void hal_host_reset_stats(void);
+
+/********************************************************************************
+* hal_host_print_report: Skriver ut statistik per register till stderr.
+********************************************************************************/
+void hal_host_print_report(void);
+
+/********************************************************************************
+* hal_host_shift_register_output: Returnerar låsta utgångar (Q0 - Q7) för
+*                                 angivet skiftregister i den emulerade
+*                                 kedjan, där 0 är skiftregistret närmast
+*                                 mikrodatorn. Ifall index ligger utanför
+*                                 kedjan returneras 0.
+*
+*                                 - chip: Skiftregistrets index i kedjan.
+********************************************************************************/
+uint8_t hal_host_shift_register_output(const uint8_t chip);
+
+/********************************************************************************
+* hal_host_shift_register_latches: Returnerar antalet gånger som kedjans
+*                                  utgångar har låsts sedan programstart.
+********************************************************************************/
+uint64_t hal_host_shift_register_latches(void);
+
+#endif /* HAL_HOST_H_ */
@@ -0,0 +1,554 @@
+/********************************************************************************
+* led_list_bench.c: Prestandamätning av samtliga operationer i led_list för
+*                   listor med 10 till 100 000 noder, samt indexering och
+*                   gruppoperationer i led_ulist för jämförelse. Programmet
+*                   körs mot den emulerade värdbackenden, så att både
+*                   verklig tid per operation på värden samt simulerat antal
+*                   AVR-cykler och registerskrivningar per operation kan
+*                   redovisas.
+*
+*                   Resultatet skrivs till stdout som CSV (standard) eller
+*                   som JSON-rader (--json), en rad per operation och
+*                   liststorlek, för jämförelse mellan olika versioner:
+*
+*                   operation       : Namn på mätt operation.
+*                   size            : Listans storlek vid mätningen.
+*                   ops             : Antalet mätta operationer.
+*                   ns_per_op       : Tid per operation på värden.
+*                   allocs_per_op   : Antalet nodallokeringar per operation.
+*                   bytes_per_node  : Minnesåtgång per nod i nodpoolen.
+*                   cycles_per_op   : Simulerade AVR-cykler för registeråtkomst.
+*                   writes_per_op   : Antalet registerskrivningar per operation.
+*
+*                   Flaggor: --json, --max <storlek>, --min-ms <tid per mätning>.
+********************************************************************************/
+#include "../led_list.h"
+#include "../led_ulist.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* Antalet slumpmässiga åtkomster per mätomgång: */
+#define BENCH_BATCH 1000
+
+/* Antalet gruppoperationer (on/off/toggle) per mätomgång: */
+#define BENCH_GROUP_BATCH 100
+
+/********************************************************************************
+* bench_measure: Strukt för ackumulerade mätvärden för en operation.
+********************************************************************************/
+struct bench_measure
+{
+   uint64_t ns;          /* Uppmätt tid på värden i nanosekunder. */
+   uint64_t ops;         /* Antalet mätta operationer. */
+   uint64_t allocations; /* Antalet nodallokeringar. */
+   uint64_t cycles;      /* Simulerade AVR-cykler. */
+   uint64_t writes;      /* Antalet registerskrivningar. */
+
+   uint64_t start_ns;          /* Starttid för pågående mätning. */
+   uint32_t start_allocations; /* Antalet allokeringar vid start. */
+};
+
+/* Statiska variabler: */
+static struct led bench_leds[20];    /* Lysdioder på samtliga pins 0 - 19. */
+static uint32_t bench_seed = 2463534242UL; /* Frö för slumptalsgeneratorn. */
+static uint64_t bench_min_ns = 20000000ULL; /* Minsta mättid per operation. */
+static bool bench_json = false;      /* Indikerar utskrift som JSON-rader. */
+
+/********************************************************************************
+* bench_now_ns: Returnerar monoton tid i nanosekunder.
+********************************************************************************/
+static uint64_t bench_now_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/********************************************************************************
+* bench_random: Returnerar ett slumptal i intervallet [0, limit) via xorshift32.
+*
+*               - limit: Övre gräns (exklusiv).
+********************************************************************************/
+static size_t bench_random(const size_t limit)
+{
+   bench_seed ^= bench_seed << 13;
+   bench_seed ^= bench_seed >> 17;
+   bench_seed ^= bench_seed << 5;
+   return limit ? bench_seed % limit : 0;
+}
+
+/********************************************************************************
+* bench_start: Startar en mätning.
+*
+*              - self: Pekare till mätningen.
+********************************************************************************/
+static void bench_start(struct bench_measure* self)
+{
+   struct led_node_pool_stats pool;
+   led_node_pool_get_stats(&pool);
+   self->start_allocations = pool.allocations;
+   hal_host_reset_stats();
+   self->start_ns = bench_now_ns();
+   return;
+}
+
+/********************************************************************************
+* bench_stop: Avslutar en mätning och ackumulerar resultatet.
+*
+*             - self: Pekare till mätningen.
+*             - ops : Antalet operationer som har genomförts sedan start.
+********************************************************************************/
+static void bench_stop(struct bench_measure* self,
+                       const uint64_t ops)
+{
+   const uint64_t end_ns = bench_now_ns();
+   struct led_node_pool_stats pool;
+   struct hal_host_stats hal;
+
+   led_node_pool_get_stats(&pool);
+   hal_host_get_stats(&hal);
+
+   self->ns += end_ns - self->start_ns;
+   self->ops += ops;
+   self->allocations += pool.allocations - self->start_allocations;
+   self->cycles += hal.cycles;
+   self->writes += hal.writes;
+   return;
+}
+
+/********************************************************************************
+* bench_done: Indikerar ifall tillräckligt lång tid har mätts.
+*
+*             - self: Pekare till mätningen.
+********************************************************************************/
+static bool bench_done(const struct bench_measure* self)
+{
+   return self->ns >= bench_min_ns;
+}
+
+/********************************************************************************
+* bench_report: Skriver ut resultatet för en operation.
+*
+*               - operation     : Operationens namn.
+*               - size          : Listans storlek.
+*               - bytes_per_node: Minnesåtgång per lagrad lysdiod.
+*               - self          : Pekare till mätningen.
+********************************************************************************/
+static void bench_report(const char* operation,
+                         const size_t size,
+                         const size_t bytes_per_node,
+                         const struct bench_measure* self)
+{
+   const double ops = self->ops ? (double)self->ops : 1.0;
+
+   if (bench_json)
+   {
+      printf("{\"operation\":\"%s\",\"size\":%zu,\"ops\":%llu,\"ns_per_op\":%.2f,"
+             "\"allocs_per_op\":%.3f,\"bytes_per_node\":%zu,\"cycles_per_op\":%.2f,"
+             "\"writes_per_op\":%.2f}\n", operation, size, (unsigned long long)self->ops,
+             self->ns / ops, self->allocations / ops, bytes_per_node,
+             self->cycles / ops, self->writes / ops);
+   }
+   else
+   {
+      printf("%s,%zu,%llu,%.2f,%.3f,%zu,%.2f,%.2f\n", operation, size,
+             (unsigned long long)self->ops, self->ns / ops, self->allocations / ops,
+             bytes_per_node, self->cycles / ops, self->writes / ops);
+   }
+
+   fflush(stdout);
+   return;
+}
+
+/********************************************************************************
+* bench_fill: Fyller angiven lista med angivet antal lysdioder (omätt).
+*
+*             - list: Pekare till listan.
+*             - size: Antalet lysdioder som ska läggas till.
+********************************************************************************/
+static void bench_fill(struct led_list* list,
+                       const size_t size)
+{
+   for (size_t i = 0; i < size; ++i)
+   {
+      if (led_list_push_back(list, &bench_leds[i % 20]))
+      {
+         fprintf(stderr, "node pool exhausted at %zu nodes\n", list->size);
+         exit(1);
+      }
+   }
+
+   return;
+}
+
+/********************************************************************************
+* bench_push: Mäter push_back respektive push_front till en tom lista.
+********************************************************************************/
+static void bench_push(const size_t size,
+                       const bool front)
+{
+   struct bench_measure m = { 0 };
+   struct led_list list;
+   led_list_init(&list);
+
+   while (!bench_done(&m))
+   {
+      bench_start(&m);
+
+      for (size_t i = 0; i < size; ++i)
+      {
+         if (front) led_list_push_front(&list, &bench_leds[i % 20]);
+         else led_list_push_back(&list, &bench_leds[i % 20]);
+      }
+
+      bench_stop(&m, size);
+      led_list_clear(&list);
+   }
+
+   bench_report(front ? "push_front" : "push_back", size, sizeof(struct led_node), &m);
+   return;
+}
+
+/********************************************************************************
+* bench_pop: Mäter pop_back respektive pop_front tills listan är tom.
+********************************************************************************/
+static void bench_pop(const size_t size,
+                      const bool front)
+{
+   struct bench_measure m = { 0 };
+   struct led_list list;
+   led_list_init(&list);
+
+   while (!bench_done(&m))
+   {
+      bench_fill(&list, size);
+      bench_start(&m);
+
+      for (size_t i = 0; i < size; ++i)
+      {
+         if (front) led_list_pop_front(&list);
+         else led_list_pop_back(&list);
+      }
+
+      bench_stop(&m, size);
+   }
+
+   bench_report(front ? "pop_front" : "pop_back", size, sizeof(struct led_node), &m);
+   return;
+}
+
+/********************************************************************************
+* bench_at: Mäter led_list_at på slumpmässiga index.
+********************************************************************************/
+static void bench_at(const size_t size)
+{
+   struct bench_measure m = { 0 };
+   struct led_list list;
+   volatile uintptr_t sink = 0;
+
+   led_list_init(&list);
+   bench_fill(&list, size);
+
+   while (!bench_done(&m))
+   {
+      bench_start(&m);
+
+      for (size_t i = 0; i < BENCH_BATCH; ++i)
+      {
+         sink += (uintptr_t)led_list_at(&list, bench_random(size));
+      }
+
+      bench_stop(&m, BENCH_BATCH);
+   }
+
+   led_list_clear(&list);
+   bench_report("at", size, sizeof(struct led_node), &m);
+   return;
+}
+
+/********************************************************************************
+* bench_set: Mäter led_list_set på följdriktiga index, dvs. det vanliga fallet
+*            där listan tilldelas i en loop. För stora listor mäts ett fönster
+*            om BENCH_BATCH index mitt i listan.
+********************************************************************************/
+static void bench_set(const size_t size)
+{
+   struct bench_measure m = { 0 };
+   struct led_list list;
+   const size_t count = size < BENCH_BATCH ? size : BENCH_BATCH;
+   const size_t first = (size - count) / 2;
+
+   led_list_init(&list);
+   bench_fill(&list, size);
+
+   while (!bench_done(&m))
+   {
+      bench_start(&m);
+
+      for (size_t i = first; i < first + count; ++i)
+      {
+         led_list_set(&list, i, &bench_leds[(i + 1) % 20]);
+      }
+
+      bench_stop(&m, count);
+   }
+
+   led_list_clear(&list);
+   bench_report("set", size, sizeof(struct led_node), &m);
+   return;
+}
+
+/********************************************************************************
+* bench_insert_remove: Mäter insert_at respektive remove_at på slumpmässiga
+*                      index. Listans storlek återställs mellan mätomgångarna.
+********************************************************************************/
+static void bench_insert_remove(const size_t size,
+                                const bool insert)
+{
+   struct bench_measure m = { 0 };
+   struct led_list list;
+   const size_t count = BENCH_BATCH;
+
+   led_list_init(&list);
+   bench_fill(&list, size + 2);
+
+   while (!bench_done(&m))
+   {
+      if (insert) bench_start(&m);
+
+      for (size_t i = 0; i < count; ++i)
+      {
+         led_list_insert_at(&list, 1 + bench_random(list.size - 2), &bench_leds[i % 20]);
+      }
+
+      if (insert) bench_stop(&m, count);
+      else bench_start(&m);
+
+      for (size_t i = 0; i < count; ++i)
+      {
+         led_list_remove_at(&list, 1 + bench_random(list.size - 2));
+      }
+
+      if (!insert) bench_stop(&m, count);
+   }
+
+   led_list_clear(&list);
+   bench_report(insert ? "insert_at" : "remove_at", size, sizeof(struct led_node), &m);
+   return;
+}
+
+/********************************************************************************
+* bench_clear: Mäter tömning av en lista med angivet antal noder.
+********************************************************************************/
+static void bench_clear(const size_t size)
+{
+   struct bench_measure m = { 0 };
+   struct led_list list;
+   led_list_init(&list);
+
+   while (!bench_done(&m))
+   {
+      bench_fill(&list, size);
+      bench_start(&m);
+      led_list_clear(&list);
+      bench_stop(&m, 1);
+   }
+
+   bench_report("clear", size, sizeof(struct led_node), &m);
+   return;
+}
+
+/********************************************************************************
+* bench_group: Mäter gruppoperationerna led_list_on, led_list_off samt
+*              led_list_toggle.
+*
+*              - size     : Listans storlek.
+*              - operation: Namn på operationen som ska mätas.
+*              - function : Pekare till gruppoperationen.
+********************************************************************************/
+static void bench_group(const size_t size,
+                        const char* operation,
+                        void (*function)(struct led_list*))
+{
+   struct bench_measure m = { 0 };
+   struct led_list list;
+
+   led_list_init(&list);
+   bench_fill(&list, size);
+   function(&list);
+
+   while (!bench_done(&m))
+   {
+      bench_start(&m);
+
+      for (size_t i = 0; i < BENCH_GROUP_BATCH; ++i)
+      {
+         function(&list);
+      }
+
+      bench_stop(&m, BENCH_GROUP_BATCH);
+   }
+
+   led_list_clear(&list);
+   bench_report(operation, size, sizeof(struct led_node), &m);
+   return;
+}
+
+/********************************************************************************
+* bench_ulist_fill: Fyller angiven utrullad lista med angivet antal lysdioder
+*                   (omätt).
+*
+*                   - list: Pekare till listan.
+*                   - size: Antalet lysdioder som ska läggas till.
+********************************************************************************/
+static void bench_ulist_fill(struct led_ulist* list,
+                             const size_t size)
+{
+   for (size_t i = 0; i < size; ++i)
+   {
+      if (led_ulist_push_back(list, &bench_leds[i % 20]))
+      {
+         fprintf(stderr, "chunk pool exhausted at %zu elements\n", list->size);
+         exit(1);
+      }
+   }
+
+   return;
+}
+
+/********************************************************************************
+* bench_ulist_at: Mäter led_ulist_at på slumpmässiga index, för jämförelse
+*                 med led_list_at.
+********************************************************************************/
+static void bench_ulist_at(const size_t size)
+{
+   struct bench_measure m = { 0 };
+   struct led_ulist list;
+   volatile uintptr_t sink = 0;
+
+   led_ulist_init(&list);
+   bench_ulist_fill(&list, size);
+
+   while (!bench_done(&m))
+   {
+      bench_start(&m);
+
+      for (size_t i = 0; i < BENCH_BATCH; ++i)
+      {
+         sink += (uintptr_t)led_ulist_at(&list, bench_random(size));
+      }
+
+      bench_stop(&m, BENCH_BATCH);
+   }
+
+   led_ulist_clear(&list);
+   bench_report("ulist_at", size, sizeof(struct led_chunk) / LED_ULIST_CHUNK_SIZE, &m);
+   return;
+}
+
+/********************************************************************************
+* bench_ulist_group: Mäter gruppoperationerna för utrullade listor, för
+*                    jämförelse med motsvarande operationer för led_list.
+*
+*                    - size     : Listans storlek.
+*                    - operation: Namn på operationen som ska mätas.
+*                    - function : Pekare till gruppoperationen.
+********************************************************************************/
+static void bench_ulist_group(const size_t size,
+                              const char* operation,
+                              void (*function)(struct led_ulist*))
+{
+   struct bench_measure m = { 0 };
+   struct led_ulist list;
+
+   led_ulist_init(&list);
+   bench_ulist_fill(&list, size);
+   function(&list);
+
+   while (!bench_done(&m))
+   {
+      bench_start(&m);
+
+      for (size_t i = 0; i < BENCH_GROUP_BATCH; ++i)
+      {
+         function(&list);
+      }
+
+      bench_stop(&m, BENCH_GROUP_BATCH);
+   }
+
+   led_ulist_clear(&list);
+   bench_report(operation, size, sizeof(struct led_chunk) / LED_ULIST_CHUNK_SIZE, &m);
+   return;
+}
+
+/********************************************************************************
+* main: Tolkar flaggor och mäter samtliga operationer för liststorlekar
+*       10, 100, 1000, 10 000 samt 100 000 noder.
+********************************************************************************/
+int main(int argc, char** argv)
+{
+   static const size_t sizes[] = { 10, 100, 1000, 10000, 100000 };
+   size_t max_size = sizes[sizeof(sizes) / sizeof(sizes[0]) - 1];
+
+   for (int i = 1; i < argc; ++i)
+   {
+      if (!strcmp(argv[i], "--json")) bench_json = true;
+      else if (!strcmp(argv[i], "--max") && i + 1 < argc) max_size = strtoul(argv[++i], 0, 10);
+      else if (!strcmp(argv[i], "--min-ms") && i + 1 < argc) bench_min_ns = strtoull(argv[++i], 0, 10) * 1000000ULL;
+      else
+      {
+         fprintf(stderr, "usage: %s [--json] [--max size] [--min-ms ms]\n", argv[0]);
+         return 1;
+      }
+   }
+
+   if (max_size + BENCH_BATCH + 2 > LED_LIST_POOL_SIZE)
+   {
+      fprintf(stderr, "LED_LIST_POOL_SIZE (%lu) too small for --max %zu\n",
+              (unsigned long)LED_LIST_POOL_SIZE, max_size);
+      return 1;
+   }
+
+   if (max_size > (size_t)LED_ULIST_POOL_SIZE * LED_ULIST_CHUNK_SIZE)
+   {
+      fprintf(stderr, "LED_ULIST_POOL_SIZE (%lu) too small for --max %zu\n",
+              (unsigned long)LED_ULIST_POOL_SIZE, max_size);
+      return 1;
+   }
+
+   for (uint8_t i = 0; i < 20; ++i)
+   {
+      led_init(&bench_leds[i], i);
+   }
+
+   if (!bench_json)
+   {
+      printf("operation,size,ops,ns_per_op,allocs_per_op,bytes_per_node,cycles_per_op,writes_per_op\n");
+   }
+
+   for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]) && sizes[i] <= max_size; ++i)
+   {
+      const size_t size = sizes[i];
+      bench_push(size, false);
+      bench_push(size, true);
+      bench_pop(size, false);
+      bench_pop(size, true);
+      bench_at(size);
+      bench_set(size);
+      bench_insert_remove(size, true);
+      bench_insert_remove(size, false);
+      bench_clear(size);
+      bench_group(size, "on", led_list_on);
+      bench_group(size, "off", led_list_off);
+      bench_group(size, "toggle", led_list_toggle);
+      bench_ulist_at(size);
+      bench_ulist_group(size, "ulist_on", led_ulist_on);
+      bench_ulist_group(size, "ulist_off", led_ulist_off);
+      bench_ulist_group(size, "ulist_toggle", led_ulist_toggle);
+   }
+
+   return 0;
+}
@@ -1,156 +1,272 @@
-/********************************************************************************
-* led.h: Innehller funktionsdefinitioner fr implementering av lysdioder och
-*        andra digitala utportar via strukten led.
-********************************************************************************/
-#include "led.h"
-
-/********************************************************************************
-* led_init: Initierar ny lysdiod p angiven pin.
-*
-*           - self: Pekare till lysdioden som ska initieras.
-*           - pin : Lysdiodens pin-nummer p Arduino Uno, exempelvis 8.
-*                   Alternativt kan motsvarande port-nummer p ATmega328P
-*                   anges, exempelvis B0 fr pin 8 eller D2 fr pin 2.
-********************************************************************************/
-void led_init(struct led* self,
-              const uint8_t pin)
-{
-   if (pin >= 0 && pin <= 7)
-   {
-      self->io_port = IO_PORTD,
-      self->pin = pin;
-      DDRD |= (1 << self->pin);
-   }
-   else if (pin >= 8 && pin <= 13)
-   {
-      self->io_port = IO_PORTB;
-      self->pin = pin - 8;
-      DDRB |= (1 << self->pin);
-   }
-   else if (pin >= 14 && pin <= 19)
-   {
-      self->io_port = IO_PORTC;
-      self->pin = pin - 14;
-      DDRC |= (1 << self->pin);
-   }
-   else
-   {
-      self->io_port = IO_PORT_NONE;
-      self->pin = 0;
-   }
-
-   self->enabled = false;
-   return;
-}
-
-/********************************************************************************
-* led_clear: Nollstller lysdiod samt motsvarande pin.
-*
-*            - self: Pekare till lysdioden som ska nollstllas.
-********************************************************************************/
-void led_clear(struct led* self)
-{
-   if (self->io_port == IO_PORTB)
-   {
-      DDRB &= ~(1 << self->pin);
-      PORTB &= ~(1 << self->pin);
-   }
-   else if (self->io_port == IO_PORTC)
-   {
-      DDRC &= ~(1 << self->pin);
-      PORTC &= ~(1 << self->pin);
-   }
-   else if (self->io_port == IO_PORTD)
-   {
-      DDRD &= ~(1 << self->pin);
-      PORTD &= ~(1 << self->pin);
-   }
-
-   self->io_port = IO_PORT_NONE;
-   self->pin = 0;
-   self->enabled = false;
-   return;
-}
-
-/********************************************************************************
-* led_on: Tnder angiven lysdiod.
-*
-*         - self: Pekare till lysdioden som ska tndas.
-********************************************************************************/
-void led_on(struct led* self)
-{
-   if (self->io_port == IO_PORTB)
-   {
-      PORTB |= (1 << self->pin);
-   }
-   else if (self->io_port == IO_PORTC)
-   {
-      PORTC |= (1 << self->pin);
-   }
-   else if (self->io_port == IO_PORTD)
-   {
-      PORTD |= (1 << self->pin);
-   }
-
-   self->enabled = true;
-   return;
-}
-
-/********************************************************************************
-* led_off: Slcker angiven lysdiod.
-*
-*          - self: Pekare till lysdioden som ska slckas.
-********************************************************************************/
-void led_off(struct led* self)
-{
-   if (self->io_port == IO_PORTB)
-   {
-      PORTB &= ~(1 << self->pin);
-   }
-   else if (self->io_port == IO_PORTC)
-   {
-      PORTC &= ~(1 << self->pin);
-   }
-   else if (self->io_port == IO_PORTD)
-   {
-      PORTD &= ~(1 << self->pin);
-   }
-
-   self->enabled = false;
-   return;
-}
-
-/********************************************************************************
-* led_toggle: Togglar utsignalen p angiven lysdiod. Om lysdioden r slckt vid
-*             anropet s tnds den. P samma stt gller att om lysdioden r
-*             tnd vid anropet s slcks den.
-*
-*             - self: Pekare till lysdioden vars utsignal ska togglas.
-********************************************************************************/
-void led_toggle(struct led* self)
-{
-   if (self->enabled)
-   {
-      led_off(self);
-   }
-   else
-   {
-      led_on(self);
-   }
-
-   return;
-}
-
-/********************************************************************************
-* led_blink: Blinkar lysdiod en gng med angiven blinkhastighet.
-*
-*            - self          : Pekare till lysdioden som ska blinkas.
-*            - blink_speed_ms: Blinkhastigheten mtt i millisekunder.
-********************************************************************************/
-void led_blink(struct led* self,
-               const uint16_t blink_speed_ms)
-{
-   led_toggle(self);
-   delay_ms(blink_speed_ms);
-   return;
+/********************************************************************************
+* led.h: Innehåller funktionsdefinitioner för implementering av lysdioder och
+*        andra digitala utportar via strukten led.
+********************************************************************************/
+#include "led.h"
+
+/********************************************************************************
+* led_init: Initierar ny lysdiod på angiven pin.
+*
+*           - self: Pekare till lysdioden som ska initieras.
+*           - pin : Lysdiodens pin-nummer på Arduino Uno, exempelvis 8.
+*                   Alternativt kan motsvarande port-nummer på ATmega328P
+*                   anges, exempelvis B0 för pin 8 eller D2 för pin 2.
+********************************************************************************/
+void led_init(struct led* self,
+              const uint8_t pin)
+{
+   if (pin >= 0 && pin <= 7)
+   {
+      self->io_port = IO_PORTD,
+      self->pin = pin;
+      REG_SET(DDRD, 1 << self->pin);
+   }
+   else if (pin >= 8 && pin <= 13)
+   {
+      self->io_port = IO_PORTB;
+      self->pin = pin - 8;
+      REG_SET(DDRB, 1 << self->pin);
+   }
+   else if (pin >= 14 && pin <= 19)
+   {
+      self->io_port = IO_PORTC;
+      self->pin = pin - 14;
+      REG_SET(DDRC, 1 << self->pin);
+   }
+   else
+   {
+      self->io_port = IO_PORT_NONE;
+      self->pin = 0;
+   }
+
+   self->enabled = false;
+#if LED_ILIST_ENABLE
+   self->hook.previous = 0;
+   self->hook.next = 0;
+   self->hook.list = 0;
+#endif
+   return;
+}
+
+/********************************************************************************
+* led_init_shift_register: Initierar ny lysdiod på angiven utgång i
+*                          skiftregisterkedjan, se shift_register.h.
+*                          Kedjan måste ha initierats via shift_register_init.
+*                          Ifall utgången ligger utanför kedjan sätts I/O-port
+*                          till IO_PORT_NONE, varvid lysdioden inte styrs.
+*
+*                          - self  : Pekare till lysdioden som ska initieras.
+*                          - output: Utgångens nummer i kedjan, där 0 är Q0
+*                                    på skiftregistret närmast mikrodatorn.
+********************************************************************************/
+void led_init_shift_register(struct led* self,
+                             const uint8_t output)
+{
+   if (output < shift_register_num_outputs())
+   {
+      self->io_port = IO_PORT_SHIFT_REGISTER;
+      self->pin = output;
+      shift_register_write(output, false);
+      shift_register_commit();
+   }
+   else
+   {
+      self->io_port = IO_PORT_NONE;
+      self->pin = 0;
+   }
+
+   self->enabled = false;
+#if LED_ILIST_ENABLE
+   self->hook.previous = 0;
+   self->hook.next = 0;
+   self->hook.list = 0;
+#endif
+   return;
+}
+
+/********************************************************************************
+* led_init_matrix: Initierar ny lysdiod på angiven cell i den lysdiodmatris
+*                  som senast initierades, se led_matrix.h. Ifall ingen
+*                  matris är initierad eller cellen ligger utanför matrisen
+*                  sätts I/O-port till IO_PORT_NONE, varvid lysdioden inte
+*                  styrs.
+*
+*                  - self  : Pekare till lysdioden som ska initieras.
+*                  - row   : Cellens rad.
+*                  - column: Cellens kolumn.
+********************************************************************************/
+void led_init_matrix(struct led* self,
+                     const uint8_t row,
+                     const uint8_t column)
+{
+   if (row < LED_MATRIX_MAX_ROWS && column < LED_MATRIX_MAX_COLUMNS &&
+       !led_matrix_cell_write(LED_MATRIX_CELL(row, column), false))
+   {
+      self->io_port = IO_PORT_MATRIX;
+      self->pin = LED_MATRIX_CELL(row, column);
+   }
+   else
+   {
+      self->io_port = IO_PORT_NONE;
+      self->pin = 0;
+   }
+
+   self->enabled = false;
+#if LED_ILIST_ENABLE
+   self->hook.previous = 0;
+   self->hook.next = 0;
+   self->hook.list = 0;
+#endif
+   return;
+}
+
+/********************************************************************************
+* led_clear: Nollställer lysdiod samt motsvarande pin.
+*
+*            - self: Pekare till lysdioden som ska nollställas.
+********************************************************************************/
+void led_clear(struct led* self)
+{
+   if (self->io_port == IO_PORTB)
+   {
+      REG_CLEAR(DDRB, 1 << self->pin);
+      REG_CLEAR(PORTB, 1 << self->pin);
+   }
+   else if (self->io_port == IO_PORTC)
+   {
+      REG_CLEAR(DDRC, 1 << self->pin);
+      REG_CLEAR(PORTC, 1 << self->pin);
+   }
+   else if (self->io_port == IO_PORTD)
+   {
+      REG_CLEAR(DDRD, 1 << self->pin);
+      REG_CLEAR(PORTD, 1 << self->pin);
+   }
+   else if (self->io_port == IO_PORT_SHIFT_REGISTER)
+   {
+      shift_register_write(self->pin, false);
+      shift_register_commit();
+   }
+   else if (self->io_port == IO_PORT_MATRIX)
+   {
+      led_matrix_cell_write(self->pin, false);
+   }
+
+   self->io_port = IO_PORT_NONE;
+   self->pin = 0;
+   self->enabled = false;
+   return;
+}
+
+/********************************************************************************
+* led_on: Tänder angiven lysdiod.
+*
+*         - self: Pekare till lysdioden som ska tändas.
+********************************************************************************/
+void led_on(struct led* self)
+{
+   if (self->io_port < IO_PORT_NONE)
+   {
+      port_shadow_write(self->io_port, 1 << self->pin, PORT_SHADOW_SET);
+   }
+   else if (self->io_port == IO_PORT_SHIFT_REGISTER)
+   {
+      shift_register_write(self->pin, true);
+      shift_register_commit();
+   }
+   else if (self->io_port == IO_PORT_MATRIX)
+   {
+      led_matrix_cell_write(self->pin, true);
+   }
+
+   self->enabled = true;
+   return;
+}
+
+/********************************************************************************
+* led_off: Släcker angiven lysdiod.
+*
+*          - self: Pekare till lysdioden som ska släckas.
+********************************************************************************/
+void led_off(struct led* self)
+{
+   if (self->io_port < IO_PORT_NONE)
+   {
+      port_shadow_write(self->io_port, 1 << self->pin, PORT_SHADOW_CLEAR);
+   }
+   else if (self->io_port == IO_PORT_SHIFT_REGISTER)
+   {
+      shift_register_write(self->pin, false);
+      shift_register_commit();
+   }
+   else if (self->io_port == IO_PORT_MATRIX)
+   {
+      led_matrix_cell_write(self->pin, false);
+   }
+
+   self->enabled = false;
+   return;
+}
+
+/********************************************************************************
+* led_toggle: Togglar utsignalen på angiven lysdiod. Om lysdioden är släckt vid
+*             anropet så tänds den. På samma sätt gäller att om lysdioden är
+*             tänd vid anropet så släcks den.
+*
+*             Togglingen sker genom att en etta skrivs till motsvarande bit i
+*             registret PINx, vilket på ATmega328P togglar PORTx i hårdvaran.
+*             Skrivningen är en enda instruktion utan läsning av PORTx och
+*             påverkas därmed inte av avbrott som ändrar andra pinnar.
+*             Under en ram (se port_shadow.h) togglas i stället biten i den
+*             bakre bufferten. Utgångar i skiftregisterkedjan togglas i skuggbufferten,
+*             som sedan skiftas ut.
+*
+*             - self: Pekare till lysdioden vars utsignal ska togglas.
+********************************************************************************/
+void led_toggle(struct led* self)
+{
+   if (self->io_port < IO_PORT_NONE)
+   {
+      port_shadow_write(self->io_port, 1 << self->pin, PORT_SHADOW_TOGGLE);
+   }
+   else if (self->io_port == IO_PORT_SHIFT_REGISTER)
+   {
+      shift_register_toggle(self->pin);
+      shift_register_commit();
+   }
+   else if (self->io_port == IO_PORT_MATRIX)
+   {
+      led_matrix_cell_toggle(self->pin);
+   }
+
+   self->enabled = self->io_port < IO_PORT_NONE ? led_is_enabled(self) : !self->enabled;
+   return;
+}
+
+/********************************************************************************
+* led_blink: Blinkar lysdiod en gång med angiven blinkhastighet.
+*
+*            - self          : Pekare till lysdioden som ska blinkas.
+*            - blink_speed_ms: Blinkhastigheten mätt i millisekunder.
+********************************************************************************/
+void led_blink(struct led* self,
+               const uint16_t blink_speed_ms)
+{
+   led_toggle(self);
+   delay_ms(blink_speed_ms);
+   return;
+}
+
+/********************************************************************************
+* led_pin_write: Genomför angiven operation på lysdiod ansluten till angiven
+*                pin, där pin-numret inte är känt vid kompilering.
+*
+*                - pin      : Lysdiodens pin-nummer på Arduino Uno.
+*                - operation: Operationen som ska genomföras.
+********************************************************************************/
+void led_pin_write(const uint8_t pin,
+                   const enum led_pin_operation operation)
+{
+   led_pin_apply(pin, operation);
+   return;
 }
\ No newline at end of file
@@ -1,72 +1,335 @@
-/********************************************************************************
-* led.h: Innehller funktionalitet fr enkel implementering av lysdioder via
-*        strukten led samt associerade funktioner. Denna strukt fungerar ocks
-*        utmrkt fr andra digitala utportar.
-********************************************************************************/
-#ifndef LED_H_
-#define LED_H_
-
-/* Inkluderingsdirektiv: */
-#include "misc.h"
-
-/********************************************************************************
-* led: Strukt fr implementering av lysdioder och andra digitala utportar.
-********************************************************************************/
-struct led
-{
-   uint8_t pin;          /* Lysdiodens pin-nummer p aktuell I/O-port. */
-   enum io_port io_port; /* I/O-port som lysdioden r ansluten till. */
-   bool enabled;         /* Indikerar ifall lysdioden r tnd. */
-};
-
-/********************************************************************************
-* led_init: Initierar ny lysdiod p angiven pin.
-*
-*           - self: Pekare till lysdioden som ska initieras.
-*           - pin : Lysdiodens pin-nummer p Arduino Uno, exempelvis 8. 
-*                   Alternativt kan motsvarande port-nummer p ATmega328P 
-*                   anges, exempelvis B0 fr pin 8 eller D2 fr pin 2.
-********************************************************************************/
-void led_init(struct led* self, 
-              const uint8_t pin);
-
-/********************************************************************************
-* led_clear: Nollstller lysdiod samt motsvarande pin.
-*
-*            - self: Pekare till lysdioden som ska nollstllas.
-********************************************************************************/
-void led_clear(struct led* self);
-
-/********************************************************************************
-* led_on: Tnder angiven lysdiod.
-*
-*         - self: Pekare till lysdioden som ska tndas.
-********************************************************************************/
-void led_on(struct led* self);
-
-/********************************************************************************
-* led_off: Slcker angiven lysdiod.
-*
-*          - self: Pekare till lysdioden som ska slckas.
-********************************************************************************/
-void led_off(struct led* self);
-
-/********************************************************************************
-* led_toggle: Togglar utsignalen p angiven lysdiod. Om lysdioden r slckt vid
-*             anropet s tnds den. P samma stt gller att om lysdioden r 
-*             tnd vid anropet s slcks den.
-*
-*             - self: Pekare till lysdioden vars utsignal ska togglas.
-********************************************************************************/
-void led_toggle(struct led* self);
-
-/********************************************************************************
-* led_blink: Blinkar lysdiod en gng med angiven blinkhastighet.
-*
-*            - self          : Pekare till lysdioden som ska blinkas.
-*            - blink_speed_ms: Blinkhastigheten mtt i millisekunder.
-********************************************************************************/
-void led_blink(struct led* self,
-               const uint16_t blink_speed_ms);
-
+/********************************************************************************
+* led.h: Innehåller funktionalitet för enkel implementering av lysdioder via
+*        strukten led samt associerade funktioner. Denna strukt fungerar också
+*        utmärkt för andra digitala utportar.
+********************************************************************************/
+#ifndef LED_H_
+#define LED_H_
+
+/* Inkluderingsdirektiv: */
+#include "misc.h"
+#include "led_matrix.h"
+#include "port_shadow.h"
+#include "shift_register.h"
+
+/********************************************************************************
+* LED_ILIST_ENABLE: Aktiverar länkfältet hook i strukten led, vilket krävs för
+*                   intrusiva listor (led_ilist). Länkfältet kostar 6 byte
+*                   per lysdiod på ATmega328P, dvs. strukten led växer från
+*                   4 till 10 byte, och är därför inaktiverat som standard.
+*                   Sätts till 1 för samtliga källkodsfiler vid kompilering,
+*                   exempelvis via -DLED_ILIST_ENABLE=1, så att strukten led
+*                   får samma utseende i hela programmet.
+********************************************************************************/
+#ifndef LED_ILIST_ENABLE
+#define LED_ILIST_ENABLE 0
+#endif
+
+#if LED_ILIST_ENABLE
+
+/* Framåtdeklaration av intrusiv lista (se led_ilist.h): */
+struct led_ilist;
+
+/********************************************************************************
+* led_hook: Länkfält som bäddas in i strukten led, så att lysdioden kan lagras
+*           direkt i en intrusiv dubbellänkad lista (led_ilist) utan separat
+*           nod eller dynamisk minnesallokering. En lysdiod kan därmed ligga
+*           i högst en intrusiv lista åt gången.
+********************************************************************************/
+struct led_hook
+{
+   struct led* previous;   /* Pekare till föregående lysdiod i listan. */
+   struct led* next;       /* Pekare till nästa lysdiod i listan. */
+   struct led_ilist* list; /* Listan som lysdioden ligger i (eller null). */
+};
+
+#endif /* LED_ILIST_ENABLE */
+
+/********************************************************************************
+* led: Strukt för implementering av lysdioder och andra digitala utportar.
+********************************************************************************/
+struct led
+{
+   uint8_t pin;          /* Pin-nummer på aktuell I/O-port, alternativt utgång eller matriscell. */
+   enum io_port io_port; /* I/O-port som lysdioden är ansluten till. */
+   bool enabled;         /* Senast lagrat tillstånd, läses via led_is_enabled. */
+#if LED_ILIST_ENABLE
+   struct led_hook hook; /* Länkfält för intrusiv lista. */
+#endif
+};
+
+/********************************************************************************
+* led_init: Initierar ny lysdiod på angiven pin.
+*
+*           - self: Pekare till lysdioden som ska initieras.
+*           - pin : Lysdiodens pin-nummer på Arduino Uno, exempelvis 8. 
+*                   Alternativt kan motsvarande port-nummer på ATmega328P 
+*                   anges, exempelvis B0 för pin 8 eller D2 för pin 2.
+********************************************************************************/
+void led_init(struct led* self, 
+              const uint8_t pin);
+
+/********************************************************************************
+* led_init_shift_register: Initierar ny lysdiod på angiven utgång i
+*                          skiftregisterkedjan, se shift_register.h.
+*                          Kedjan måste ha initierats via shift_register_init.
+*                          Ifall utgången ligger utanför kedjan sätts I/O-port
+*                          till IO_PORT_NONE, varvid lysdioden inte styrs.
+*
+*                          - self  : Pekare till lysdioden som ska initieras.
+*                          - output: Utgångens nummer i kedjan, där 0 är Q0
+*                                    på skiftregistret närmast mikrodatorn.
+********************************************************************************/
+void led_init_shift_register(struct led* self,
+                             const uint8_t output);
+
+/********************************************************************************
+* led_init_matrix: Initierar ny lysdiod på angiven cell i den lysdiodmatris
+*                  som senast initierades, se led_matrix.h. Ifall ingen
+*                  matris är initierad eller cellen ligger utanför matrisen
+*                  sätts I/O-port till IO_PORT_NONE, varvid lysdioden inte
+*                  styrs.
+*
+*                  - self  : Pekare till lysdioden som ska initieras.
+*                  - row   : Cellens rad.
+*                  - column: Cellens kolumn.
+********************************************************************************/
+void led_init_matrix(struct led* self,
+                     const uint8_t row,
+                     const uint8_t column);
+
+/********************************************************************************
+* led_clear: Nollställer lysdiod samt motsvarande pin.
+*
+*            - self: Pekare till lysdioden som ska nollställas.
+********************************************************************************/
+void led_clear(struct led* self);
+
+/********************************************************************************
+* led_on: Tänder angiven lysdiod.
+*
+*         - self: Pekare till lysdioden som ska tändas.
+********************************************************************************/
+void led_on(struct led* self);
+
+/********************************************************************************
+* led_off: Släcker angiven lysdiod.
+*
+*          - self: Pekare till lysdioden som ska släckas.
+********************************************************************************/
+void led_off(struct led* self);
+
+/********************************************************************************
+* led_toggle: Togglar utsignalen på angiven lysdiod. Om lysdioden är släckt vid
+*             anropet så tänds den. På samma sätt gäller att om lysdioden är 
+*             tänd vid anropet så släcks den. Togglingen sker atomärt via en
+*             skrivning till registret PINx, alternativt i den bakre
+*             bufferten under en ram (se port_shadow.h).
+*
+*             - self: Pekare till lysdioden vars utsignal ska togglas.
+********************************************************************************/
+void led_toggle(struct led* self);
+
+/********************************************************************************
+* led_blink: Blinkar lysdiod en gång med angiven blinkhastighet.
+*
+*            - self          : Pekare till lysdioden som ska blinkas.
+*            - blink_speed_ms: Blinkhastigheten mätt i millisekunder.
+********************************************************************************/
+void led_blink(struct led* self,
+               const uint16_t blink_speed_ms);
+
+/********************************************************************************
+* led_set_enabled: Uppdaterar lysdiodens lagrade tillstånd efter att
+*                  motsvarande GPIO-port redan har skrivits av en
+*                  gruppoperation. För utgångar i skiftregisterkedjan
+*                  uppdateras även skuggbufferten, men utskiftningen lämnas
+*                  till gruppoperationen så att den sker i en enda skur.
+*                  Matrisceller uppdateras direkt i matrisens bild.
+*
+*                  - self   : Pekare till lysdioden.
+*                  - enabled: Indikerar ifall lysdioden är tänd.
+********************************************************************************/
+ALWAYS_INLINE void led_set_enabled(struct led* self,
+                                   const bool enabled)
+{
+   if (self->io_port == IO_PORT_SHIFT_REGISTER)
+   {
+      shift_register_write(self->pin, enabled);
+   }
+   else if (self->io_port == IO_PORT_MATRIX)
+   {
+      led_matrix_cell_write(self->pin, enabled);
+   }
+
+   self->enabled = enabled;
+   return;
+}
+
+/********************************************************************************
+* led_is_enabled: Indikerar ifall angiven lysdiod är tänd. För lysdioder på
+*                 I/O-port B, C och D läses tillståndet från porten (via
+*                 port_shadow_read, så att ändringar under en pågående ram
+*                 inräknas), eftersom listornas gruppoperationer skriver
+*                 sådana lysdioder via bitmasker per port utan att uppdatera
+*                 respektive lysdiods lagrade tillstånd. För övriga utgångar
+*                 returneras det lagrade tillståndet.
+*
+*                 - self: Pekare till lysdioden.
+********************************************************************************/
+ALWAYS_INLINE bool led_is_enabled(const struct led* self)
+{
+   if (self->io_port < IO_PORT_NONE)
+   {
+      return port_shadow_read(self->io_port) & (1 << self->pin);
+   }
+
+   return self->enabled;
+}
+
+/********************************************************************************
+* LED_DEFINE: Definierar en lysdiod vars pin är känd vid kompilering, exempelvis
+*             LED_DEFINE(led1, B2). Namnet blir en heltalskonstant som passeras
+*             till funktionerna led_pin_init, led_pin_on, led_pin_off samt
+*             led_pin_toggle, vilka då kompileras till enstaka sbi- och
+*             cbi-instruktioner utan uppslag av I/O-port under körning.
+*
+*             - name: Lysdiodens namn.
+*             - pin : Lysdiodens pin-nummer på Arduino Uno, exempelvis 10,
+*                     alternativt port-nummer på ATmega328P, exempelvis B2.
+********************************************************************************/
+#define LED_DEFINE(name, pin) enum { name = (pin) }
+
+/********************************************************************************
+* led_pin_operation: Enumeration för operationer på lysdioder utan strukt.
+********************************************************************************/
+enum led_pin_operation
+{
+   LED_PIN_INIT,  /* Sätter pinnen till utport. */
+   LED_PIN_ON,    /* Tänder lysdioden. */
+   LED_PIN_OFF,   /* Släcker lysdioden. */
+   LED_PIN_TOGGLE /* Togglar lysdioden via registret PINx. */
+};
+
+/********************************************************************************
+* led_pin_write: Genomför angiven operation på lysdiod ansluten till angiven
+*                pin, där pin-numret inte är känt vid kompilering.
+*                Anropas av led_pin_-funktionerna nedan vid icke-konstant pin.
+*
+*                - pin      : Lysdiodens pin-nummer på Arduino Uno.
+*                - operation: Operationen som ska genomföras.
+********************************************************************************/
+void led_pin_write(const uint8_t pin,
+                   const enum led_pin_operation operation);
+
+/********************************************************************************
+* led_pin_apply: Genomför angiven operation på lysdiod ansluten till angiven
+*                pin. Vid konstanta argument viks valet av register samt
+*                bitmask bort vid kompilering, så att kvarvarande kod blir en
+*                enda instruktion.
+*
+*                - pin      : Lysdiodens pin-nummer på Arduino Uno.
+*                - operation: Operationen som ska genomföras.
+********************************************************************************/
+ALWAYS_INLINE void led_pin_apply(const uint8_t pin,
+                                 const enum led_pin_operation operation)
+{
+   const uint8_t mask = PIN_MASK(pin);
+
+   if (pin <= 7)
+   {
+      if (operation == LED_PIN_INIT) REG_SET(DDRD, mask);
+      else if (operation == LED_PIN_ON) REG_SET(PORTD, mask);
+      else if (operation == LED_PIN_OFF) REG_CLEAR(PORTD, mask);
+      else REG_WRITE(PIND, mask);
+   }
+   else if (pin <= 13)
+   {
+      if (operation == LED_PIN_INIT) REG_SET(DDRB, mask);
+      else if (operation == LED_PIN_ON) REG_SET(PORTB, mask);
+      else if (operation == LED_PIN_OFF) REG_CLEAR(PORTB, mask);
+      else REG_WRITE(PINB, mask);
+   }
+   else if (pin <= 19)
+   {
+      if (operation == LED_PIN_INIT) REG_SET(DDRC, mask);
+      else if (operation == LED_PIN_ON) REG_SET(PORTC, mask);
+      else if (operation == LED_PIN_OFF) REG_CLEAR(PORTC, mask);
+      else REG_WRITE(PINC, mask);
+   }
+
+   return;
+}
+
+/********************************************************************************
+* led_pin_dispatch: Genomför angiven operation inline ifall pin-numret är känt
+*                   vid kompilering, annars via den generella funktionen
+*                   led_pin_write, så att koden inte dupliceras vid varje anrop.
+*
+*                   - pin      : Lysdiodens pin-nummer på Arduino Uno.
+*                   - operation: Operationen som ska genomföras.
+********************************************************************************/
+ALWAYS_INLINE void led_pin_dispatch(const uint8_t pin,
+                                    const enum led_pin_operation operation)
+{
+   if (__builtin_constant_p(pin))
+   {
+      led_pin_apply(pin, operation);
+   }
+   else
+   {
+      led_pin_write(pin, operation);
+   }
+
+   return;
+}
+
+/********************************************************************************
+* led_pin_init: Sätter angiven pin till utport för en lysdiod.
+*
+*               - pin: Lysdiodens pin-nummer, exempelvis definierat via
+*                      LED_DEFINE.
+********************************************************************************/
+ALWAYS_INLINE void led_pin_init(const uint8_t pin)
+{
+   led_pin_dispatch(pin, LED_PIN_INIT);
+   return;
+}
+
+/********************************************************************************
+* led_pin_on: Tänder lysdiod ansluten till angiven pin.
+*
+*             - pin: Lysdiodens pin-nummer, exempelvis definierat via
+*                    LED_DEFINE.
+********************************************************************************/
+ALWAYS_INLINE void led_pin_on(const uint8_t pin)
+{
+   led_pin_dispatch(pin, LED_PIN_ON);
+   return;
+}
+
+/********************************************************************************
+* led_pin_off: Släcker lysdiod ansluten till angiven pin.
+*
+*              - pin: Lysdiodens pin-nummer, exempelvis definierat via
+*                     LED_DEFINE.
+********************************************************************************/
+ALWAYS_INLINE void led_pin_off(const uint8_t pin)
+{
+   led_pin_dispatch(pin, LED_PIN_OFF);
+   return;
+}
+
+/********************************************************************************
+* led_pin_toggle: Togglar lysdiod ansluten till angiven pin.
+*
+*                 - pin: Lysdiodens pin-nummer, exempelvis definierat via
+*                        LED_DEFINE.
+********************************************************************************/
+ALWAYS_INLINE void led_pin_toggle(const uint8_t pin)
+{
+   led_pin_dispatch(pin, LED_PIN_TOGGLE);
+   return;
+}
+
 #endif /* LED_H_ */
\ No newline at end of file
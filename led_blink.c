@@ -0,0 +1,155 @@
+/********************************************************************************
+* led_blink.c: Innehåller funktionsdefinitioner för den gemensamma
+*              blinkmotorn för led_list och led_vector.
+********************************************************************************/
+#include "led_blink.h"
+
+/* Statiska funktioner: */
+static void led_blink_tick(void);
+
+/* Statiska variabler: */
+static struct led_blink* led_blink_chain = 0; /* Behållare som blinkar via tick. */
+
+/********************************************************************************
+* led_blink_init: Initierar angiven blinkmotor till inaktiv vid start.
+*
+*                 - self: Pekare till blinkmotorn som ska initieras.
+********************************************************************************/
+void led_blink_init(struct led_blink* self)
+{
+   self->mode = LED_LIST_BLINK_NONE;
+   self->speed_ms = 0;
+   self->counter_ms = 0;
+   self->step = 0;
+   self->container = 0;
+   self->next = 0;
+   self->locks = 0;
+   return;
+}
+
+/********************************************************************************
+* led_blink_start: Startar blinkning enligt angivet blinkmönster, varvid
+*                  stegrutinen anropas en gång direkt och sedan en gång per
+*                  angiven blinkhastighet från systemticken. Blinkmotorn
+*                  får inte redan vara startad, utan ska först stoppas via
+*                  led_blink_stop. Ifall systemticken saknar ledig plats
+*                  returneras felkod 1, annars returneras 0.
+*
+*                  - self          : Pekare till blinkmotorn.
+*                  - mode          : Blinkmönster som ska användas.
+*                  - blink_speed_ms: Blinkhastighet mätt i millisekunder.
+*                  - step          : Behållarens stegrutin.
+*                  - container     : Behållaren som skickas till stegrutinen.
+********************************************************************************/
+int led_blink_start(struct led_blink* self,
+                    const enum led_list_blink_mode mode,
+                    const uint16_t blink_speed_ms,
+                    void (*step)(void* container),
+                    void* container)
+{
+   if (timer_attach(led_blink_tick)) return 1;
+
+   self->mode = mode;
+   self->speed_ms = blink_speed_ms > 0 ? blink_speed_ms : 1;
+   self->counter_ms = self->speed_ms;
+   self->step = step;
+   self->container = container;
+   self->step(self->container);
+
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      self->next = led_blink_chain;
+      led_blink_chain = self;
+   }
+
+   return 0;
+}
+
+/********************************************************************************
+* led_blink_stop: Stoppar eventuell pågående blinkning. Om ingen behållare
+*                 längre blinkar kopplas blinkmotorn bort från systemticken.
+*                 Lysdiodernas tillstånd påverkas inte.
+*
+*                 - self: Pekare till blinkmotorn som ska stoppas.
+********************************************************************************/
+void led_blink_stop(struct led_blink* self)
+{
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      for (struct led_blink** i = &led_blink_chain; *i; i = &(*i)->next)
+      {
+         if (*i == self)
+         {
+            *i = self->next;
+            break;
+         }
+      }
+   }
+
+   if (!led_blink_chain)
+   {
+      timer_detach(led_blink_tick);
+   }
+
+   self->mode = LED_LIST_BLINK_NONE;
+   self->next = 0;
+   return;
+}
+
+/********************************************************************************
+* led_blink_lock: Spärrar stegning av angiven blinkmotor från systemticken
+*                 medan behållaren ändras. Spärrar kan nästlas och ska
+*                 hävas via led_blink_unlock. Anropas endast utanför
+*                 avbrottskontext, varvid avbrottsrutinen endast läser
+*                 nästlingsdjupet.
+*
+*                 - self: Pekare till blinkmotorn som ska spärras.
+********************************************************************************/
+void led_blink_lock(struct led_blink* self)
+{
+   self->locks++;
+   COMPILER_BARRIER();
+   return;
+}
+
+/********************************************************************************
+* led_blink_unlock: Häver en spärr påbörjad via led_blink_lock. När den
+*                   yttersta spärren hävs genomförs eventuellt uppskjutet
+*                   steg vid nästa tick.
+*
+*                   - self: Pekare till blinkmotorn vars spärr ska hävas.
+********************************************************************************/
+void led_blink_unlock(struct led_blink* self)
+{
+   COMPILER_BARRIER();
+   if (self->locks) self->locks--;
+   return;
+}
+
+/********************************************************************************
+* led_blink_tick: Callbackrutin som anropas från systemticken en gång per
+*                 millisekund. Samtliga blinkande behållare räknar ned sin
+*                 kvarvarande tid, varefter nästa steg i blinkmönstret
+*                 genomförs då tiden har löpt ut. Är behållaren spärrad
+*                 skjuts steget upp en tick i taget tills spärren hävs.
+********************************************************************************/
+static void led_blink_tick(void)
+{
+   for (struct led_blink* i = led_blink_chain; i; i = i->next)
+   {
+      if (--i->counter_ms == 0)
+      {
+         if (i->locks)
+         {
+            i->counter_ms = 1;
+         }
+         else
+         {
+            i->counter_ms = i->speed_ms;
+            i->step(i->container);
+         }
+      }
+   }
+
+   return;
+}
@@ -0,0 +1,113 @@
+/********************************************************************************
+* led_blink.h: Innehåller den gemensamma blinkmotorn för icke-blockerande
+*              blinkning av lysdioder lagrade i led_list respektive
+*              led_vector, realiserat via strukten led_blink samt
+*              associerade funktioner.
+*
+*              Samtliga blinkande behållare länkas in i en gemensam kedja,
+*              som drivs från systemticken (Timer 0) via en enda
+*              callbackrutin. Varje behållare räknar ned sin kvarvarande tid
+*              en gång per millisekund, varefter behållarens stegrutin
+*              anropas då tiden har löpt ut. Stegrutinen, som genomför
+*              själva blinkmönstret, tillhandahålls av respektive behållare.
+*
+*              Eftersom stegrutinen anropas från avbrottsrutinen för Timer 0
+*              och då stegar igenom behållaren spärrar behållarens
+*              funktioner för ändring av innehållet blinkmotorn via
+*              led_blink_lock samt led_blink_unlock. Ett steg som infaller
+*              under en spärr skjuts upp till första tick efter spärren,
+*              så att stegrutinen aldrig ser en behållare som håller på att
+*              ändras.
+********************************************************************************/
+#ifndef LED_BLINK_H_
+#define LED_BLINK_H_
+
+/* Inkluderingsdirektiv: */
+#include "misc.h"
+#include "timer.h"
+
+/********************************************************************************
+* led_list_blink_mode: Enumeration för val av blinkmönster vid icke-blockerande
+*                      blinkning via led_list_blink_start samt
+*                      led_vector_blink_start.
+********************************************************************************/
+enum led_list_blink_mode
+{
+   LED_LIST_BLINK_NONE,         /* Ingen blinkning. */
+   LED_LIST_BLINK_COLLECTIVELY, /* Kollektiv (synkroniserad) blinkning. */
+   LED_LIST_BLINK_FORWARD,      /* Sekventiell blinkning framåt. */
+   LED_LIST_BLINK_BACKWARD      /* Sekventiell blinkning bakåt. */
+};
+
+/********************************************************************************
+* led_blink: Strukt för blinkning av en behållare via systemticken. Strukten
+*            lagras i behållaren, som även lagrar eventuell aktuell position
+*            i blinkmönstret.
+********************************************************************************/
+struct led_blink
+{
+   enum led_list_blink_mode mode;   /* Aktuellt blinkmönster. */
+   uint16_t speed_ms;               /* Blinkhastighet mätt i millisekunder. */
+   uint16_t counter_ms;             /* Kvarvarande tid till nästa steg. */
+   void (*step)(void* container);   /* Stegrutin för behållarens blinkmönster. */
+   void* container;                 /* Behållaren som blinkar. */
+   struct led_blink* next;          /* Nästa behållare som blinkar via systemticken. */
+   volatile uint8_t locks;          /* Nästlingsdjup för spärr mot stegning. */
+};
+
+/********************************************************************************
+* led_blink_init: Initierar angiven blinkmotor till inaktiv vid start.
+*
+*                 - self: Pekare till blinkmotorn som ska initieras.
+********************************************************************************/
+void led_blink_init(struct led_blink* self);
+
+/********************************************************************************
+* led_blink_start: Startar blinkning enligt angivet blinkmönster, varvid
+*                  stegrutinen anropas en gång direkt och sedan en gång per
+*                  angiven blinkhastighet från systemticken. Blinkmotorn
+*                  får inte redan vara startad, utan ska först stoppas via
+*                  led_blink_stop. Ifall systemticken saknar ledig plats
+*                  returneras felkod 1, annars returneras 0.
+*
+*                  - self          : Pekare till blinkmotorn.
+*                  - mode          : Blinkmönster som ska användas.
+*                  - blink_speed_ms: Blinkhastighet mätt i millisekunder.
+*                  - step          : Behållarens stegrutin.
+*                  - container     : Behållaren som skickas till stegrutinen.
+********************************************************************************/
+int led_blink_start(struct led_blink* self,
+                    const enum led_list_blink_mode mode,
+                    const uint16_t blink_speed_ms,
+                    void (*step)(void* container),
+                    void* container);
+
+/********************************************************************************
+* led_blink_stop: Stoppar eventuell pågående blinkning. Om ingen behållare
+*                 längre blinkar kopplas blinkmotorn bort från systemticken.
+*                 Lysdiodernas tillstånd påverkas inte.
+*
+*                 - self: Pekare till blinkmotorn som ska stoppas.
+********************************************************************************/
+void led_blink_stop(struct led_blink* self);
+
+/********************************************************************************
+* led_blink_lock: Spärrar stegning av angiven blinkmotor från systemticken
+*                 medan behållaren ändras. Spärrar kan nästlas och ska
+*                 hävas via led_blink_unlock. Anropas endast utanför
+*                 avbrottskontext.
+*
+*                 - self: Pekare till blinkmotorn som ska spärras.
+********************************************************************************/
+void led_blink_lock(struct led_blink* self);
+
+/********************************************************************************
+* led_blink_unlock: Häver en spärr påbörjad via led_blink_lock. När den
+*                   yttersta spärren hävs genomförs eventuellt uppskjutet
+*                   steg vid nästa tick.
+*
+*                   - self: Pekare till blinkmotorn vars spärr ska hävas.
+********************************************************************************/
+void led_blink_unlock(struct led_blink* self);
+
+#endif /* LED_BLINK_H_ */
@@ -0,0 +1,581 @@
+/********************************************************************************
+* led_clist.c: Innehåller funktionsdefinitioner för kompakta dubbellänkade
+*              listor med 8-bitars nodindex.
+********************************************************************************/
+#include "led_clist.h"
+
+/* Statiska funktioner: */
+static uint8_t led_clist_node_new(const uint8_t handle);
+static void led_clist_node_delete(const uint8_t node);
+static void led_clist_link_before(struct led_clist* self,
+                                  const uint8_t node,
+                                  const uint8_t position);
+static void led_clist_unlink(struct led_clist* self,
+                             const uint8_t node);
+static uint8_t led_clist_handle_init(const uint8_t pin);
+static void led_clist_handle_write(const uint8_t handle,
+                                   const bool enabled);
+static void led_clist_update_masks(struct led_clist* self);
+
+/* Statiska variabler: */
+static struct led_clist_node led_clist_pool[LED_CLIST_POOL_SIZE]; /* Nodpool. */
+static uint8_t led_clist_free_list = LED_CLIST_NULL; /* Frigjorda noder. */
+static uint8_t led_clist_pool_next = 0;              /* Första aldrig använda nod. */
+static uint8_t led_clist_pool_used = 0;              /* Antalet använda noder. */
+
+/********************************************************************************
+* led_clist_init: Initierar angiven lista till tom vid start.
+*
+*                 - self: Pekare till listan som ska initieras.
+********************************************************************************/
+void led_clist_init(struct led_clist* self)
+{
+   self->first = LED_CLIST_NULL;
+   self->last = LED_CLIST_NULL;
+   self->size = 0;
+   self->port_masks_valid = false;
+   return;
+}
+
+/********************************************************************************
+* led_clist_clear: Tömmer angiven lista och återlämnar dess noder till
+*                  nodpoolen.
+*
+*                  - self: Pekare till listan som ska tömmas.
+********************************************************************************/
+void led_clist_clear(struct led_clist* self)
+{
+   uint8_t i = self->first;
+
+   while (i != LED_CLIST_NULL)
+   {
+      const uint8_t next = led_clist_pool[i].next;
+      led_clist_node_delete(i);
+      i = next;
+   }
+
+   led_clist_init(self);
+   return;
+}
+
+/********************************************************************************
+* led_clist_begin: Returnerar index till den första noden i angiven lista.
+*                  Ifall listan är tom returneras LED_CLIST_NULL.
+*
+*                  - self: Pekare till listan.
+********************************************************************************/
+uint8_t led_clist_begin(const struct led_clist* self)
+{
+   return self->first;
+}
+
+/********************************************************************************
+* led_clist_last: Returnerar index till den sista noden i angiven lista.
+*                 Ifall listan är tom returneras LED_CLIST_NULL.
+*
+*                 - self: Pekare till listan.
+********************************************************************************/
+uint8_t led_clist_last(const struct led_clist* self)
+{
+   return self->last;
+}
+
+/********************************************************************************
+* led_clist_next: Returnerar index till noden efter angiven nod, alternativt
+*                 LED_CLIST_NULL vid listans slut.
+*
+*                 - node: Index till noden.
+********************************************************************************/
+uint8_t led_clist_next(const uint8_t node)
+{
+   return led_clist_pool[node].next;
+}
+
+/********************************************************************************
+* led_clist_previous: Returnerar index till noden före angiven nod,
+*                     alternativt LED_CLIST_NULL vid listans början.
+*
+*                     - node: Index till noden.
+********************************************************************************/
+uint8_t led_clist_previous(const uint8_t node)
+{
+   return led_clist_pool[node].previous;
+}
+
+/********************************************************************************
+* led_clist_handle: Returnerar handtaget till lysdioden lagrad i angiven nod.
+*
+*                   - node: Index till noden.
+********************************************************************************/
+uint8_t led_clist_handle(const uint8_t node)
+{
+   return led_clist_pool[node].handle;
+}
+
+/********************************************************************************
+* led_clist_at: Returnerar index till noden på angivet index i listan. Ifall
+*               ett index utanför listans omfång passeras så returneras
+*               LED_CLIST_NULL. Sökningen startar från närmaste ände.
+*
+*               - self : Pekare till listan.
+*               - index: Index till noden som ska returneras.
+********************************************************************************/
+uint8_t led_clist_at(const struct led_clist* self,
+                     const uint8_t index)
+{
+   if (index >= self->size) return LED_CLIST_NULL;
+
+   if (index < self->size / 2)
+   {
+      uint8_t n = self->first;
+
+      for (uint8_t i = 0; i < index; ++i)
+      {
+         n = led_clist_pool[n].next;
+      }
+
+      return n;
+   }
+   else
+   {
+      uint8_t n = self->last;
+
+      for (uint8_t i = self->size - 1; i > index; --i)
+      {
+         n = led_clist_pool[n].previous;
+      }
+
+      return n;
+   }
+}
+
+/********************************************************************************
+* led_clist_set: Lagrar lysdioden på angiven pin på angivet index. Ifall ett
+*                index utanför listans omfång passeras returneras felkod 1,
+*                annars returneras 0.
+*
+*                - self : Pekare till listan.
+*                - index: Index där lysdioden ska lagras.
+*                - pin  : Lysdiodens pin-nummer på Arduino Uno, exempelvis 8.
+********************************************************************************/
+int led_clist_set(struct led_clist* self,
+                  const uint8_t index,
+                  const uint8_t pin)
+{
+   const uint8_t n = led_clist_at(self, index);
+   if (n == LED_CLIST_NULL) return 1;
+
+   led_clist_pool[n].handle = led_clist_handle_init(pin);
+   self->port_masks_valid = false;
+   return 0;
+}
+
+/********************************************************************************
+* led_clist_resize: Ändrar storleken på angiven lista. Nya noder lagrar ett
+*                   tomt handtag och kan tilldelas via led_clist_set. Ifall
+*                   nodpoolen saknar plats lämnas listan orörd och felkod 1
+*                   returneras, annars returneras 0.
+*
+*                   - self    : Pekare till listan vars storlek ska ändras.
+*                   - new_size: Listans nya storlek.
+********************************************************************************/
+int led_clist_resize(struct led_clist* self,
+                     const uint8_t new_size)
+{
+   if (new_size > self->size && new_size - self->size > led_clist_pool_num_free()) return 1;
+
+   while (self->size > new_size)
+   {
+      led_clist_pop_back(self);
+   }
+   while (self->size < new_size)
+   {
+      led_clist_link_before(self, led_clist_node_new(LED_CLIST_HANDLE_NONE), LED_CLIST_NULL);
+   }
+
+   return 0;
+}
+
+/********************************************************************************
+* led_clist_push_front: Lägger till lysdioden på angiven pin längst fram i
+*                       angiven lista och sätter pinnen till utport. Ifall
+*                       nodpoolen är full returneras felkod 1, annars 0.
+*
+*                       - self: Pekare till listan.
+*                       - pin : Lysdiodens pin-nummer på Arduino Uno.
+********************************************************************************/
+int led_clist_push_front(struct led_clist* self,
+                         const uint8_t pin)
+{
+   const uint8_t n = led_clist_node_new(led_clist_handle_init(pin));
+   if (n == LED_CLIST_NULL) return 1;
+   led_clist_link_before(self, n, self->first);
+   return 0;
+}
+
+/********************************************************************************
+* led_clist_push_back: Lägger till lysdioden på angiven pin längst bak i
+*                      angiven lista och sätter pinnen till utport. Ifall
+*                      nodpoolen är full returneras felkod 1, annars 0.
+*
+*                      - self: Pekare till listan.
+*                      - pin : Lysdiodens pin-nummer på Arduino Uno.
+********************************************************************************/
+int led_clist_push_back(struct led_clist* self,
+                        const uint8_t pin)
+{
+   const uint8_t n = led_clist_node_new(led_clist_handle_init(pin));
+   if (n == LED_CLIST_NULL) return 1;
+   led_clist_link_before(self, n, LED_CLIST_NULL);
+   return 0;
+}
+
+/********************************************************************************
+* led_clist_pop_front: Tar bort eventuell första lysdiod i angiven lista.
+*
+*                      - self: Pekare till listan.
+********************************************************************************/
+void led_clist_pop_front(struct led_clist* self)
+{
+   const uint8_t n = self->first;
+   if (n == LED_CLIST_NULL) return;
+   led_clist_unlink(self, n);
+   led_clist_node_delete(n);
+   return;
+}
+
+/********************************************************************************
+* led_clist_pop_back: Tar bort eventuell sista lysdiod i angiven lista.
+*
+*                     - self: Pekare till listan.
+********************************************************************************/
+void led_clist_pop_back(struct led_clist* self)
+{
+   const uint8_t n = self->last;
+   if (n == LED_CLIST_NULL) return;
+   led_clist_unlink(self, n);
+   led_clist_node_delete(n);
+   return;
+}
+
+/********************************************************************************
+* led_clist_insert_at: Lägger in lysdioden på angiven pin på angivet index
+*                      och flyttar bak efterföljande lysdioder ett steg.
+*                      Ifall index ligger utanför listans omfång eller om
+*                      nodpoolen är full returneras felkod 1, annars 0.
+*
+*                      - self : Pekare till listan.
+*                      - index: Index där lysdioden ska lagras.
+*                      - pin  : Lysdiodens pin-nummer på Arduino Uno.
+********************************************************************************/
+int led_clist_insert_at(struct led_clist* self,
+                        const uint8_t index,
+                        const uint8_t pin)
+{
+   const uint8_t position = led_clist_at(self, index);
+   if (position == LED_CLIST_NULL) return 1;
+
+   const uint8_t n = led_clist_node_new(led_clist_handle_init(pin));
+   if (n == LED_CLIST_NULL) return 1;
+   led_clist_link_before(self, n, position);
+   return 0;
+}
+
+/********************************************************************************
+* led_clist_remove_at: Tar bort lysdioden på angivet index och flyttar fram
+*                      efterföljande lysdioder ett steg. Ifall index ligger
+*                      utanför listans omfång returneras felkod 1, annars 0.
+*
+*                      - self : Pekare till listan.
+*                      - index: Index till lysdioden som ska tas bort.
+********************************************************************************/
+int led_clist_remove_at(struct led_clist* self,
+                        const uint8_t index)
+{
+   const uint8_t n = led_clist_at(self, index);
+   if (n == LED_CLIST_NULL) return 1;
+   led_clist_unlink(self, n);
+   led_clist_node_delete(n);
+   return 0;
+}
+
+/********************************************************************************
+* led_clist_on: Tänder samtliga lysdioder i angiven lista via en skrivning
+*               per I/O-port.
+*
+*               - self: Pekare till listan.
+********************************************************************************/
+void led_clist_on(struct led_clist* self)
+{
+   led_clist_update_masks(self);
+
+   port_shadow_write_masks(self->port_masks, PORT_SHADOW_SET);
+   return;
+}
+
+/********************************************************************************
+* led_clist_off: Släcker samtliga lysdioder i angiven lista via en skrivning
+*                per I/O-port.
+*
+*                - self: Pekare till listan.
+********************************************************************************/
+void led_clist_off(struct led_clist* self)
+{
+   led_clist_update_masks(self);
+
+   port_shadow_write_masks(self->port_masks, PORT_SHADOW_CLEAR);
+   return;
+}
+
+/********************************************************************************
+* led_clist_toggle: Togglar samtliga lysdioder i angiven lista via en
+*                   skrivning per I/O-port till registret PINx.
+*
+*                   - self: Pekare till listan.
+********************************************************************************/
+void led_clist_toggle(struct led_clist* self)
+{
+   led_clist_update_masks(self);
+
+   port_shadow_write_masks(self->port_masks, PORT_SHADOW_TOGGLE);
+   return;
+}
+
+/********************************************************************************
+* led_clist_blink_collectively: Genomför kollektiv (synkroniserad) blinkning
+*                               av samtliga lysdioder i angiven lista.
+*
+*                               - self          : Pekare till listan.
+*                               - blink_speed_ms: Blinkhastighet mätt i
+*                                                 millisekunder.
+********************************************************************************/
+void led_clist_blink_collectively(struct led_clist* self,
+                                  const uint16_t blink_speed_ms)
+{
+   led_clist_on(self);
+   delay_ms(blink_speed_ms);
+   led_clist_off(self);
+   delay_ms(blink_speed_ms);
+   return;
+}
+
+/********************************************************************************
+* led_clist_blink_forward: Genomför sekventiell blinkning framåt av samtliga
+*                          lysdioder i angiven lista.
+*
+*                          - self          : Pekare till listan.
+*                          - blink_speed_ms: Blinkhastighet mätt i
+*                                            millisekunder.
+********************************************************************************/
+void led_clist_blink_forward(struct led_clist* self,
+                             const uint16_t blink_speed_ms)
+{
+   led_clist_off(self);
+
+   for (uint8_t i = self->first; i != LED_CLIST_NULL; i = led_clist_pool[i].next)
+   {
+      led_clist_handle_write(led_clist_pool[i].handle, true);
+      delay_ms(blink_speed_ms);
+      led_clist_handle_write(led_clist_pool[i].handle, false);
+   }
+
+   return;
+}
+
+/********************************************************************************
+* led_clist_blink_backward: Genomför sekventiell blinkning bakåt av samtliga
+*                           lysdioder i angiven lista.
+*
+*                           - self          : Pekare till listan.
+*                           - blink_speed_ms: Blinkhastighet mätt i
+*                                             millisekunder.
+********************************************************************************/
+void led_clist_blink_backward(struct led_clist* self,
+                              const uint16_t blink_speed_ms)
+{
+   led_clist_off(self);
+
+   for (uint8_t i = self->last; i != LED_CLIST_NULL; i = led_clist_pool[i].previous)
+   {
+      led_clist_handle_write(led_clist_pool[i].handle, true);
+      delay_ms(blink_speed_ms);
+      led_clist_handle_write(led_clist_pool[i].handle, false);
+   }
+
+   return;
+}
+
+/********************************************************************************
+* led_clist_pool_num_free: Returnerar antalet lediga noder i nodpoolen.
+********************************************************************************/
+uint8_t led_clist_pool_num_free(void)
+{
+   return LED_CLIST_POOL_SIZE - led_clist_pool_used;
+}
+
+/********************************************************************************
+* led_clist_node_new: Allokerar en ny nod ur nodpoolen i konstant tid, i
+*                     första hand från den fria listan. Returnerar nodens
+*                     index, alternativt LED_CLIST_NULL om poolen är full.
+*
+*                     - handle: Handtag till lysdioden som ska lagras.
+********************************************************************************/
+static uint8_t led_clist_node_new(const uint8_t handle)
+{
+   uint8_t n = led_clist_free_list;
+
+   if (n != LED_CLIST_NULL)
+   {
+      led_clist_free_list = led_clist_pool[n].next;
+   }
+   else if (led_clist_pool_next < LED_CLIST_POOL_SIZE)
+   {
+      n = led_clist_pool_next++;
+   }
+   else
+   {
+      return LED_CLIST_NULL;
+   }
+
+   led_clist_pool_used++;
+   led_clist_pool[n].previous = LED_CLIST_NULL;
+   led_clist_pool[n].next = LED_CLIST_NULL;
+   led_clist_pool[n].handle = handle;
+   return n;
+}
+
+/********************************************************************************
+* led_clist_node_delete: Återlämnar angiven nod till nodpoolen genom att lägga
+*                        den först i den fria listan.
+*
+*                        - node: Index till noden som ska återlämnas.
+********************************************************************************/
+static void led_clist_node_delete(const uint8_t node)
+{
+   led_clist_pool[node].previous = LED_CLIST_NULL;
+   led_clist_pool[node].handle = LED_CLIST_HANDLE_NONE;
+   led_clist_pool[node].next = led_clist_free_list;
+   led_clist_free_list = node;
+   led_clist_pool_used--;
+   return;
+}
+
+/********************************************************************************
+* led_clist_link_before: Länkar in angiven nod före angiven position i listan.
+*
+*                        - self    : Pekare till listan.
+*                        - node    : Index till noden som ska länkas in.
+*                        - position: Index till noden som den nya noden ska
+*                                    placeras före, alternativt LED_CLIST_NULL
+*                                    för att placera den längst bak.
+********************************************************************************/
+static void led_clist_link_before(struct led_clist* self,
+                                  const uint8_t node,
+                                  const uint8_t position)
+{
+   const uint8_t previous = position != LED_CLIST_NULL ? led_clist_pool[position].previous : self->last;
+   led_clist_pool[node].previous = previous;
+   led_clist_pool[node].next = position;
+
+   if (previous != LED_CLIST_NULL) led_clist_pool[previous].next = node;
+   else self->first = node;
+
+   if (position != LED_CLIST_NULL) led_clist_pool[position].previous = node;
+   else self->last = node;
+
+   self->size++;
+   self->port_masks_valid = false;
+   return;
+}
+
+/********************************************************************************
+* led_clist_unlink: Länkar ur angiven nod ur listan utan att återlämna den.
+*
+*                   - self: Pekare till listan.
+*                   - node: Index till noden som ska länkas ur.
+********************************************************************************/
+static void led_clist_unlink(struct led_clist* self,
+                             const uint8_t node)
+{
+   const uint8_t previous = led_clist_pool[node].previous;
+   const uint8_t next = led_clist_pool[node].next;
+
+   if (previous != LED_CLIST_NULL) led_clist_pool[previous].next = next;
+   else self->first = next;
+
+   if (next != LED_CLIST_NULL) led_clist_pool[next].previous = previous;
+   else self->last = previous;
+
+   led_clist_pool[node].previous = LED_CLIST_NULL;
+   led_clist_pool[node].next = LED_CLIST_NULL;
+   self->size--;
+   self->port_masks_valid = false;
+   return;
+}
+
+/********************************************************************************
+* led_clist_handle_init: Packar angiven pin till ett handtag och sätter
+*                        motsvarande pin till utport. Ogiltiga pinnar ger ett
+*                        tomt handtag.
+*
+*                        - pin: Lysdiodens pin-nummer på Arduino Uno.
+********************************************************************************/
+static uint8_t led_clist_handle_init(const uint8_t pin)
+{
+   const uint8_t handle = LED_CLIST_HANDLE(pin);
+   const uint8_t mask = 1 << LED_CLIST_HANDLE_PIN(handle);
+
+   switch (LED_CLIST_HANDLE_PORT(handle))
+   {
+      case IO_PORTB: REG_SET(DDRB, mask); break;
+      case IO_PORTC: REG_SET(DDRC, mask); break;
+      case IO_PORTD: REG_SET(DDRD, mask); break;
+      default: break;
+   }
+
+   return handle;
+}
+
+/********************************************************************************
+* led_clist_handle_write: Tänder eller släcker lysdioden med angivet handtag.
+*
+*                         - handle : Handtag till lysdioden.
+*                         - enabled: Indikerar ifall lysdioden ska tändas.
+********************************************************************************/
+static void led_clist_handle_write(const uint8_t handle,
+                                   const bool enabled)
+{
+   const uint8_t mask = 1 << LED_CLIST_HANDLE_PIN(handle);
+
+   port_shadow_write(LED_CLIST_HANDLE_PORT(handle), mask, enabled ? PORT_SHADOW_SET : PORT_SHADOW_CLEAR);
+   return;
+}
+
+/********************************************************************************
+* led_clist_update_masks: Bygger om listans bitmasker för I/O-port B, C och D
+*                         ifall listan har modifierats sedan senaste
+*                         gruppoperationen. Tomma handtag ignoreras.
+*
+*                         - self: Pekare till listan.
+********************************************************************************/
+static void led_clist_update_masks(struct led_clist* self)
+{
+   if (self->port_masks_valid) return;
+
+   self->port_masks[IO_PORTB] = 0;
+   self->port_masks[IO_PORTC] = 0;
+   self->port_masks[IO_PORTD] = 0;
+
+   for (uint8_t i = self->first; i != LED_CLIST_NULL; i = led_clist_pool[i].next)
+   {
+      const uint8_t handle = led_clist_pool[i].handle;
+
+      if (LED_CLIST_HANDLE_PORT(handle) != IO_PORT_NONE)
+      {
+         self->port_masks[LED_CLIST_HANDLE_PORT(handle)] |= 1 << LED_CLIST_HANDLE_PIN(handle);
+      }
+   }
+
+   self->port_masks_valid = true;
+   return;
+}
@@ -0,0 +1,281 @@
+/********************************************************************************
+* led_clist.h: Innehåller funktionalitet för kompakta dubbellänkade listor för
+*              lagring och styrning av multipla lysdioder, realiserat via
+*              strukten led_clist samt associerade funktioner.
+*
+*              I stället för pekare lagras noderna i en statisk nodpool, där
+*              föregående samt nästa nod anges med ett 8-bitars index och
+*              lysdioden anges med ett 1-byte handtag, där bit 0 - 2 utgör
+*              pinnen och bit 3 - 4 utgör I/O-porten. Varje nod upptar
+*              därmed 3 byte, jämfört med 6 byte för en led_node samt
+*              4 byte för den refererade strukten led. Lysdiodernas
+*              tillstånd lagras inte, utan läses vid behov från PORTx.
+*
+*              Listan erbjuder samma operationer som led_list, men positioner
+*              anges som nodindex i stället för nodpekare. Slutet på listan
+*              markeras med LED_CLIST_NULL.
+********************************************************************************/
+#ifndef LED_CLIST_H_
+#define LED_CLIST_H_
+
+/* Inkluderingsdirektiv: */
+#include "misc.h"
+#include "port_shadow.h"
+
+/* Antalet noder i den statiska nodpoolen (högst 255, kan ändras vid kompilering): */
+#ifndef LED_CLIST_POOL_SIZE
+#define LED_CLIST_POOL_SIZE 128
+#endif
+
+#if LED_CLIST_POOL_SIZE > 255
+#error "LED_CLIST_POOL_SIZE får vara högst 255, då index 255 markerar avsaknad av nod."
+#endif
+
+/* Nodindex som markerar avsaknad av nod: */
+#define LED_CLIST_NULL 0xFF
+
+/* Makron för packning samt uppackning av handtag för lysdioder: */
+#define LED_CLIST_HANDLE(pin)         ((uint8_t)((PIN_IO_PORT(pin) << 3) | (PIN_IO_PORT(pin) == IO_PORT_NONE ? 0 : PIN_BIT(pin))))
+#define LED_CLIST_HANDLE_NONE         ((uint8_t)(IO_PORT_NONE << 3))
+#define LED_CLIST_HANDLE_PORT(handle) ((enum io_port)(((handle) >> 3) & 0x03))
+#define LED_CLIST_HANDLE_PIN(handle)  ((handle) & 0x07)
+
+/********************************************************************************
+* led_clist_node: Nod i den statiska nodpoolen, med index till föregående samt
+*                 nästa nod samt handtag till lagrad lysdiod.
+********************************************************************************/
+struct led_clist_node
+{
+   uint8_t previous; /* Index till föregående nod (eller LED_CLIST_NULL). */
+   uint8_t next;     /* Index till nästa nod (eller LED_CLIST_NULL). */
+   uint8_t handle;   /* Handtag till lagrad lysdiod (port samt pin). */
+};
+
+/********************************************************************************
+* led_clist: Kompakt dubbellänkad lista för lagring och styrning av lysdioder
+*            via handtag. För gruppoperationer cachas en bitmask per I/O-port
+*            på samma sätt som för led_list.
+********************************************************************************/
+struct led_clist
+{
+   uint8_t first;                    /* Index till första noden i listan. */
+   uint8_t last;                     /* Index till sista noden i listan. */
+   uint8_t size;                     /* Antalet lagrade lysdioder. */
+   uint8_t port_masks[IO_PORT_NONE]; /* Bitmask för lysdioderna på I/O-port B, C och D. */
+   bool port_masks_valid;            /* Indikerar ifall bitmaskerna är aktuella. */
+};
+
+/********************************************************************************
+* led_clist_init: Initierar angiven lista till tom vid start.
+*
+*                 - self: Pekare till listan som ska initieras.
+********************************************************************************/
+void led_clist_init(struct led_clist* self);
+
+/********************************************************************************
+* led_clist_clear: Tömmer angiven lista och återlämnar dess noder till
+*                  nodpoolen.
+*
+*                  - self: Pekare till listan som ska tömmas.
+********************************************************************************/
+void led_clist_clear(struct led_clist* self);
+
+/********************************************************************************
+* led_clist_begin: Returnerar index till den första noden i angiven lista.
+*                  Ifall listan är tom returneras LED_CLIST_NULL.
+*
+*                  - self: Pekare till listan.
+********************************************************************************/
+uint8_t led_clist_begin(const struct led_clist* self);
+
+/********************************************************************************
+* led_clist_last: Returnerar index till den sista noden i angiven lista.
+*                 Ifall listan är tom returneras LED_CLIST_NULL.
+*
+*                 - self: Pekare till listan.
+********************************************************************************/
+uint8_t led_clist_last(const struct led_clist* self);
+
+/********************************************************************************
+* led_clist_next: Returnerar index till noden efter angiven nod, alternativt
+*                 LED_CLIST_NULL vid listans slut.
+*
+*                 - node: Index till noden.
+********************************************************************************/
+uint8_t led_clist_next(const uint8_t node);
+
+/********************************************************************************
+* led_clist_previous: Returnerar index till noden före angiven nod,
+*                     alternativt LED_CLIST_NULL vid listans början.
+*
+*                     - node: Index till noden.
+********************************************************************************/
+uint8_t led_clist_previous(const uint8_t node);
+
+/********************************************************************************
+* led_clist_handle: Returnerar handtaget till lysdioden lagrad i angiven nod.
+*
+*                   - node: Index till noden.
+********************************************************************************/
+uint8_t led_clist_handle(const uint8_t node);
+
+/********************************************************************************
+* led_clist_at: Returnerar index till noden på angivet index i listan. Ifall
+*               ett index utanför listans omfång passeras så returneras
+*               LED_CLIST_NULL. Sökningen startar från närmaste ände.
+*
+*               - self : Pekare till listan.
+*               - index: Index till noden som ska returneras.
+********************************************************************************/
+uint8_t led_clist_at(const struct led_clist* self,
+                     const uint8_t index);
+
+/********************************************************************************
+* led_clist_set: Lagrar lysdioden på angiven pin på angivet index. Ifall ett
+*                index utanför listans omfång passeras returneras felkod 1,
+*                annars returneras 0.
+*
+*                - self : Pekare till listan.
+*                - index: Index där lysdioden ska lagras.
+*                - pin  : Lysdiodens pin-nummer på Arduino Uno, exempelvis 8.
+********************************************************************************/
+int led_clist_set(struct led_clist* self,
+                  const uint8_t index,
+                  const uint8_t pin);
+
+/********************************************************************************
+* led_clist_resize: Ändrar storleken på angiven lista. Nya noder lagrar ett
+*                   tomt handtag och kan tilldelas via led_clist_set. Ifall
+*                   nodpoolen saknar plats lämnas listan orörd och felkod 1
+*                   returneras, annars returneras 0.
+*
+*                   - self    : Pekare till listan vars storlek ska ändras.
+*                   - new_size: Listans nya storlek.
+********************************************************************************/
+int led_clist_resize(struct led_clist* self,
+                     const uint8_t new_size);
+
+/********************************************************************************
+* led_clist_push_front: Lägger till lysdioden på angiven pin längst fram i
+*                       angiven lista och sätter pinnen till utport. Ifall
+*                       nodpoolen är full returneras felkod 1, annars 0.
+*
+*                       - self: Pekare till listan.
+*                       - pin : Lysdiodens pin-nummer på Arduino Uno.
+********************************************************************************/
+int led_clist_push_front(struct led_clist* self,
+                         const uint8_t pin);
+
+/********************************************************************************
+* led_clist_push_back: Lägger till lysdioden på angiven pin längst bak i
+*                      angiven lista och sätter pinnen till utport. Ifall
+*                      nodpoolen är full returneras felkod 1, annars 0.
+*
+*                      - self: Pekare till listan.
+*                      - pin : Lysdiodens pin-nummer på Arduino Uno.
+********************************************************************************/
+int led_clist_push_back(struct led_clist* self,
+                        const uint8_t pin);
+
+/********************************************************************************
+* led_clist_pop_front: Tar bort eventuell första lysdiod i angiven lista.
+*
+*                      - self: Pekare till listan.
+********************************************************************************/
+void led_clist_pop_front(struct led_clist* self);
+
+/********************************************************************************
+* led_clist_pop_back: Tar bort eventuell sista lysdiod i angiven lista.
+*
+*                     - self: Pekare till listan.
+********************************************************************************/
+void led_clist_pop_back(struct led_clist* self);
+
+/********************************************************************************
+* led_clist_insert_at: Lägger in lysdioden på angiven pin på angivet index
+*                      och flyttar bak efterföljande lysdioder ett steg.
+*                      Ifall index ligger utanför listans omfång eller om
+*                      nodpoolen är full returneras felkod 1, annars 0.
+*
+*                      - self : Pekare till listan.
+*                      - index: Index där lysdioden ska lagras.
+*                      - pin  : Lysdiodens pin-nummer på Arduino Uno.
+********************************************************************************/
+int led_clist_insert_at(struct led_clist* self,
+                        const uint8_t index,
+                        const uint8_t pin);
+
+/********************************************************************************
+* led_clist_remove_at: Tar bort lysdioden på angivet index och flyttar fram
+*                      efterföljande lysdioder ett steg. Ifall index ligger
+*                      utanför listans omfång returneras felkod 1, annars 0.
+*
+*                      - self : Pekare till listan.
+*                      - index: Index till lysdioden som ska tas bort.
+********************************************************************************/
+int led_clist_remove_at(struct led_clist* self,
+                        const uint8_t index);
+
+/********************************************************************************
+* led_clist_on: Tänder samtliga lysdioder i angiven lista via en skrivning
+*               per I/O-port.
+*
+*               - self: Pekare till listan.
+********************************************************************************/
+void led_clist_on(struct led_clist* self);
+
+/********************************************************************************
+* led_clist_off: Släcker samtliga lysdioder i angiven lista via en skrivning
+*                per I/O-port.
+*
+*                - self: Pekare till listan.
+********************************************************************************/
+void led_clist_off(struct led_clist* self);
+
+/********************************************************************************
+* led_clist_toggle: Togglar samtliga lysdioder i angiven lista via en
+*                   skrivning per I/O-port till registret PINx.
+*
+*                   - self: Pekare till listan.
+********************************************************************************/
+void led_clist_toggle(struct led_clist* self);
+
+/********************************************************************************
+* led_clist_blink_collectively: Genomför kollektiv (synkroniserad) blinkning
+*                               av samtliga lysdioder i angiven lista.
+*
+*                               - self          : Pekare till listan.
+*                               - blink_speed_ms: Blinkhastighet mätt i
+*                                                 millisekunder.
+********************************************************************************/
+void led_clist_blink_collectively(struct led_clist* self,
+                                  const uint16_t blink_speed_ms);
+
+/********************************************************************************
+* led_clist_blink_forward: Genomför sekventiell blinkning framåt av samtliga
+*                          lysdioder i angiven lista.
+*
+*                          - self          : Pekare till listan.
+*                          - blink_speed_ms: Blinkhastighet mätt i
+*                                            millisekunder.
+********************************************************************************/
+void led_clist_blink_forward(struct led_clist* self,
+                             const uint16_t blink_speed_ms);
+
+/********************************************************************************
+* led_clist_blink_backward: Genomför sekventiell blinkning bakåt av samtliga
+*                           lysdioder i angiven lista.
+*
+*                           - self          : Pekare till listan.
+*                           - blink_speed_ms: Blinkhastighet mätt i
+*                                             millisekunder.
+********************************************************************************/
+void led_clist_blink_backward(struct led_clist* self,
+                              const uint16_t blink_speed_ms);
+
+/********************************************************************************
+* led_clist_pool_num_free: Returnerar antalet lediga noder i nodpoolen.
+********************************************************************************/
+uint8_t led_clist_pool_num_free(void);
+
+#endif /* LED_CLIST_H_ */
@@ -0,0 +1,447 @@
+/********************************************************************************
+* led_ilist.c: Innehåller funktionsdefinitioner för implementering av
+*              intrusiva dubbellänkade listor för lagring och styrning av
+*              lysdioder via strukten led_ilist.
+*
+*              Filen kompileras endast då LED_ILIST_ENABLE är satt till 1.
+********************************************************************************/
+#include "led.h"
+
+#if LED_ILIST_ENABLE
+#include "led_ilist.h"
+
+/* Statiska funktioner: */
+static void led_ilist_link_before(struct led_ilist* self,
+                                  struct led* next,
+                                  struct led* led);
+static void led_ilist_unlink(struct led_ilist* self,
+                             struct led* led);
+static void led_ilist_update_masks(struct led_ilist* self);
+
+/********************************************************************************
+* led_ilist_init: Initierar angiven lista till tom vid start.
+*
+*                 - self: Pekare till listan som ska initieras.
+********************************************************************************/
+void led_ilist_init(struct led_ilist* self)
+{
+   self->first = 0;
+   self->last = 0;
+   self->size = 0;
+   self->port_masks_valid = false;
+   return;
+}
+
+/********************************************************************************
+* led_ilist_clear: Tömmer angiven lista. Samtliga lysdioder länkas ur, men
+*                  lämnas i övrigt orörda.
+*
+*                  - self: Pekare till listan som ska tömmas.
+********************************************************************************/
+void led_ilist_clear(struct led_ilist* self)
+{
+   for (struct led* i = self->first; i;)
+   {
+      struct led* next = i->hook.next;
+      i->hook.previous = 0;
+      i->hook.next = 0;
+      i->hook.list = 0;
+      i = next;
+   }
+
+   led_ilist_init(self);
+   return;
+}
+
+/********************************************************************************
+* led_ilist_begin: Returnerar en pekare till den första lysdioden i angiven
+*                  lista. Ifall listan är tom returneras null.
+*
+*                  - self: Pekare till listan.
+********************************************************************************/
+struct led* led_ilist_begin(const struct led_ilist* self)
+{
+   return self->first;
+}
+
+/********************************************************************************
+* led_ilist_last: Returnerar en pekare till den sista lysdioden i angiven
+*                 lista. Ifall listan är tom returneras null.
+*
+*                 - self: Pekare till listan.
+********************************************************************************/
+struct led* led_ilist_last(const struct led_ilist* self)
+{
+   return self->last;
+}
+
+/********************************************************************************
+* led_ilist_at: Returnerar en pekare till lysdioden på angivet index.
+*               Sökningen sker från närmaste ände av listan. Ifall ett index
+*               utanför listans omfång passeras så returneras null.
+*
+*               - self : Pekare till listan.
+*               - index: Index till lysdioden som ska returneras.
+********************************************************************************/
+struct led* led_ilist_at(const struct led_ilist* self,
+                         const size_t index)
+{
+   if (index >= self->size) return 0;
+
+   if (index < self->size / 2)
+   {
+      struct led* i = self->first;
+      for (size_t j = 0; j < index; ++j) i = i->hook.next;
+      return i;
+   }
+   else
+   {
+      struct led* i = self->last;
+      for (size_t j = self->size - 1; j > index; --j) i = i->hook.previous;
+      return i;
+   }
+}
+
+/********************************************************************************
+* led_ilist_push_front: Länkar in angiven lysdiod längst fram i listan utan
+*                       minnesallokering. Ifall lysdioden redan ligger i en
+*                       intrusiv lista returneras felkod 1, annars 0.
+*
+*                       - self: Pekare till listan som ska tilldelas.
+*                       - led : Pekare till lysdioden som ska länkas in.
+********************************************************************************/
+int led_ilist_push_front(struct led_ilist* self,
+                         struct led* led)
+{
+   if (led->hook.list) return 1;
+   led_ilist_link_before(self, self->first, led);
+   return 0;
+}
+
+/********************************************************************************
+* led_ilist_push_back: Länkar in angiven lysdiod längst bak i listan utan
+*                      minnesallokering. Ifall lysdioden redan ligger i en
+*                      intrusiv lista returneras felkod 1, annars 0.
+*
+*                      - self: Pekare till listan som ska tilldelas.
+*                      - led : Pekare till lysdioden som ska länkas in.
+********************************************************************************/
+int led_ilist_push_back(struct led_ilist* self,
+                        struct led* led)
+{
+   if (led->hook.list) return 1;
+   led_ilist_link_before(self, 0, led);
+   return 0;
+}
+
+/********************************************************************************
+* led_ilist_pop_front: Länkar ur eventuell första lysdiod i angiven lista.
+*
+*                      - self: Pekare till listan.
+********************************************************************************/
+void led_ilist_pop_front(struct led_ilist* self)
+{
+   if (self->first) led_ilist_unlink(self, self->first);
+   return;
+}
+
+/********************************************************************************
+* led_ilist_pop_back: Länkar ur eventuell sista lysdiod i angiven lista.
+*
+*                     - self: Pekare till listan.
+********************************************************************************/
+void led_ilist_pop_back(struct led_ilist* self)
+{
+   if (self->last) led_ilist_unlink(self, self->last);
+   return;
+}
+
+/********************************************************************************
+* led_ilist_insert_at: Länkar in angiven lysdiod på angivet index i listan.
+*                      Ifall index ligger utanför listans omfång eller om
+*                      lysdioden redan ligger i en intrusiv lista returneras
+*                      felkod 1, annars returneras 0.
+*
+*                      - self : Pekare till listan.
+*                      - index: Index där lysdioden ska länkas in.
+*                      - led  : Pekare till lysdioden som ska länkas in.
+********************************************************************************/
+int led_ilist_insert_at(struct led_ilist* self,
+                        const size_t index,
+                        struct led* led)
+{
+   if (index > self->size || led->hook.list) return 1;
+   led_ilist_link_before(self, led_ilist_at(self, index), led);
+   return 0;
+}
+
+/********************************************************************************
+* led_ilist_remove_at: Länkar ur lysdioden på angivet index i listan. Ifall
+*                      index ligger utanför listans omfång returneras
+*                      felkod 1, annars returneras 0.
+*
+*                      - self : Pekare till listan.
+*                      - index: Index till lysdioden som ska länkas ur.
+********************************************************************************/
+int led_ilist_remove_at(struct led_ilist* self,
+                        const size_t index)
+{
+   struct led* led = led_ilist_at(self, index);
+   if (!led) return 1;
+   led_ilist_unlink(self, led);
+   return 0;
+}
+
+/********************************************************************************
+* led_ilist_remove: Länkar ur angiven lysdiod ur listan i konstant tid. Ifall
+*                   lysdioden inte ligger i angiven lista returneras felkod 1,
+*                   annars returneras 0.
+*
+*                   - self: Pekare till listan.
+*                   - led : Pekare till lysdioden som ska länkas ur.
+********************************************************************************/
+int led_ilist_remove(struct led_ilist* self,
+                     struct led* led)
+{
+   if (led->hook.list != self) return 1;
+   led_ilist_unlink(self, led);
+   return 0;
+}
+
+/********************************************************************************
+* led_ilist_on: Tänder samtliga lysdioder lagrade i angiven lista. Lysdioder
+*               på samma I/O-port tänds samtidigt via en skrivning per port.
+*
+*               - self: Pekare till listan vars lysdioder ska tändas.
+********************************************************************************/
+void led_ilist_on(struct led_ilist* self)
+{
+   led_ilist_update_masks(self);
+
+   port_shadow_write_masks(self->port_masks, PORT_SHADOW_SET);
+   if (!self->shift_register_leds && !self->matrix_leds) return;
+
+   if (self->shift_register_leds) shift_register_begin();
+
+   for (struct led* i = self->first; i; i = i->hook.next)
+   {
+      led_set_enabled(i, true);
+   }
+
+   if (self->shift_register_leds) shift_register_end();
+   return;
+}
+
+/********************************************************************************
+* led_ilist_off: Släcker samtliga lysdioder lagrade i angiven lista.
+*                Lysdioder på samma I/O-port släcks samtidigt via en
+*                skrivning per port.
+*
+*                - self: Pekare till listan vars lysdioder ska släckas.
+********************************************************************************/
+void led_ilist_off(struct led_ilist* self)
+{
+   led_ilist_update_masks(self);
+
+   port_shadow_write_masks(self->port_masks, PORT_SHADOW_CLEAR);
+   if (!self->shift_register_leds && !self->matrix_leds) return;
+
+   if (self->shift_register_leds) shift_register_begin();
+
+   for (struct led* i = self->first; i; i = i->hook.next)
+   {
+      led_set_enabled(i, false);
+   }
+
+   if (self->shift_register_leds) shift_register_end();
+   return;
+}
+
+/********************************************************************************
+* led_ilist_toggle: Togglar samtliga lysdioder lagrade i angiven lista.
+*                   Lysdioder på samma I/O-port togglas samtidigt via en
+*                   skrivning per port till registret PINx, vilket är
+*                   atomärt gentemot avbrott.
+*
+*                   - self: Pekare till listan vars lysdioder ska togglas.
+********************************************************************************/
+void led_ilist_toggle(struct led_ilist* self)
+{
+   led_ilist_update_masks(self);
+
+   port_shadow_write_masks(self->port_masks, PORT_SHADOW_TOGGLE);
+   if (!self->shift_register_leds && !self->matrix_leds) return;
+
+   if (self->shift_register_leds) shift_register_begin();
+
+   for (struct led* i = self->first; i; i = i->hook.next)
+   {
+      if (i->io_port < IO_PORT_NONE) i->enabled = led_is_enabled(i);
+      else led_set_enabled(i, !i->enabled);
+   }
+
+   if (self->shift_register_leds) shift_register_end();
+   return;
+}
+
+/********************************************************************************
+* led_ilist_blink_collectively: Genomför kollektiv (synkroniserad) blinkning
+*                               av samtliga lysdioder lagrade i angiven
+*                               lista. Funktionen är blockerande.
+*
+*                               - self          : Pekare till listan vars
+*                                                 lysdioder ska blinkas.
+*                               - blink_speed_ms: Lysdiodernas blinkhastighet
+*                                                 mätt i millisekunder.
+********************************************************************************/
+void led_ilist_blink_collectively(struct led_ilist* self,
+                                  const uint16_t blink_speed_ms)
+{
+   led_ilist_on(self);
+   delay_ms(blink_speed_ms);
+   led_ilist_off(self);
+   delay_ms(blink_speed_ms);
+   return;
+}
+
+/********************************************************************************
+* led_ilist_blink_forward: Genomför sekventiell blinkning framåt av samtliga
+*                          lysdioder lagrade i angiven lista. Funktionen är
+*                          blockerande.
+*
+*                          - self          : Pekare till listan vars
+*                                            lysdioder ska blinkas.
+*                          - blink_speed_ms: Lysdiodernas blinkhastighet
+*                                            mätt i millisekunder.
+********************************************************************************/
+void led_ilist_blink_forward(struct led_ilist* self,
+                             const uint16_t blink_speed_ms)
+{
+   led_ilist_off(self);
+
+   for (struct led* i = self->first; i; i = i->hook.next)
+   {
+      led_on(i);
+      delay_ms(blink_speed_ms);
+      led_off(i);
+   }
+
+   return;
+}
+
+/********************************************************************************
+* led_ilist_blink_backward: Genomför sekventiell blinkning bakåt av samtliga
+*                           lysdioder lagrade i angiven lista. Funktionen är
+*                           blockerande.
+*
+*                           - self          : Pekare till listan vars
+*                                             lysdioder ska blinkas.
+*                           - blink_speed_ms: Lysdiodernas blinkhastighet
+*                                             mätt i millisekunder.
+********************************************************************************/
+void led_ilist_blink_backward(struct led_ilist* self,
+                              const uint16_t blink_speed_ms)
+{
+   led_ilist_off(self);
+
+   for (struct led* i = self->last; i; i = i->hook.previous)
+   {
+      led_on(i);
+      delay_ms(blink_speed_ms);
+      led_off(i);
+   }
+
+   return;
+}
+
+/********************************************************************************
+* led_ilist_link_before: Länkar in angiven lysdiod före angiven lysdiod i
+*                        listan. Ifall next är null länkas lysdioden in sist.
+*
+*                        - self: Pekare till listan.
+*                        - next: Lysdioden som den nya lysdioden ska placeras
+*                                före (eller null).
+*                        - led : Pekare till lysdioden som ska länkas in.
+********************************************************************************/
+static void led_ilist_link_before(struct led_ilist* self,
+                                  struct led* next,
+                                  struct led* led)
+{
+   struct led* previous = next ? next->hook.previous : self->last;
+
+   led->hook.previous = previous;
+   led->hook.next = next;
+   led->hook.list = self;
+
+   if (previous) previous->hook.next = led;
+   else self->first = led;
+
+   if (next) next->hook.previous = led;
+   else self->last = led;
+
+   self->size++;
+   self->port_masks_valid = false;
+   return;
+}
+
+/********************************************************************************
+* led_ilist_unlink: Länkar ur angiven lysdiod ur listan.
+*
+*                   - self: Pekare till listan.
+*                   - led : Pekare till lysdioden som ska länkas ur.
+********************************************************************************/
+static void led_ilist_unlink(struct led_ilist* self,
+                             struct led* led)
+{
+   if (led->hook.previous) led->hook.previous->hook.next = led->hook.next;
+   else self->first = led->hook.next;
+
+   if (led->hook.next) led->hook.next->hook.previous = led->hook.previous;
+   else self->last = led->hook.previous;
+
+   led->hook.previous = 0;
+   led->hook.next = 0;
+   led->hook.list = 0;
+   self->size--;
+   self->port_masks_valid = false;
+   return;
+}
+
+/********************************************************************************
+* led_ilist_update_masks: Bygger om listans bitmasker för I/O-port B, C och D
+*                         ifall listan har modifierats sedan senaste
+*                         gruppoperationen.
+*
+*                         - self: Pekare till listan.
+********************************************************************************/
+static void led_ilist_update_masks(struct led_ilist* self)
+{
+   if (self->port_masks_valid) return;
+
+   self->port_masks[IO_PORTB] = 0;
+   self->port_masks[IO_PORTC] = 0;
+   self->port_masks[IO_PORTD] = 0;
+   self->shift_register_leds = false;
+   self->matrix_leds = false;
+
+   for (const struct led* i = self->first; i; i = i->hook.next)
+   {
+      if (i->io_port < IO_PORT_NONE)
+      {
+         self->port_masks[i->io_port] |= (1 << i->pin);
+      }
+      else if (i->io_port == IO_PORT_SHIFT_REGISTER)
+      {
+         self->shift_register_leds = true;
+      }
+      else if (i->io_port == IO_PORT_MATRIX)
+      {
+         self->matrix_leds = true;
+      }
+   }
+
+   self->port_masks_valid = true;
+   return;
+}
+
+#endif /* LED_ILIST_ENABLE */
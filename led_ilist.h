@@ -0,0 +1,229 @@
+/********************************************************************************
+* led_ilist.h: Innehåller funktionalitet för implementering av intrusiva
+*              dubbellänkade listor för lagring och styrning över multipla
+*              lysdioder, realiserat via strukten led_ilist samt associerade
+*              funktioner.
+*
+*              Till skillnad från led_list lagras länkarna direkt i varje
+*              lysdiod (fältet hook i strukten led), vilket medför att ingen
+*              nod behöver allokeras vid insättning och att iteration sker
+*              direkt över lysdioderna utan extra indirektion:
+*
+*              for (struct led* i = led_ilist_begin(&list); i; i = i->hook.next)
+*
+*              En lysdiod kan ligga i högst en intrusiv lista åt gången och
+*              får inte initieras om via led_init medan den ligger i listan.
+*
+*              Länkfältet i strukten led finns endast då LED_ILIST_ENABLE
+*              är satt till 1 vid kompilering (se led.h).
+********************************************************************************/
+#ifndef LED_ILIST_H_
+#define LED_ILIST_H_
+
+/* Inkluderingsdirektiv: */
+#include "misc.h"
+#include "led.h"
+
+#if !LED_ILIST_ENABLE
+#error "led_ilist kräver att LED_ILIST_ENABLE är satt till 1 vid kompilering (se led.h)."
+#endif
+
+/********************************************************************************
+* led_ilist: Intrusiv dubbellänkad lista för lagring och styrning av lysdioder
+*            eller andra digitala utportar, implementerade via strukten led.
+*            I likhet med led_list cachas en bitmask per I/O-port för
+*            gruppoperationer, som för listor med enbart lysdioder på
+*            I/O-port B, C och D sker utan genomstegning av noderna.
+********************************************************************************/
+struct led_ilist
+{
+   struct led* first;                /* Pekare till första lysdioden i listan. */
+   struct led* last;                 /* Pekare till sista lysdioden i listan. */
+   size_t size;                      /* Listans storlek, dvs. antalet lagrade lysdioder. */
+   uint8_t port_masks[IO_PORT_NONE]; /* Bitmask för lysdioderna på I/O-port B, C och D. */
+   bool port_masks_valid;            /* Indikerar ifall bitmaskerna är aktuella. */
+   bool shift_register_leds;         /* Indikerar ifall listan innehåller skiftregisterutgångar. */
+   bool matrix_leds;                 /* Indikerar ifall listan innehåller matrisceller. */
+};
+
+/********************************************************************************
+* led_ilist_init: Initierar angiven lista till tom vid start.
+*
+*                 - self: Pekare till listan som ska initieras.
+********************************************************************************/
+void led_ilist_init(struct led_ilist* self);
+
+/********************************************************************************
+* led_ilist_clear: Tömmer angiven lista. Samtliga lysdioder länkas ur, men
+*                  lämnas i övrigt orörda.
+*
+*                  - self: Pekare till listan som ska tömmas.
+********************************************************************************/
+void led_ilist_clear(struct led_ilist* self);
+
+/********************************************************************************
+* led_ilist_begin: Returnerar en pekare till den första lysdioden i angiven
+*                  lista. Ifall listan är tom returneras null.
+*
+*                  - self: Pekare till listan.
+********************************************************************************/
+struct led* led_ilist_begin(const struct led_ilist* self);
+
+/********************************************************************************
+* led_ilist_last: Returnerar en pekare till den sista lysdioden i angiven
+*                 lista. Ifall listan är tom returneras null.
+*
+*                 - self: Pekare till listan.
+********************************************************************************/
+struct led* led_ilist_last(const struct led_ilist* self);
+
+/********************************************************************************
+* led_ilist_at: Returnerar en pekare till lysdioden på angivet index.
+*               Sökningen sker från närmaste ände av listan. Ifall ett index
+*               utanför listans omfång passeras så returneras null.
+*
+*               - self : Pekare till listan.
+*               - index: Index till lysdioden som ska returneras.
+********************************************************************************/
+struct led* led_ilist_at(const struct led_ilist* self,
+                         const size_t index);
+
+/********************************************************************************
+* led_ilist_push_front: Länkar in angiven lysdiod längst fram i listan utan
+*                       minnesallokering. Ifall lysdioden redan ligger i en
+*                       intrusiv lista returneras felkod 1, annars 0.
+*
+*                       - self: Pekare till listan som ska tilldelas.
+*                       - led : Pekare till lysdioden som ska länkas in.
+********************************************************************************/
+int led_ilist_push_front(struct led_ilist* self,
+                         struct led* led);
+
+/********************************************************************************
+* led_ilist_push_back: Länkar in angiven lysdiod längst bak i listan utan
+*                      minnesallokering. Ifall lysdioden redan ligger i en
+*                      intrusiv lista returneras felkod 1, annars 0.
+*
+*                      - self: Pekare till listan som ska tilldelas.
+*                      - led : Pekare till lysdioden som ska länkas in.
+********************************************************************************/
+int led_ilist_push_back(struct led_ilist* self,
+                        struct led* led);
+
+/********************************************************************************
+* led_ilist_pop_front: Länkar ur eventuell första lysdiod i angiven lista.
+*
+*                      - self: Pekare till listan.
+********************************************************************************/
+void led_ilist_pop_front(struct led_ilist* self);
+
+/********************************************************************************
+* led_ilist_pop_back: Länkar ur eventuell sista lysdiod i angiven lista.
+*
+*                     - self: Pekare till listan.
+********************************************************************************/
+void led_ilist_pop_back(struct led_ilist* self);
+
+/********************************************************************************
+* led_ilist_insert_at: Länkar in angiven lysdiod på angivet index i listan.
+*                      Ifall index ligger utanför listans omfång eller om
+*                      lysdioden redan ligger i en intrusiv lista returneras
+*                      felkod 1, annars returneras 0.
+*
+*                      - self : Pekare till listan.
+*                      - index: Index där lysdioden ska länkas in.
+*                      - led  : Pekare till lysdioden som ska länkas in.
+********************************************************************************/
+int led_ilist_insert_at(struct led_ilist* self,
+                        const size_t index,
+                        struct led* led);
+
+/********************************************************************************
+* led_ilist_remove_at: Länkar ur lysdioden på angivet index i listan. Ifall
+*                      index ligger utanför listans omfång returneras
+*                      felkod 1, annars returneras 0.
+*
+*                      - self : Pekare till listan.
+*                      - index: Index till lysdioden som ska länkas ur.
+********************************************************************************/
+int led_ilist_remove_at(struct led_ilist* self,
+                        const size_t index);
+
+/********************************************************************************
+* led_ilist_remove: Länkar ur angiven lysdiod ur listan i konstant tid. Ifall
+*                   lysdioden inte ligger i angiven lista returneras felkod 1,
+*                   annars returneras 0.
+*
+*                   - self: Pekare till listan.
+*                   - led : Pekare till lysdioden som ska länkas ur.
+********************************************************************************/
+int led_ilist_remove(struct led_ilist* self,
+                     struct led* led);
+
+/********************************************************************************
+* led_ilist_on: Tänder samtliga lysdioder lagrade i angiven lista. Lysdioder
+*               på samma I/O-port tänds samtidigt via en skrivning per port.
+*
+*               - self: Pekare till listan vars lysdioder ska tändas.
+********************************************************************************/
+void led_ilist_on(struct led_ilist* self);
+
+/********************************************************************************
+* led_ilist_off: Släcker samtliga lysdioder lagrade i angiven lista.
+*                Lysdioder på samma I/O-port släcks samtidigt via en
+*                skrivning per port.
+*
+*                - self: Pekare till listan vars lysdioder ska släckas.
+********************************************************************************/
+void led_ilist_off(struct led_ilist* self);
+
+/********************************************************************************
+* led_ilist_toggle: Togglar samtliga lysdioder lagrade i angiven lista.
+*                   Lysdioder på samma I/O-port togglas samtidigt via en
+*                   skrivning per port till registret PINx, vilket är
+*                   atomärt gentemot avbrott.
+*
+*                   - self: Pekare till listan vars lysdioder ska togglas.
+********************************************************************************/
+void led_ilist_toggle(struct led_ilist* self);
+
+/********************************************************************************
+* led_ilist_blink_collectively: Genomför kollektiv (synkroniserad) blinkning
+*                               av samtliga lysdioder lagrade i angiven
+*                               lista. Funktionen är blockerande.
+*
+*                               - self          : Pekare till listan vars
+*                                                 lysdioder ska blinkas.
+*                               - blink_speed_ms: Lysdiodernas blinkhastighet
+*                                                 mätt i millisekunder.
+********************************************************************************/
+void led_ilist_blink_collectively(struct led_ilist* self,
+                                  const uint16_t blink_speed_ms);
+
+/********************************************************************************
+* led_ilist_blink_forward: Genomför sekventiell blinkning framåt av samtliga
+*                          lysdioder lagrade i angiven lista. Funktionen är
+*                          blockerande.
+*
+*                          - self          : Pekare till listan vars
+*                                            lysdioder ska blinkas.
+*                          - blink_speed_ms: Lysdiodernas blinkhastighet
+*                                            mätt i millisekunder.
+********************************************************************************/
+void led_ilist_blink_forward(struct led_ilist* self,
+                             const uint16_t blink_speed_ms);
+
+/********************************************************************************
+* led_ilist_blink_backward: Genomför sekventiell blinkning bakåt av samtliga
+*                           lysdioder lagrade i angiven lista. Funktionen är
+*                           blockerande.
+*
+*                           - self          : Pekare till listan vars
+*                                             lysdioder ska blinkas.
+*                           - blink_speed_ms: Lysdiodernas blinkhastighet
+*                                             mätt i millisekunder.
+********************************************************************************/
+void led_ilist_blink_backward(struct led_ilist* self,
+                              const uint16_t blink_speed_ms);
+
+#endif /* LED_ILIST_H_ */
@@ -1,511 +1,1276 @@
-#include "led_list.h"
-
-/* Statiska funktioner: */
-struct led_node* led_node_new(struct led* led);
-void led_node_delete(struct led_node** self);
-
-/********************************************************************************
-* led_list_init: Initierar angiven lnkad lista till tom vid start.
-*
-*                - self: Pekare till listan som ska initieras.
-********************************************************************************/
-void led_list_init(struct led_list* self)
-{
-   self->first = 0;
-   self->last = 0;
-   self->size = 0;
-   return;
-}
-
-/********************************************************************************
-* led_list_clear: Tmmer och nollstller angiven lnkad lista.
-*
-*                 - self: Pekare till listan som ska tmmas.
-********************************************************************************/
-void led_list_clear(struct led_list* self)
-{
-   for (struct led_node* i = self->first; ; i = i->next)
-   {
-      struct led_node* next = i->next;
-      led_node_delete(&i);
-      i = next;
-   }
-
-   self->first = 0;
-   self->last = 0;
-   self->size = 0;
-   return;
-}
-
-/********************************************************************************
-* led_list_begin: Returnerar en pekare till den frsta noden i angiven lista.
-*                 Ifall listan r tom returneras null.
-*
-*                 - self: Pekare till listan.
-********************************************************************************/
-struct led_node* led_list_begin(const struct led_list* self)
-{
-   return self->first;
-}
-
-/********************************************************************************
-* led_list_end: Returnerar en pekare till adressen direkt efter den sista
-*               befintliga noden i angiven lista. Ifall listan r tom
-*               returneras null.
-*
-*                - self: Pekare till listan.
-********************************************************************************/
-struct led_node* led_list_end(const struct led_list* self)
-{
-   return self->size > 0 ? self->last->next : 0;
-}
-
-/********************************************************************************
-* led_list_last: Returnerar en pekare till den sista befintliga noden i angiven
-*                lista. Ifall listan r tom returneras null.
-*
-*                - self: Pekare till listan.
-********************************************************************************/
-struct led_node* led_list_last(const struct led_list* self)
-{
-   return self->last;
-}
-
-/********************************************************************************
-* led_list_at: Returnerar en pekare till nod p angivet index. Ifall ett index
-*              utanfr listans omfng passeras s returneras null.
-*
-*              - self : Pekare till listan.
-*              - index: Index till noden vars adress ska returneras.
-********************************************************************************/
-struct led_node* led_list_at(const struct led_list* self,
-                        const size_t index)
-{
-   if (index < self->size)
-   {
-      struct led_node* n = self->first;
-
-      for (size_t i = 0; i < index; ++i)
-      {
-         n = n->next;
-      }
-
-      return n;
-   }
-   else
-   {
-      return 0;
-   }
-}
-
-/********************************************************************************
-* led_list_set: Lagrar adressen till angiven lysdiode p angivet index.
-*               Ifall ett index utanfr listans befintliga omfng passeras s
-*               returneras felkod 1, annars returneras 0.
-*
-*              - self : Pekare till listan.
-*              - index: Index dr adressen till angiven lysdiod ska lagras.
-*              - led  : Pekare (adressen) till lysdioden som ska lggas till.
-********************************************************************************/
-int led_list_set(struct led_list* self,
-                 const size_t index,
-                 struct led* led)
-{
-   if (index < self->size)
-   {
-      struct led_node* n = led_list_at(self, index);
-      n->led = led;
-      return 0;
-   }
-   else
-   {
-      return 1;
-   }
-}
-
-/********************************************************************************
-* led_list_resize: ndrar storleken p angiven lista s att den efter
-*                  omallokering rymmer angivet antal lysdioder, som kan
-*                  tilldelas direkt via index i stllet fr en push-operation.
-*                  Vid misslyckad minnesallokering returneras felkod 1.
-*                  Annars om omallokeringen lyckas s returneras 0.
-*
-*                  - self    : Pekare till listan vars storlek ska ndras.
-*                  - new_size: Vektorns nya storlek.
-********************************************************************************/
-int led_list_resize(struct led_list* self,
-                    const size_t new_size)
-{
-   if (!new_size == 0)
-   {
-      led_list_clear(self);
-      return 0;
-   }
-   else
-   {
-      while (self->size > new_size)
-      {
-         led_list_pop_back(self);
-      }
-      while (self->size < new_size)
-      {
-         led_list_push_back(self, 0);
-      }
-
-      if (self->size == new_size) return 0;
-      else return 1;
-   }
-}
-
-/********************************************************************************
-* led_list_push_front: Lgger till en ny lysdiod lngst fram i angiven
-*                      lista. Vid misslyckad minnesallokering returneras felkod 1.
-*                      Annars om push-operationen lyckas returneras 0.
-*
-*                      - self   : Pekare till listan som ska tilldelas.
-*                      - new_led: Den nya lysdiod som ska lggas till.
-********************************************************************************/
-int led_list_push_front(struct led_list* self,
-                        struct led* new_led)
-{
-   struct led_node* n1 = led_node_new(new_led);
-   struct led_node* n2 = self->first;
-   if (!n1) return 1;
-
-   if (self->size++ == 0)
-   {
-      self->first = n1;
-      self->last = n1;
-   }
-   else
-   {
-      n1->next = n2;
-      n2->previous = n1;
-      self->first = n1;
-   }
-
-   return 0;
-}
-
-/********************************************************************************
-* led_list_push_back: Lgger till en ny lysdiod lngst bak i angiven lista.
-*                     Vid misslyckad minnesallokering returneras felkod 1.
-*                     Annars om push-operationen lyckas returneras 0.
-*
-*                     - self   : Pekare till listan som ska tilldelas.
-*                     - new_led: Den nya lysdiod som ska lggas till.
-********************************************************************************/
-int led_list_push_back(struct led_list* self,
-                       struct led* new_led)
-{
-   struct led_node* n1 = self->last;
-   struct led_node* n2 = led_node_new(new_led);
-   if (!n2) return 1;
-
-   if (self->size++ == 0)
-   {
-      self->first = n2;
-      self->last = n2;
-   }
-   else
-   {
-      n1->next = n2;
-      n2->previous = n1;
-      self->last = n2;
-   }
-
-   return 0;
-}
-
-/********************************************************************************
-* led_list_pop_front: Tar bort eventuell frsta lysdiod i angiven lista.
-*
-*                    - self: Pekare till listan.
-********************************************************************************/
-void led_list_pop_front(struct led_list* self)
-{
-   if (self->size <= 1)
-   {
-      led_list_clear(self);
-   }
-   else
-   {
-      struct led_node* n1 = self->first;
-      struct led_node* n2 = n1->next;
-
-      n1->next = 0;
-      n2->previous = 0;
-
-      led_node_delete(&n1);
-      self->first = n2;
-      self->size--;
-   }
-
-   return;
-}
-
-/********************************************************************************
-* led_list_pop_back: Tar bort eventuellt sista lysdiod i angiven lista.
-*
-*                    - self: Pekare till listan.
-********************************************************************************/
-void led_list_pop_back(struct led_list* self)
-{
-   if (self->size <= 1)
-   {
-      led_list_clear(self);
-   }
-   else
-   {
-      struct led_node* n2 = self->last;
-      struct led_node* n1 = n2->previous;
-
-      n1->next = 0;
-      n2->previous = 0;
-
-      led_node_delete(&n2);
-      self->last = n1;
-      self->size--;
-   }
-
-   return;
-}
-
-/********************************************************************************
-* led_list_insert_at: Lgger in en ny lysdiod p angivet index i en lnkad lista
-*                     och flyttar bak efterfljande lysdioder ett steg.
-*
-*                     Ifall angivet index inte ligger inom listans omgng eller
-*                     om minnesallokeringen misslyckas s returneras felkod 1,
-*                     annars returneras 0.
-*
-*                     - self : Pekare till listan.
-*                     - index: Index dr den nya lysdioden ska lagras.
-*                     - led  : Pekare till lysdioden som ska lagras.
-********************************************************************************/
-int led_list_insert_at(struct led_list* self,
-                       const size_t index,
-                       struct led* led)
-{
-   if (index < self->size)
-   {
-      if (index == 0)
-      {
-         return led_list_push_front(self, led);
-      }
-      else if (index == self->size - 1)
-      {
-         return led_list_push_back(self, led);
-      }
-      else
-      {
-         struct led_node* n3 = led_list_at(self, index);
-         struct led_node* n1 = n3->previous;
-         struct led_node* n2 = led_node_new(led);
-
-         if (!n2) return 1;
-
-         n2->next = n3;
-         n2->previous = n1;
-         n1->next = n2;
-         n3->previous = n2;
-
-         self->size++;
-         return 0;
-      }
-   }
-   else
-   {
-      return 1;
-   }
-}
-
-/********************************************************************************
-* led_list_remove_at: Tar bort lysdiod p angivet index i en lnkad lista oh
-*                     flyttar fram efterfljande lysdioder ett steg.
-*
-*                     Ifall angivet index inte ligger inom listans omgng s
-*                     returneras felkod 1, annars returneras 0.
-*
-*                     - self : Pekare till listan.
-*                     - index: Index till lysdioden som ska tas bort ur listan.
-********************************************************************************/
-int led_list_remove_at(struct led_list* self,
-                       const size_t index)
-{
-   if (index < self->size)
-   {
-      if (index == 0)
-      {
-         led_list_pop_front(self);
-         return 0;
-      }
-      else if (index == self->size - 1)
-      {
-         led_list_pop_back(self);
-         return 0;
-      }
-      else
-      {
-         struct led_node* n2 = led_list_at(self, index);
-         struct led_node* n1 = n2->previous;
-         struct led_node* n3 = n2->next;
-
-         n2->previous = 0;
-         n2->next = 0;
-
-         n1->next = n3;
-         n3->previous = n1;
-
-         led_node_delete(&n2);
-         self->size--;
-         return 0;
-      }
-   }
-   else
-   {
-      return 1;
-   }
-   
-}
-
-/********************************************************************************
-* led_list_on: Tnder samtliga lysdioder lagrade i angiven lista.
-*
-*              - self: Pekare till listan vars lysdioder ska tndas.
-********************************************************************************/
-void led_list_on(struct led_list* self)
-{
-   for (struct led_node* i = self->first; i; i = i->next)
-   {
-      led_on(i->led);
-   }
-   return;
-}
-
-/********************************************************************************
-* led_list_off: Slcker samtliga lysdioder lagrade i angiven lista.
-*
-*               - self: Pekare till listan vars lysdioder ska slckas.
-********************************************************************************/
-void led_list_off(struct led_list* self)
-{
-   for (struct led_node* i = self->first; i; i = i->next)
-   {
-      led_off(i->led);
-   }
-   return;
-}
-
-/********************************************************************************
-* led_list_toggle: Togglar samtliga lysdioder lagrade i angiven lista.
-*
-*                  - self: Pekare till listan vars lysdioder ska togglas.
-********************************************************************************/
-void led_list_toggle(struct led_list* self)
-{
-   for (struct led_node* i = self->first; i; i = i->next)
-   {
-      led_toggle(i->led);
-   }
-   return;
-}
-
-/********************************************************************************
-* led_list_blink_collectively: Genomfr kollektiv (synkroniserad) blinkning
-*                              av samtliga lysdioder lagrade i angiven lista.
-*
-*                              - self          : Pekare till listan vars
-*                                                lysdioder ska blinkas.
-*                              - blink_speed_ms: Lysdiodernas blinkhastighet
-*                                                mtt i millisekunder.
-********************************************************************************/
-void led_list_blink_colletively(struct led_list* self,
-                                const uint16_t blink_speed_ms)
-{
-   led_list_on(self);
-   delay_ms(blink_speed_ms);
-   led_list_off(self);
-   delay_ms(blink_speed_ms);
-   return;
-}
-
-/********************************************************************************
-* led_list_blink_forward: Genomfr sekventiell blinkning framt av samtliga
-*                         lysdioder lagrade i angiven lista. Drmed blinkar
-*                         lysdioderna framt i en sekvens en efter en.
-*
-*                         - self          : Pekare till listan vars lysdioder
-*                                           ska blinkas.
-*                         - blink_speed_ms: Lysdiodernas blinkhastighet
-*                                           mtt i millisekunder.
-********************************************************************************/
-void led_list_blink_forward(struct led_list* self,
-                            const uint16_t blink_speed_ms)
-{
-   led_list_off(self);
-
-   for (struct led_node* i = self->first; i; i = i->next)
-   {
-      led_on(i->led);
-      delay_ms(blink_speed_ms);
-      led_off(i->led);
-   }
-
-   return;
-}
-
-/********************************************************************************
-* led_list_blink_backward: Genomfr sekventiell blinkning bakt av samtliga
-*                          lysdioder lagrade i angiven lista. Drmed blinkar
-*                          lysdioderna bakt i en sekvens en efter en.
-*
-*                          - self          : Pekare till listan vars lysdioder
-*                                            ska blinkas.
-*                          - blink_speed_ms: Lysdiodernas blinkhastighet
-*                                            mtt i millisekunder.
-********************************************************************************/
-void led_list_blink_backward(struct led_list* self,
-                             const uint16_t blink_speed_ms)
-{
-   led_list_off(self);
-
-   for (struct led_node* i = self->last; i; i = i->previous)
-   {
-      led_on(i->led);
-      delay_ms(blink_speed_ms);
-      led_off(i->led);
-   }
-
-   return;
-}
-
-
-/********************************************************************************
-* led_node_new: Allokerar minne fr en ny nod, lagrar en referens till angiven
-*               lysdiod och returnerar en pekare till noden. Vid misslyckad
-*               minnesallokering returneras null.
-********************************************************************************/
-struct led_node* led_node_new(struct led* led)
-{
-   struct led_node* self = (struct led_node*)malloc(sizeof(struct led_node));
-   if (!self) return 0;
-   self->previous = 0;
-   self->next = 0;
-   self->led = led;
-   return self;
-}
-
-/********************************************************************************
-* led_node_delete: Raderar angiven nod genom att frigra minnet fr denna.
-*                  Nodpekaren stts ocks till null efter deallokeringen via 
-*                  passering av dess adress.
-*
-*                  - led_node_delete: Adressen till nodpekaren.
-********************************************************************************/
-void led_node_delete(struct led_node** self)
-{
-   free(*self);
-   *self = 0;
-   return;
-}
\ No newline at end of file
+#include "led_list.h"
+
+/* Statiska funktioner: */
+static struct led_node* led_node_new(struct led* led);
+static void led_node_delete(struct led_node** self);
+static struct led_node* led_node_new_chain(struct led* const* leds,
+                                           const size_t count,
+                                           struct led_node** last);
+static void led_node_delete_chain(struct led_node* first,
+                                  const size_t count);
+static void led_list_update_masks(struct led_list* self);
+static void led_list_blink_release(struct led_list* self,
+                                   const struct led_node* first,
+                                   const struct led_node* last);
+static void led_list_blink_step(void* container);
+
+/* Statiska variabler: */
+static struct led_node led_node_pool[LED_LIST_POOL_SIZE]; /* Nodpool. */
+static struct led_node* led_node_free_list = 0;           /* Frigjorda noder. */
+static size_t led_node_pool_next = 0;            /* Första aldrig använda nod. */
+static size_t led_node_pool_used = 0;            /* Antalet använda noder. */
+static size_t led_node_pool_high_water_mark = 0; /* Högsta antal använda noder. */
+static uint32_t led_node_pool_allocations = 0;   /* Totalt antal allokeringar. */
+
+/********************************************************************************
+* led_list_init: Initierar angiven länkad lista till tom vid start.
+*
+*                - self: Pekare till listan som ska initieras.
+********************************************************************************/
+void led_list_init(struct led_list* self)
+{
+   self->first = 0;
+   self->last = 0;
+   self->size = 0;
+   self->cursor = 0;
+   self->cursor_index = 0;
+   led_list_invalidate_masks(self);
+   led_blink_init(&self->blink);
+   self->blink_node = 0;
+   return;
+}
+
+/********************************************************************************
+* led_list_clear: Tömmer och nollställer angiven länkad lista.
+*
+*                 - self: Pekare till listan som ska tömmas.
+********************************************************************************/
+void led_list_clear(struct led_list* self)
+{
+   led_blink_lock(&self->blink);
+
+   if (self->first)
+   {
+      led_node_delete_chain(self->first, self->size);
+   }
+
+   self->first = 0;
+   self->last = 0;
+   self->size = 0;
+   self->cursor = 0;
+   self->cursor_index = 0;
+   self->blink_node = 0;
+   led_list_invalidate_masks(self);
+   led_blink_unlock(&self->blink);
+   return;
+}
+
+/********************************************************************************
+* led_list_begin: Returnerar en pekare till den första noden i angiven lista.
+*                 Ifall listan är tom returneras null.
+*
+*                 - self: Pekare till listan.
+********************************************************************************/
+struct led_node* led_list_begin(const struct led_list* self)
+{
+   return self->first;
+}
+
+/********************************************************************************
+* led_list_end: Returnerar en pekare till adressen direkt efter den sista
+*               befintliga noden i angiven lista. Ifall listan är tom
+*               returneras null.
+*
+*                - self: Pekare till listan.
+********************************************************************************/
+struct led_node* led_list_end(const struct led_list* self)
+{
+   return self->size > 0 ? self->last->next : 0;
+}
+
+/********************************************************************************
+* led_list_last: Returnerar en pekare till den sista befintliga noden i angiven
+*                lista. Ifall listan är tom returneras null.
+*
+*                - self: Pekare till listan.
+********************************************************************************/
+struct led_node* led_list_last(const struct led_list* self)
+{
+   return self->last;
+}
+
+/********************************************************************************
+* led_list_at: Returnerar en pekare till nod på angivet index. Ifall ett index
+*              utanför listans omfång passeras så returneras null.
+*
+*              Sökningen startar från den av listans början, slut eller
+*              senast åtkomna nod som ligger närmast angivet index, vilket
+*              medför att följdriktig åtkomst samt åtkomst nära listans
+*              slut sker i konstant tid.
+*
+*              - self : Pekare till listan.
+*              - index: Index till noden vars adress ska returneras.
+********************************************************************************/
+struct led_node* led_list_at(struct led_list* self,
+                             const size_t index)
+{
+   if (index < self->size)
+   {
+      const size_t from_last = self->size - 1 - index;
+      const size_t distance = index < from_last ? index : from_last;
+      struct led_node* n = index < from_last ? self->first : self->last;
+      size_t i = index < from_last ? 0 : self->size - 1;
+
+      if (self->cursor)
+      {
+         const size_t from_cursor = index > self->cursor_index ?
+            index - self->cursor_index : self->cursor_index - index;
+
+         if (from_cursor < distance)
+         {
+            n = self->cursor;
+            i = self->cursor_index;
+         }
+      }
+
+      for (; i < index; ++i)
+      {
+         n = n->next;
+      }
+      for (; i > index; --i)
+      {
+         n = n->previous;
+      }
+
+      self->cursor = n;
+      self->cursor_index = index;
+      return n;
+   }
+   else
+   {
+      return 0;
+   }
+}
+
+/********************************************************************************
+* led_list_set: Lagrar adressen till angiven lysdiode på angivet index.
+*               Ifall ett index utanför listans befintliga omfång passeras så
+*               returneras felkod 1, annars returneras 0.
+*
+*              - self : Pekare till listan.
+*              - index: Index där adressen till angiven lysdiod ska lagras.
+*              - led  : Pekare (adressen) till lysdioden som ska läggas till.
+********************************************************************************/
+int led_list_set(struct led_list* self,
+                 const size_t index,
+                 struct led* led)
+{
+   if (index < self->size)
+   {
+      struct led_node* n = led_list_at(self, index);
+      led_blink_lock(&self->blink);
+      n->led = led;
+      led_list_invalidate_masks(self);
+      led_blink_unlock(&self->blink);
+      return 0;
+   }
+   else
+   {
+      return 1;
+   }
+}
+
+/********************************************************************************
+* led_list_resize: Ändrar storleken på angiven lista så att den efter
+*                  omallokering rymmer angivet antal lysdioder, som kan
+*                  tilldelas direkt via index i stället för en push-operation.
+*                  Nya noder lagrar null och reserveras samt länkas in i ett
+*                  svep, överskjutande noder återlämnas i ett svep. Om
+*                  nodpoolen saknar plats lämnas listan orörd och felkod 1
+*                  returneras. Annars om omallokeringen lyckas så returneras 0.
+*
+*                  - self    : Pekare till listan vars storlek ska ändras.
+*                  - new_size: Vektorns nya storlek.
+********************************************************************************/
+int led_list_resize(struct led_list* self,
+                    const size_t new_size)
+{
+   if (new_size == 0)
+   {
+      led_list_clear(self);
+      return 0;
+   }
+   else if (new_size < self->size)
+   {
+      return led_list_remove_range(self, new_size, self->size - new_size);
+   }
+   else
+   {
+      return led_list_append_range(self, 0, new_size - self->size);
+   }
+}
+
+/********************************************************************************
+* led_list_push_front: Lägger till en ny lysdiod längst fram i angiven
+*                      lista. Vid misslyckad minnesallokering returneras felkod 1.
+*                      Annars om push-operationen lyckas returneras 0.
+*
+*                      - self   : Pekare till listan som ska tilldelas.
+*                      - new_led: Den nya lysdiod som ska läggas till.
+********************************************************************************/
+int led_list_push_front(struct led_list* self,
+                        struct led* new_led)
+{
+   struct led_node* n1 = led_node_new(new_led);
+   struct led_node* n2 = self->first;
+   if (!n1) return 1;
+   led_blink_lock(&self->blink);
+   led_list_invalidate_masks(self);
+   if (self->cursor) self->cursor_index++;
+
+   if (self->size++ == 0)
+   {
+      self->first = n1;
+      self->last = n1;
+   }
+   else
+   {
+      n1->next = n2;
+      n2->previous = n1;
+      self->first = n1;
+   }
+
+   led_blink_unlock(&self->blink);
+   return 0;
+}
+
+/********************************************************************************
+* led_list_push_back: Lägger till en ny lysdiod längst bak i angiven lista.
+*                     Vid misslyckad minnesallokering returneras felkod 1.
+*                     Annars om push-operationen lyckas returneras 0.
+*
+*                     - self   : Pekare till listan som ska tilldelas.
+*                     - new_led: Den nya lysdiod som ska läggas till.
+********************************************************************************/
+int led_list_push_back(struct led_list* self,
+                       struct led* new_led)
+{
+   struct led_node* n1 = self->last;
+   struct led_node* n2 = led_node_new(new_led);
+   if (!n2) return 1;
+   led_blink_lock(&self->blink);
+   led_list_invalidate_masks(self);
+
+   if (self->size++ == 0)
+   {
+      self->first = n2;
+      self->last = n2;
+   }
+   else
+   {
+      n1->next = n2;
+      n2->previous = n1;
+      self->last = n2;
+   }
+
+   led_blink_unlock(&self->blink);
+   return 0;
+}
+
+/********************************************************************************
+* led_list_pop_front: Tar bort eventuell första lysdiod i angiven lista.
+*
+*                    - self: Pekare till listan.
+********************************************************************************/
+void led_list_pop_front(struct led_list* self)
+{
+   led_blink_lock(&self->blink);
+
+   if (self->size <= 1)
+   {
+      led_list_clear(self);
+   }
+   else
+   {
+      struct led_node* n1 = self->first;
+      struct led_node* n2 = n1->next;
+
+      n1->next = 0;
+      n2->previous = 0;
+
+      if (self->cursor == n1) self->cursor = n2;
+      else if (self->cursor) self->cursor_index--;
+
+      led_list_blink_release(self, n1, n1);
+      led_node_delete(&n1);
+      self->first = n2;
+      self->size--;
+      led_list_invalidate_masks(self);
+   }
+
+   led_blink_unlock(&self->blink);
+   return;
+}
+
+/********************************************************************************
+* led_list_pop_back: Tar bort eventuellt sista lysdiod i angiven lista.
+*
+*                    - self: Pekare till listan.
+********************************************************************************/
+void led_list_pop_back(struct led_list* self)
+{
+   led_blink_lock(&self->blink);
+
+   if (self->size <= 1)
+   {
+      led_list_clear(self);
+   }
+   else
+   {
+      struct led_node* n2 = self->last;
+      struct led_node* n1 = n2->previous;
+
+      n1->next = 0;
+      n2->previous = 0;
+
+      if (self->cursor == n2)
+      {
+         self->cursor = n1;
+         self->cursor_index--;
+      }
+
+      led_list_blink_release(self, n2, n2);
+      led_node_delete(&n2);
+      self->last = n1;
+      self->size--;
+      led_list_invalidate_masks(self);
+   }
+
+   led_blink_unlock(&self->blink);
+   return;
+}
+
+/********************************************************************************
+* led_list_insert_at: Lägger in en ny lysdiod på angivet index i en länkad lista
+*                     och flyttar bak efterföljande lysdioder ett steg.
+*
+*                     Ifall angivet index inte ligger inom listans omgång eller
+*                     om minnesallokeringen misslyckas så returneras felkod 1,
+*                     annars returneras 0.
+*
+*                     - self : Pekare till listan.
+*                     - index: Index där den nya lysdioden ska lagras.
+*                     - led  : Pekare till lysdioden som ska lagras.
+********************************************************************************/
+int led_list_insert_at(struct led_list* self,
+                       const size_t index,
+                       struct led* led)
+{
+   if (index < self->size)
+   {
+      if (index == 0)
+      {
+         return led_list_push_front(self, led);
+      }
+      else
+      {
+         struct led_node* n3 = led_list_at(self, index);
+         struct led_node* n1 = n3->previous;
+         struct led_node* n2 = led_node_new(led);
+
+         if (!n2) return 1;
+         led_blink_lock(&self->blink);
+
+         n2->next = n3;
+         n2->previous = n1;
+         n1->next = n2;
+         n3->previous = n2;
+
+         self->cursor = n2;
+         self->size++;
+         led_list_invalidate_masks(self);
+         led_blink_unlock(&self->blink);
+         return 0;
+      }
+   }
+   else
+   {
+      return 1;
+   }
+}
+
+/********************************************************************************
+* led_list_remove_at: Tar bort lysdiod på angivet index i en länkad lista oh
+*                     flyttar fram efterföljande lysdioder ett steg.
+*
+*                     Ifall angivet index inte ligger inom listans omgång så
+*                     returneras felkod 1, annars returneras 0.
+*
+*                     - self : Pekare till listan.
+*                     - index: Index till lysdioden som ska tas bort ur listan.
+********************************************************************************/
+int led_list_remove_at(struct led_list* self,
+                       const size_t index)
+{
+   if (index < self->size)
+   {
+      if (index == 0)
+      {
+         led_list_pop_front(self);
+         return 0;
+      }
+      else if (index == self->size - 1)
+      {
+         led_list_pop_back(self);
+         return 0;
+      }
+      else
+      {
+         struct led_node* n2 = led_list_at(self, index);
+         struct led_node* n1 = n2->previous;
+         struct led_node* n3 = n2->next;
+
+         led_blink_lock(&self->blink);
+         led_list_blink_release(self, n2, n2);
+         n2->previous = 0;
+         n2->next = 0;
+
+         n1->next = n3;
+         n3->previous = n1;
+
+         self->cursor = n3;
+         led_node_delete(&n2);
+         self->size--;
+         led_list_invalidate_masks(self);
+         led_blink_unlock(&self->blink);
+         return 0;
+      }
+   }
+   else
+   {
+      return 1;
+   }
+   
+}
+
+/********************************************************************************
+* led_list_assign: Ersätter innehållet i angiven lista med lysdioderna i
+*                  angiven array. Listans befintliga noder räknas som lediga
+*                  vid kontrollen av nodpoolen, eftersom de återlämnas innan
+*                  de nya noderna reserveras. Ifall nodpoolen inte rymmer
+*                  samtliga lysdioder lämnas listan orörd och felkod 1
+*                  returneras, annars returneras 0.
+*
+*                  - self : Pekare till listan som ska tilldelas.
+*                  - leds : Array med pekare till lysdioderna (eller null för
+*                           att lagra null i samtliga noder).
+*                  - count: Antalet lysdioder i arrayen.
+********************************************************************************/
+int led_list_assign(struct led_list* self,
+                    struct led* const* leds,
+                    const size_t count)
+{
+   if (count > LED_LIST_POOL_SIZE - led_node_pool_used + self->size) return 1;
+   led_list_clear(self);
+   return led_list_insert_range(self, 0, leds, count);
+}
+
+/********************************************************************************
+* led_list_append_range: Lägger till lysdioderna i angiven array längst bak
+*                        i angiven lista, se led_list_insert_range.
+*
+*                        - self : Pekare till listan som ska tilldelas.
+*                        - leds : Array med pekare till lysdioderna (eller null).
+*                        - count: Antalet lysdioder i arrayen.
+********************************************************************************/
+int led_list_append_range(struct led_list* self,
+                          struct led* const* leds,
+                          const size_t count)
+{
+   return led_list_insert_range(self, self->size, leds, count);
+}
+
+/********************************************************************************
+* led_list_insert_range: Lägger in lysdioderna i angiven array med start på
+*                        angivet index och flyttar bak efterföljande
+*                        lysdioder motsvarande antal steg. Noden på angivet
+*                        index söks upp via led_list_at, varefter den nya
+*                        kedjan länkas in före den i konstant tid.
+*
+*                        Ifall index ligger utanför listans omfång (index
+*                        lika med listans storlek innebär tillägg längst bak)
+*                        eller om nodpoolen inte rymmer samtliga lysdioder
+*                        lämnas listan orörd och felkod 1 returneras, annars
+*                        returneras 0.
+*
+*                        - self : Pekare till listan.
+*                        - index: Index där den första lysdioden ska lagras.
+*                        - leds : Array med pekare till lysdioderna (eller null
+*                                 för att lagra null i samtliga noder).
+*                        - count: Antalet lysdioder i arrayen.
+********************************************************************************/
+int led_list_insert_range(struct led_list* self,
+                          const size_t index,
+                          struct led* const* leds,
+                          const size_t count)
+{
+   if (index > self->size) return 1;
+   if (count == 0) return 0;
+
+   struct led_node* n3 = led_list_at(self, index);
+   struct led_node* n1 = n3 ? n3->previous : self->last;
+   struct led_node* last = 0;
+   struct led_node* first = led_node_new_chain(leds, count, &last);
+   if (!first) return 1;
+   led_blink_lock(&self->blink);
+
+   first->previous = n1;
+   last->next = n3;
+
+   if (n1) n1->next = first;
+   else self->first = first;
+
+   if (n3) n3->previous = last;
+   else self->last = last;
+
+   if (self->cursor && self->cursor_index >= index) self->cursor_index += count;
+   self->size += count;
+   led_list_invalidate_masks(self);
+   led_blink_unlock(&self->blink);
+   return 0;
+}
+
+/********************************************************************************
+* led_list_remove_range: Tar bort angivet antal lysdioder med start på
+*                        angivet index och flyttar fram efterföljande
+*                        lysdioder. Den första noden i segmentet söks upp
+*                        via led_list_at, varefter segmentet stegas igenom en
+*                        gång för att hitta dess sista nod och länkas ur.
+*
+*                        Ifall segmentet inte ryms inom listans omfång
+*                        returneras felkod 1, annars returneras 0.
+*
+*                        - self : Pekare till listan.
+*                        - index: Index till den första lysdioden som ska
+*                                 tas bort.
+*                        - count: Antalet lysdioder som ska tas bort.
+********************************************************************************/
+int led_list_remove_range(struct led_list* self,
+                          const size_t index,
+                          const size_t count)
+{
+   if (index > self->size || count > self->size - index) return 1;
+   if (count == 0) return 0;
+
+   if (count == self->size)
+   {
+      led_list_clear(self);
+      return 0;
+   }
+
+   struct led_node* first = led_list_at(self, index);
+   struct led_node* last = first;
+
+   for (size_t i = 1; i < count; ++i)
+   {
+      last = last->next;
+   }
+
+   struct led_node* n1 = first->previous;
+   struct led_node* n3 = last->next;
+
+   led_blink_lock(&self->blink);
+   led_list_blink_release(self, first, last);
+
+   if (n1) n1->next = n3;
+   else self->first = n3;
+
+   if (n3) n3->previous = n1;
+   else self->last = n1;
+
+   if (n3)
+   {
+      self->cursor = n3;
+      self->cursor_index = index;
+   }
+   else
+   {
+      self->cursor = n1;
+      self->cursor_index = index - 1;
+   }
+
+   last->next = 0;
+   led_node_delete_chain(first, count);
+   self->size -= count;
+   led_list_invalidate_masks(self);
+   led_blink_unlock(&self->blink);
+   return 0;
+}
+
+/********************************************************************************
+* led_list_splice: Flyttar nodsegmentet first - last från listan other till
+*                  positionen före angiven nod i angiven lista, utan någon
+*                  allokering. Segmentets noder stegas igenom en gång, dels
+*                  för att uppdatera listornas storlek, dels för att inom
+*                  samma lista kontrollera att positionen inte ligger inom
+*                  segmentet, varvid tidskomplexiteten blir O(k). Segmentet
+*                  länkas sedan ur och in i konstant tid. Listornas
+*                  indexcache nollställs.
+*
+*                  Ifall segmentet saknas eller om positionen ligger inom
+*                  segmentet returneras felkod 1, annars returneras 0.
+*
+*                  - self    : Pekare till listan som segmentet flyttas till.
+*                  - position: Nod som segmentet ska placeras före (eller null
+*                              för att placera segmentet längst bak).
+*                  - other   : Pekare till listan som segmentet flyttas från
+*                              (kan vara samma som self).
+*                  - first   : Första noden i segmentet.
+*                  - last    : Sista noden i segmentet.
+********************************************************************************/
+int led_list_splice(struct led_list* self,
+                    struct led_node* position,
+                    struct led_list* other,
+                    struct led_node* first,
+                    struct led_node* last)
+{
+   size_t count = 0;
+   if (!first || !last) return 1;
+
+   for (struct led_node* i = first; i; i = i->next)
+   {
+      if (self == other && i == position) return 1;
+      count++;
+      if (i == last) break;
+   }
+
+   led_blink_lock(&self->blink);
+   led_blink_lock(&other->blink);
+   if (self != other) led_list_blink_release(other, first, last);
+
+   if (first->previous) first->previous->next = last->next;
+   else other->first = last->next;
+
+   if (last->next) last->next->previous = first->previous;
+   else other->last = first->previous;
+
+   struct led_node* before = position ? position->previous : self->last;
+   first->previous = before;
+   last->next = position;
+
+   if (before) before->next = first;
+   else self->first = first;
+
+   if (position) position->previous = last;
+   else self->last = last;
+
+   other->size -= count;
+   self->size += count;
+   other->cursor = 0;
+   self->cursor = 0;
+   led_list_invalidate_masks(other);
+   led_list_invalidate_masks(self);
+   led_blink_unlock(&other->blink);
+   led_blink_unlock(&self->blink);
+   return 0;
+}
+
+/********************************************************************************
+* led_list_split: Delar angiven lista vid angiven nod, så att noden samt
+*                 samtliga efterföljande noder flyttas till slutet av listan
+*                 tail, utan någon allokering. Svansen räknas för att
+*                 uppdatera listornas storlek, varvid tidskomplexiteten blir
+*                 O(k) för k flyttade noder. Listans indexcache behålls ifall
+*                 den pekar på en nod som ligger kvar.
+*
+*                 Ifall noden saknas eller om listorna är desamma returneras
+*                 felkod 1, annars returneras 0.
+*
+*                 - self: Pekare till listan som ska delas.
+*                 - node: Första noden som ska flyttas till listan tail.
+*                 - tail: Pekare till listan som svansen läggs till i.
+********************************************************************************/
+int led_list_split(struct led_list* self,
+                   struct led_node* node,
+                   struct led_list* tail)
+{
+   size_t count = 0;
+   if (!node || self == tail) return 1;
+
+   for (struct led_node* i = node; i; i = i->next)
+   {
+      count++;
+   }
+
+   led_blink_lock(&self->blink);
+   led_blink_lock(&tail->blink);
+   led_list_blink_release(self, node, 0);
+
+   struct led_node* last = self->last;
+   self->last = node->previous;
+
+   if (self->last) self->last->next = 0;
+   else self->first = 0;
+
+   node->previous = tail->last;
+
+   if (tail->last) tail->last->next = node;
+   else tail->first = node;
+
+   tail->last = last;
+   self->size -= count;
+   tail->size += count;
+
+   if (self->cursor && self->cursor_index >= self->size) self->cursor = 0;
+   led_list_invalidate_masks(self);
+   led_list_invalidate_masks(tail);
+   led_blink_unlock(&tail->blink);
+   led_blink_unlock(&self->blink);
+   return 0;
+}
+
+/********************************************************************************
+* led_list_concat: Flyttar samtliga noder i listan other till slutet av
+*                  angiven lista i konstant tid, utan någon allokering.
+*                  Listan other är därefter tom.
+*
+*                  - self : Pekare till listan som ska utökas.
+*                  - other: Pekare till listan vars noder ska flyttas.
+********************************************************************************/
+void led_list_concat(struct led_list* self,
+                     struct led_list* other)
+{
+   if (self == other || !other->first) return;
+   led_blink_lock(&self->blink);
+   led_blink_lock(&other->blink);
+
+   other->first->previous = self->last;
+
+   if (self->last) self->last->next = other->first;
+   else self->first = other->first;
+
+   self->last = other->last;
+   self->size += other->size;
+
+   other->first = 0;
+   other->last = 0;
+   other->size = 0;
+   other->cursor = 0;
+   other->cursor_index = 0;
+   other->blink_node = 0;
+   led_list_invalidate_masks(self);
+   led_list_invalidate_masks(other);
+   led_blink_unlock(&other->blink);
+   led_blink_unlock(&self->blink);
+   return;
+}
+
+/********************************************************************************
+* led_list_reverse: Vänder på ordningen av noderna i angiven lista på plats
+*                   genom att byta varje nods pekare till föregående samt
+*                   nästa nod, utan någon allokering. Indexcachen behålls
+*                   genom att dess index speglas.
+*
+*                   - self: Pekare till listan som ska vändas.
+********************************************************************************/
+void led_list_reverse(struct led_list* self)
+{
+   struct led_node* i = self->first;
+   led_blink_lock(&self->blink);
+
+   while (i)
+   {
+      struct led_node* next = i->next;
+      i->next = i->previous;
+      i->previous = next;
+      i = next;
+   }
+
+   i = self->first;
+   self->first = self->last;
+   self->last = i;
+
+   if (self->cursor) self->cursor_index = self->size - 1 - self->cursor_index;
+   led_blink_unlock(&self->blink);
+   return;
+}
+
+/********************************************************************************
+* led_list_invalidate_masks: Markerar listans cachade portmasker som inaktuella,
+*                            så att de byggs om vid nästa gruppoperation.
+*                            Behöver endast anropas ifall en lagrad lysdiod
+*                            har initierats om medan den ligger i listan.
+*
+*                            - self: Pekare till listan.
+********************************************************************************/
+void led_list_invalidate_masks(struct led_list* self)
+{
+   self->port_masks_valid = false;
+   return;
+}
+
+/********************************************************************************
+* led_list_on: Tänder samtliga lysdioder lagrade i angiven lista. Lysdioder
+*              på samma I/O-port tänds samtidigt via en skrivning per port.
+*
+*              - self: Pekare till listan vars lysdioder ska tändas.
+********************************************************************************/
+void led_list_on(struct led_list* self)
+{
+   led_list_update_masks(self);
+
+   port_shadow_write_masks(self->port_masks, PORT_SHADOW_SET);
+   if (!self->shift_register_leds && !self->matrix_leds) return;
+
+   if (self->shift_register_leds) shift_register_begin();
+
+   for (struct led_node* i = self->first; i; i = i->next)
+   {
+      if (i->led) led_set_enabled(i->led, true);
+   }
+
+   if (self->shift_register_leds) shift_register_end();
+   return;
+}
+
+/********************************************************************************
+* led_list_off: Släcker samtliga lysdioder lagrade i angiven lista. Lysdioder
+*               på samma I/O-port släcks samtidigt via en skrivning per port.
+*
+*               - self: Pekare till listan vars lysdioder ska släckas.
+********************************************************************************/
+void led_list_off(struct led_list* self)
+{
+   led_list_update_masks(self);
+
+   port_shadow_write_masks(self->port_masks, PORT_SHADOW_CLEAR);
+   if (!self->shift_register_leds && !self->matrix_leds) return;
+
+   if (self->shift_register_leds) shift_register_begin();
+
+   for (struct led_node* i = self->first; i; i = i->next)
+   {
+      if (i->led) led_set_enabled(i->led, false);
+   }
+
+   if (self->shift_register_leds) shift_register_end();
+   return;
+}
+
+/********************************************************************************
+* led_list_toggle: Togglar samtliga lysdioder lagrade i angiven lista.
+*                  Lysdioder på samma I/O-port togglas samtidigt via en
+*                  skrivning per port till registret PINx, vilket är
+*                  atomärt gentemot avbrott.
+*
+*                  - self: Pekare till listan vars lysdioder ska togglas.
+********************************************************************************/
+void led_list_toggle(struct led_list* self)
+{
+   led_list_update_masks(self);
+
+   port_shadow_write_masks(self->port_masks, PORT_SHADOW_TOGGLE);
+   if (!self->shift_register_leds && !self->matrix_leds) return;
+
+   if (self->shift_register_leds) shift_register_begin();
+
+   for (struct led_node* i = self->first; i; i = i->next)
+   {
+      struct led* led = i->led;
+      if (!led) continue;
+
+      if (led->io_port < IO_PORT_NONE) led->enabled = led_is_enabled(led);
+      else led_set_enabled(led, !led->enabled);
+   }
+
+   if (self->shift_register_leds) shift_register_end();
+   return;
+}
+
+/********************************************************************************
+* led_list_blink_collectively: Genomför kollektiv (synkroniserad) blinkning
+*                              av samtliga lysdioder lagrade i angiven lista.
+*
+*                              - self          : Pekare till listan vars
+*                                                lysdioder ska blinkas.
+*                              - blink_speed_ms: Lysdiodernas blinkhastighet
+*                                                mätt i millisekunder.
+********************************************************************************/
+void led_list_blink_colletively(struct led_list* self,
+                                const uint16_t blink_speed_ms)
+{
+   led_list_on(self);
+   delay_ms(blink_speed_ms);
+   led_list_off(self);
+   delay_ms(blink_speed_ms);
+   return;
+}
+
+/********************************************************************************
+* led_list_blink_forward: Genomför sekventiell blinkning framåt av samtliga
+*                         lysdioder lagrade i angiven lista. Därmed blinkar
+*                         lysdioderna framåt i en sekvens en efter en.
+*
+*                         - self          : Pekare till listan vars lysdioder
+*                                           ska blinkas.
+*                         - blink_speed_ms: Lysdiodernas blinkhastighet
+*                                           mätt i millisekunder.
+********************************************************************************/
+void led_list_blink_forward(struct led_list* self,
+                            const uint16_t blink_speed_ms)
+{
+   led_list_off(self);
+
+   for (struct led_node* i = self->first; i; i = i->next)
+   {
+      led_on(i->led);
+      delay_ms(blink_speed_ms);
+      led_off(i->led);
+   }
+
+   return;
+}
+
+/********************************************************************************
+* led_list_blink_backward: Genomför sekventiell blinkning bakåt av samtliga
+*                          lysdioder lagrade i angiven lista. Därmed blinkar
+*                          lysdioderna bakåt i en sekvens en efter en.
+*
+*                          - self          : Pekare till listan vars lysdioder
+*                                            ska blinkas.
+*                          - blink_speed_ms: Lysdiodernas blinkhastighet
+*                                            mätt i millisekunder.
+********************************************************************************/
+void led_list_blink_backward(struct led_list* self,
+                             const uint16_t blink_speed_ms)
+{
+   led_list_off(self);
+
+   for (struct led_node* i = self->last; i; i = i->previous)
+   {
+      led_on(i->led);
+      delay_ms(blink_speed_ms);
+      led_off(i->led);
+   }
+
+   return;
+}
+
+
+/********************************************************************************
+* led_list_update_masks: Bygger om listans bitmasker för I/O-port B, C och D
+*                        ifall listan har modifierats sedan senaste
+*                        gruppoperationen, samt noterar ifall listan
+*                        innehåller skiftregisterutgångar eller
+*                        matrisceller. Tomma platser (null) ignoreras.
+*
+*                        - self: Pekare till listan.
+********************************************************************************/
+static void led_list_update_masks(struct led_list* self)
+{
+   if (self->port_masks_valid) return;
+
+   self->port_masks[IO_PORTB] = 0;
+   self->port_masks[IO_PORTC] = 0;
+   self->port_masks[IO_PORTD] = 0;
+   self->shift_register_leds = false;
+   self->matrix_leds = false;
+
+   for (struct led_node* i = self->first; i; i = i->next)
+   {
+      if (i->led && i->led->io_port < IO_PORT_NONE)
+      {
+         self->port_masks[i->led->io_port] |= (1 << i->led->pin);
+      }
+      else if (i->led && i->led->io_port == IO_PORT_SHIFT_REGISTER)
+      {
+         self->shift_register_leds = true;
+      }
+      else if (i->led && i->led->io_port == IO_PORT_MATRIX)
+      {
+         self->matrix_leds = true;
+      }
+   }
+
+   self->port_masks_valid = true;
+   return;
+}
+
+/********************************************************************************
+* led_list_blink_start: Startar icke-blockerande blinkning av lysdioderna i
+*                       angiven lista enligt angivet blinkmönster. Funktionen
+*                       returnerar direkt, varefter blinkningen drivs vidare
+*                       från systemticken (Timer 0) en gång per millisekund.
+*                       Eventuell pågående blinkning av listan ersätts.
+*                       Medan blinkning pågår får listan endast ändras via
+*                       listans egna funktioner (se led_list.h).
+*
+*                       Ifall systemticken saknar ledig plats för
+*                       blinkmotorn returneras felkod 1, annars returneras 0.
+*
+*                       - self          : Pekare till listan vars lysdioder
+*                                         ska blinkas.
+*                       - mode          : Blinkmönster som ska användas.
+*                       - blink_speed_ms: Lysdiodernas blinkhastighet
+*                                         mätt i millisekunder.
+********************************************************************************/
+int led_list_blink_start(struct led_list* self,
+                         const enum led_list_blink_mode mode,
+                         const uint16_t blink_speed_ms)
+{
+   led_list_blink_stop(self);
+   if (mode == LED_LIST_BLINK_NONE) return 0;
+   self->blink_node = 0;
+   return led_blink_start(&self->blink, mode, blink_speed_ms, led_list_blink_step, self);
+}
+
+/********************************************************************************
+* led_list_blink_stop: Stoppar eventuell pågående icke-blockerande blinkning
+*                      av angiven lista och släcker samtliga lysdioder.
+*                      Om ingen lista eller vektor längre blinkar kopplas
+*                      blinkmotorn bort från systemticken.
+*
+*                      - self: Pekare till listan vars blinkning ska stoppas.
+********************************************************************************/
+void led_list_blink_stop(struct led_list* self)
+{
+   led_blink_stop(&self->blink);
+   self->blink_node = 0;
+   led_list_off(self);
+   return;
+}
+
+/********************************************************************************
+* led_list_blink_release: Nollställer listans aktuella blinknod ifall den
+*                         ingår i segmentet first - last, som ska tas bort
+*                         ur listan eller flyttas till en annan lista.
+*                         Nodens lysdiod, som är tänd av blinkmönstret,
+*                         släcks. Nästa steg i blinkmönstret börjar då om
+*                         från listans början respektive slut i stället för
+*                         att följa en frigjord eller flyttad nod. Anropas
+*                         med blinkmotorn spärrad, innan segmentet länkas ur.
+*
+*                         - self : Pekare till listan.
+*                         - first: Första noden i segmentet.
+*                         - last : Sista noden i segmentet (eller null för
+*                                  samtliga noder till listans slut).
+********************************************************************************/
+static void led_list_blink_release(struct led_list* self,
+                                   const struct led_node* first,
+                                   const struct led_node* last)
+{
+   if (!self->blink_node) return;
+
+   for (const struct led_node* i = first; i; i = i->next)
+   {
+      if (i == self->blink_node)
+      {
+         if (i->led) led_off(i->led);
+         self->blink_node = 0;
+         break;
+      }
+
+      if (i == last) break;
+   }
+
+   return;
+}
+
+/********************************************************************************
+* led_list_blink_step: Genomför nästa steg i angiven listas blinkmönster.
+*                      Vid kollektiv blinkning togglas samtliga lysdioder,
+*                      medan den aktuella lysdioden vid sekventiell blinkning
+*                      släcks och nästa lysdiod i sekvensen tänds. Efter
+*                      sista lysdioden börjar sekvensen om från början.
+*                      Släckning och tändning av skiftregisterutgångar skiftas
+*                      ut tillsammans i en enda skur.
+*
+*                      Anropas från den gemensamma blinkmotorn (se
+*                      led_blink.h).
+*
+*                      - container: Pekare till listan.
+********************************************************************************/
+static void led_list_blink_step(void* container)
+{
+   struct led_list* self = (struct led_list*)container;
+   struct led_node* n = self->blink_node;
+
+   if (self->blink.mode == LED_LIST_BLINK_COLLECTIVELY)
+   {
+      led_list_toggle(self);
+      return;
+   }
+
+   shift_register_begin();
+   if (n && n->led) led_off(n->led);
+
+   if (self->blink.mode == LED_LIST_BLINK_FORWARD)
+   {
+      n = n && n->next ? n->next : self->first;
+   }
+   else if (self->blink.mode == LED_LIST_BLINK_BACKWARD)
+   {
+      n = n && n->previous ? n->previous : self->last;
+   }
+
+   if (n && n->led) led_on(n->led);
+   shift_register_end();
+   self->blink_node = n;
+   return;
+}
+
+/********************************************************************************
+* led_node_pool_get_stats: Läser av aktuell statistik för nodpoolen.
+*
+*                          - stats: Pekare till strukt där statistiken lagras.
+********************************************************************************/
+void led_node_pool_get_stats(struct led_node_pool_stats* stats)
+{
+   stats->capacity = LED_LIST_POOL_SIZE;
+   stats->num_free = LED_LIST_POOL_SIZE - led_node_pool_used;
+   stats->num_used = led_node_pool_used;
+   stats->high_water_mark = led_node_pool_high_water_mark;
+   stats->allocations = led_node_pool_allocations;
+   return;
+}
+
+/********************************************************************************
+* led_node_new: Allokerar en ny nod från den statiska nodpoolen, lagrar en
+*               referens till angiven lysdiod och returnerar en pekare till
+*               noden. I första hand återanvänds frigjorda noder från den
+*               fria listan, annars tas nästa aldrig använda nod i poolen.
+*               Allokeringen sker därmed alltid i konstant tid. Om poolen
+*               är full returneras null.
+********************************************************************************/
+static struct led_node* led_node_new(struct led* led)
+{
+   struct led_node* self = led_node_free_list;
+
+   if (self)
+   {
+      led_node_free_list = self->next;
+   }
+   else if (led_node_pool_next < LED_LIST_POOL_SIZE)
+   {
+      self = &led_node_pool[led_node_pool_next++];
+   }
+   else
+   {
+      return 0;
+   }
+
+   led_node_pool_allocations++;
+
+   if (++led_node_pool_used > led_node_pool_high_water_mark)
+   {
+      led_node_pool_high_water_mark = led_node_pool_used;
+   }
+
+   self->previous = 0;
+   self->next = 0;
+   self->led = led;
+   return self;
+}
+
+/********************************************************************************
+* led_node_delete: Återlämnar angiven nod till nodpoolen genom att lägga den
+*                  först i den fria listan. Nodpekaren sätts också till null
+*                  efter deallokeringen via passering av dess adress.
+*
+*                  - led_node_delete: Adressen till nodpekaren.
+********************************************************************************/
+static void led_node_delete(struct led_node** self)
+{
+   if (!*self) return;
+   (*self)->previous = 0;
+   (*self)->led = 0;
+   (*self)->next = led_node_free_list;
+   led_node_free_list = *self;
+   led_node_pool_used--;
+   *self = 0;
+   return;
+}
+
+/********************************************************************************
+* led_node_new_chain: Reserverar angivet antal noder ur nodpoolen och länkar
+*                     samman dem i ett svep till en kedja, där nod i lagrar
+*                     lysdiod i i angiven array. Reservationen är allt eller
+*                     inget: ifall nodpoolen inte rymmer samtliga noder
+*                     returneras null utan att någon nod har reserverats,
+*                     annars returneras en pekare till den första noden.
+*
+*                     - leds : Array med pekare till lysdioderna (eller null
+*                              för att lagra null i samtliga noder).
+*                     - count: Antalet noder som ska reserveras (minst 1).
+*                     - last : Pekare där den sista nodens adress lagras.
+********************************************************************************/
+static struct led_node* led_node_new_chain(struct led* const* leds,
+                                           const size_t count,
+                                           struct led_node** last)
+{
+   if (count > LED_LIST_POOL_SIZE - led_node_pool_used) return 0;
+
+   struct led_node* first = 0;
+   struct led_node* previous = 0;
+
+   for (size_t i = 0; i < count; ++i)
+   {
+      struct led_node* self = led_node_free_list;
+
+      if (self)
+      {
+         led_node_free_list = self->next;
+      }
+      else
+      {
+         self = &led_node_pool[led_node_pool_next++];
+      }
+
+      self->previous = previous;
+      self->next = 0;
+      self->led = leds ? leds[i] : 0;
+
+      if (previous) previous->next = self;
+      else first = self;
+      previous = self;
+   }
+
+   led_node_pool_allocations += count;
+   led_node_pool_used += count;
+
+   if (led_node_pool_used > led_node_pool_high_water_mark)
+   {
+      led_node_pool_high_water_mark = led_node_pool_used;
+   }
+
+   *last = previous;
+   return first;
+}
+
+/********************************************************************************
+* led_node_delete_chain: Återlämnar en kedja av noder till nodpoolen i ett
+*                        svep. Kedjan behåller sina next-pekare och läggs
+*                        först i den fria listan i sin helhet.
+*
+*                        - first: Pekare till kedjans första nod, vars sista
+*                                 nod har next-pekaren satt till null.
+*                        - count: Antalet noder i kedjan.
+********************************************************************************/
+static void led_node_delete_chain(struct led_node* first,
+                                  const size_t count)
+{
+   struct led_node* i = first;
+
+   while (1)
+   {
+      i->previous = 0;
+      i->led = 0;
+      if (!i->next) break;
+      i = i->next;
+   }
+
+   i->next = led_node_free_list;
+   led_node_free_list = first;
+   led_node_pool_used -= count;
+   return;
+}
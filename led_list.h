@@ -1,236 +1,502 @@
-/********************************************************************************
-* led_list.h: Innehller funktionalitet fr implementering av dubbellnkade
-*             listor fr lagring och styrning ver multipla lysdioder eller
-*             andra utportar, realiserat via struktar led_list och led_node
-*             samt associerade funktioner.
-********************************************************************************/
-#ifndef LED_LIST_H_
-#define LED_LIST_H_
-
-/* Inkluderingsdirektiv: */
-#include "misc.h"
-#include "led.h"
-
-/********************************************************************************
-* led_node: Nod fr lagring av en lysdiod i en dubbellnkad lista, med pekare
-*           till fregende samt nsta nod i listan.
-********************************************************************************/
-struct led_node
-{
-   struct led_node* previous; /* Pekare till fregende nod. */
-   struct led_node* next;     /* Pekare till nsta nod. */
-   struct led* led;           /* Pekare till lagrad lysdiod. */
-};
-
-/********************************************************************************
-* led_list: Dubbellnkad lista fr lagring och styrning av lysdiod eller andra 
-*           digitala utportar, implementerade via strukten led.
-********************************************************************************/
-struct led_list
-{
-   struct led_node* first; /* Pekare till frsta lysdioden i listan. */
-   struct led_node* last;  /* Pekare till sista lysdioden i listan. */
-   size_t size;            /* Listans storlek, dvs. antalet lagrade lysdioder. */
-};
-
-/********************************************************************************
-* led_list_init: Initierar angiven lnkad lista till tom vid start.
-*
-*                - self: Pekare till listan som ska initieras.
-********************************************************************************/
-void led_list_init(struct led_list* self);
-
-/********************************************************************************
-* led_list_clear: Tmmer och nollstller angiven lnkad lista.
-*
-*                 - self: Pekare till listan som ska tmmas.
-********************************************************************************/
-void led_list_clear(struct led_list* self);
-
-/********************************************************************************
-* led_list_begin: Returnerar en pekare till den frsta noden i angiven lista.
-*                 Ifall listan r tom returneras null.
-*
-*                 - self: Pekare till listan.
-********************************************************************************/
-struct led_node* led_list_begin(const struct led_list* self);
-
-/********************************************************************************
-* led_list_end: Returnerar en pekare till adressen direkt efter den sista
-*               befintliga noden i angiven lista. Ifall listan r tom
-*               returneras null.
-*
-*                - self: Pekare till listan.
-********************************************************************************/
-struct led_node* led_list_end(const struct led_list* self);
-
-/********************************************************************************
-* led_list_last: Returnerar en pekare till den sista befintliga noden i angiven
-*                lista. Ifall listan r tom returneras null.
-*
-*                - self: Pekare till listan.
-********************************************************************************/
-struct led_node* led_list_last(const struct led_list* self);
-
-/********************************************************************************
-* led_list_at: Returnerar en pekare till nod p angivet index. Ifall ett index
-*              utanfr listans omfng passeras s returneras null.
-*
-*              - self : Pekare till listan.
-*              - index: Index till noden vars adress ska returneras.
-********************************************************************************/
-struct led_node* led_list_at(const struct led_list* self, 
-                        const size_t index);
-
-/********************************************************************************
-* led_list_set: Lagrar adressen till angiven lysdiode p angivet index.
-*               Ifall ett index utanfr listans befintliga omfng passeras s
-*               returneras felkod 1, annars returneras 0.
-*
-*              - self : Pekare till listan.
-*              - index: Index dr adressen till angiven lysdiod ska lagras.
-*              - led  : Pekare (adressen) till lysdioden som ska lggas till.
-********************************************************************************/
-int led_list_set(struct led_list* self,
-                 const size_t index,
-                 struct led* led);
-
-/********************************************************************************
-* led_list_resize: ndrar storleken p angiven lista s att den efter 
-*                  omallokering rymmer angivet antal lysdioder, som kan
-*                  tilldelas direkt via index i stllet fr en push-operation.
-*                  Vid misslyckad minnesallokering returneras felkod 1.
-*                  Annars om omallokeringen lyckas s returneras 0.
-*
-*                  - self    : Pekare till listan vars storlek ska ndras.
-*                  - new_size: Listans nya storlek.
-********************************************************************************/
-int led_list_resize(struct led_list* self,
-                    const size_t new_size);
-
-/********************************************************************************
-* led_list_push_front: Lgger till en ny lysdiod lngst fram i angiven
-*                      lista. Vid misslyckad minnesallokering returneras felkod 1.
-*                      Annars om push-operationen lyckas returneras 0.
-*
-*                      - self   : Pekare till listan som ska tilldelas.
-*                      - new_led: Den nya lysdiod som ska lggas till.
-********************************************************************************/
-int led_list_push_front(struct led_list* self,
-                        struct led* new_led);
-
-/********************************************************************************
-* led_list_push_back: Lgger till en ny lysdiod  lngst bak i angiven lista.
-*                     Vid misslyckad minnesallokering returneras felkod 1.
-*                     Annars om push-operationen lyckas returneras 0.
-*
-*                     - self   : Pekare till listan som ska tilldelas.
-*                     - new_led: Den nya lysdiod som ska lggas till.
-********************************************************************************/
-int led_list_push_back(struct led_list* self,
-                       struct led* new_led);
-
-/********************************************************************************
-* led_list_pop_front: Tar bort eventuellt frsta lysdiod i angiven lista.
-*
-*                     - self: Pekare till listan.
-********************************************************************************/
-void led_list_pop_front(struct led_list* self);
-
-/********************************************************************************
-* led_list_pop_back: Tar bort eventuellt sista lysdiod i angiven lista. 
-*
-*                    - self: Pekare till listan.
-********************************************************************************/
-void led_list_pop_back(struct led_list* self);
-
-/********************************************************************************
-* led_list_insert_at: Lgger in en ny lysdiod p angivet index i en lnkad lista
-*                     och flyttar bak efterfljande lysdioder ett steg. 
-*
-*                     Ifall angivet index inte ligger inom listans omgng eller 
-*                     om minnesallokeringen misslyckas s returneras felkod 1, 
-*                     annars returneras 0.
-*
-*                     - self : Pekare till listan.
-*                     - index: Index dr den nya lysdioden ska lagras.
-*                     - led  : Pekare till lysdioden som ska lagras.
-********************************************************************************/
-int led_list_insert_at(struct led_list* self,
-                       const size_t index,
-                       struct led* led);
-
-/********************************************************************************
-* led_list_remove_at: Tar bort lysdiod p angivet index i en lnkad lista oh
-*                     flyttar fram efterfljande lysdioder ett steg.
-*
-*                     Ifall angivet index inte ligger inom listans omgng s 
-*                     returneras felkod 1, annars returneras 0.
-*
-*                     - self : Pekare till listan.
-*                     - index: Index till lysdioden som ska tas bort ur listan.
-********************************************************************************/
-int led_list_remove_at(struct led_list* self,
-                       const size_t index);
-
-/********************************************************************************
-* led_list_on: Tnder samtliga lysdioder lagrade i angiven lista.
-*
-*              - self: Pekare till listan vars lysdioder ska tndas.
-********************************************************************************/
-void led_list_on(struct led_list* self);
-
-
-/********************************************************************************
-* led_list_off: Slcker samtliga lysdioder lagrade i angiven lista.
-*
-*               - self: Pekare till listan vars lysdioder ska slckas.
-********************************************************************************/
-void led_list_off(struct led_list* self);
-
-/********************************************************************************
-* led_list_toggle: Togglar samtliga lysdioder lagrade i angiven lista.
-*
-*                  - self: Pekare till listan vars lysdioder ska togglas.
-********************************************************************************/
-void led_list_toggle(struct led_list* self);
-
-/********************************************************************************
-* led_list_blink_collectively: Genomfr kollektiv (synkroniserad) blinkning
-*                              av samtliga lysdioder lagrade i angiven lista.
-*
-*                              - self          : Pekare till listan vars
-*                                                lysdioder ska blinkas.
-*                              - blink_speed_ms: Lysdiodernas blinkhastighet
-*                                                mtt i millisekunder.
-********************************************************************************/
-void led_list_blink_colletively(struct led_list* self,
-                                const uint16_t blink_speed_ms);
-
-/********************************************************************************
-* led_list_blink_forward: Genomfr sekventiell blinkning framt av samtliga
-*                         lysdioder lagrade i angiven lista. Drmed blinkar
-*                         lysdioderna framt i en sekvens en efter en.
-*
-*                         - self          : Pekare till listan vars lysdioder
-*                                           ska blinkas.
-*                         - blink_speed_ms: Lysdiodernas blinkhastighet
-*                                           mtt i millisekunder.
-********************************************************************************/
-void led_list_blink_forward(struct led_list* self,
-                            const uint16_t blink_speed_ms);
-
-/********************************************************************************
-* led_list_blink_backward: Genomfr sekventiell blinkning bakt av samtliga
-*                          lysdioder lagrade i angiven lista. Drmed blinkar
-*                          lysdioderna bakt i en sekvens en efter en.
-*
-*                          - self          : Pekare till listan vars lysdioder
-*                                            ska blinkas.
-*                          - blink_speed_ms: Lysdiodernas blinkhastighet
-*                                            mtt i millisekunder.
-********************************************************************************/
-void led_list_blink_backward(struct led_list* self,
-                             const uint16_t blink_speed_ms);
-
+/********************************************************************************
+* led_list.h: Innehåller funktionalitet för implementering av dubbellänkade
+*             listor för lagring och styrning över multipla lysdioder eller
+*             andra utportar, realiserat via struktar led_list och led_node
+*             samt associerade funktioner.
+********************************************************************************/
+#ifndef LED_LIST_H_
+#define LED_LIST_H_
+
+/* Inkluderingsdirektiv: */
+#include "misc.h"
+#include "led.h"
+#include "led_blink.h"
+
+/* Antalet noder i den statiska nodpoolen (kan ändras vid kompilering): */
+#ifndef LED_LIST_POOL_SIZE
+#define LED_LIST_POOL_SIZE 32
+#endif
+
+/********************************************************************************
+* led_node: Nod för lagring av en lysdiod i en dubbellänkad lista, med pekare
+*           till föregående samt nästa nod i listan.
+********************************************************************************/
+struct led_node
+{
+   struct led_node* previous; /* Pekare till föregående nod. */
+   struct led_node* next;     /* Pekare till nästa nod. */
+   struct led* led;           /* Pekare till lagrad lysdiod. */
+};
+
+/********************************************************************************
+* led_list: Dubbellänkad lista för lagring och styrning av lysdiod eller andra 
+*           digitala utportar, implementerade via strukten led.
+*
+*           För gruppoperationer (led_list_on, led_list_off samt 
+*           led_list_toggle) cachas en bitmask per I/O-port med samtliga
+*           lysdioder i listan, så att samtliga lysdioder på samma port
+*           ställs om med en enda skrivning. Masken byggs om vid behov efter
+*           att listan har modifierats. Om en lagrad lysdiod initieras om
+*           till en annan pin medan den ligger i listan måste detta dock
+*           meddelas via led_list_invalidate_masks. Består listan enbart av
+*           lysdioder på I/O-port B, C och D stegas noderna inte igenom,
+*           varvid gruppoperationerna sker i konstant tid. Respektive
+*           lysdiods tillstånd läses då från porten via led_is_enabled.
+*           Listor med skiftregisterutgångar eller matrisceller stegas
+*           igenom för att uppdatera dessa.
+*
+*           Senast åtkomna nod via index cachas tillsammans med sitt index,
+*           så att åtkomst av närliggande index (exempelvis i en loop) kan
+*           ske utan att listan genomsöks från början. Cachen hålls giltig
+*           vid insättning och borttagning.
+********************************************************************************/
+struct led_list
+{
+   struct led_node* first;               /* Pekare till första lysdioden i listan. */
+   struct led_node* last;                /* Pekare till sista lysdioden i listan. */
+   size_t size;                          /* Listans storlek, dvs. antalet lagrade lysdioder. */
+   uint8_t port_masks[IO_PORT_NONE];     /* Bitmask för lysdioderna på I/O-port B, C och D. */
+   bool port_masks_valid;                /* Indikerar ifall bitmaskerna är aktuella. */
+   bool shift_register_leds;             /* Indikerar ifall listan innehåller skiftregisterutgångar. */
+   bool matrix_leds;                     /* Indikerar ifall listan innehåller matrisceller. */
+   struct led_node* cursor;              /* Senast åtkomna nod via index (eller null). */
+   size_t cursor_index;                  /* Index för senast åtkomna nod. */
+
+   struct led_blink blink;               /* Blinkmotor för icke-blockerande blinkning. */
+   struct led_node* blink_node;          /* Aktuell nod vid sekventiell blinkning. */
+};
+
+/********************************************************************************
+* led_node_pool_stats: Strukt för statistik över den statiska nodpool som
+*                      samtliga listor allokerar sina noder från. Används
+*                      för att dimensionera LED_LIST_POOL_SIZE.
+********************************************************************************/
+struct led_node_pool_stats
+{
+   size_t capacity;        /* Nodpoolens kapacitet, dvs. LED_LIST_POOL_SIZE. */
+   size_t num_free;        /* Antalet lediga noder i nodpoolen. */
+   size_t num_used;        /* Antalet noder som för tillfället används. */
+   size_t high_water_mark; /* Högsta antalet samtidigt använda noder. */
+   uint32_t allocations;   /* Totalt antal nodallokeringar sedan start. */
+};
+
+/********************************************************************************
+* led_list_init: Initierar angiven länkad lista till tom vid start.
+*
+*                - self: Pekare till listan som ska initieras.
+********************************************************************************/
+void led_list_init(struct led_list* self);
+
+/********************************************************************************
+* led_list_clear: Tömmer och nollställer angiven länkad lista.
+*
+*                 - self: Pekare till listan som ska tömmas.
+********************************************************************************/
+void led_list_clear(struct led_list* self);
+
+/********************************************************************************
+* led_list_begin: Returnerar en pekare till den första noden i angiven lista.
+*                 Ifall listan är tom returneras null.
+*
+*                 - self: Pekare till listan.
+********************************************************************************/
+struct led_node* led_list_begin(const struct led_list* self);
+
+/********************************************************************************
+* led_list_end: Returnerar en pekare till adressen direkt efter den sista
+*               befintliga noden i angiven lista. Ifall listan är tom
+*               returneras null.
+*
+*                - self: Pekare till listan.
+********************************************************************************/
+struct led_node* led_list_end(const struct led_list* self);
+
+/********************************************************************************
+* led_list_last: Returnerar en pekare till den sista befintliga noden i angiven
+*                lista. Ifall listan är tom returneras null.
+*
+*                - self: Pekare till listan.
+********************************************************************************/
+struct led_node* led_list_last(const struct led_list* self);
+
+/********************************************************************************
+* led_list_at: Returnerar en pekare till nod på angivet index. Ifall ett index
+*              utanför listans omfång passeras så returneras null.
+*
+*              Sökningen startar från den av listans början, slut eller
+*              senast åtkomna nod som ligger närmast angivet index, vilket
+*              medför att följdriktig åtkomst samt åtkomst nära listans
+*              slut sker i konstant tid.
+*
+*              - self : Pekare till listan.
+*              - index: Index till noden vars adress ska returneras.
+********************************************************************************/
+struct led_node* led_list_at(struct led_list* self, 
+                             const size_t index);
+
+/********************************************************************************
+* led_list_set: Lagrar adressen till angiven lysdiode på angivet index.
+*               Ifall ett index utanför listans befintliga omfång passeras så
+*               returneras felkod 1, annars returneras 0.
+*
+*              - self : Pekare till listan.
+*              - index: Index där adressen till angiven lysdiod ska lagras.
+*              - led  : Pekare (adressen) till lysdioden som ska läggas till.
+********************************************************************************/
+int led_list_set(struct led_list* self,
+                 const size_t index,
+                 struct led* led);
+
+/********************************************************************************
+* led_list_resize: Ändrar storleken på angiven lista så att den efter 
+*                  omallokering rymmer angivet antal lysdioder, som kan
+*                  tilldelas direkt via index i stället för en push-operation.
+*                  Nya noder lagrar null och reserveras samt länkas in i ett
+*                  svep, överskjutande noder återlämnas i ett svep. Om
+*                  nodpoolen saknar plats lämnas listan orörd och felkod 1
+*                  returneras. Annars om omallokeringen lyckas så returneras 0.
+*
+*                  - self    : Pekare till listan vars storlek ska ändras.
+*                  - new_size: Listans nya storlek.
+********************************************************************************/
+int led_list_resize(struct led_list* self,
+                    const size_t new_size);
+
+/********************************************************************************
+* led_list_push_front: Lägger till en ny lysdiod längst fram i angiven
+*                      lista. Vid misslyckad minnesallokering returneras felkod 1.
+*                      Annars om push-operationen lyckas returneras 0.
+*
+*                      - self   : Pekare till listan som ska tilldelas.
+*                      - new_led: Den nya lysdiod som ska läggas till.
+********************************************************************************/
+int led_list_push_front(struct led_list* self,
+                        struct led* new_led);
+
+/********************************************************************************
+* led_list_push_back: Lägger till en ny lysdiod  längst bak i angiven lista.
+*                     Vid misslyckad minnesallokering returneras felkod 1.
+*                     Annars om push-operationen lyckas returneras 0.
+*
+*                     - self   : Pekare till listan som ska tilldelas.
+*                     - new_led: Den nya lysdiod som ska läggas till.
+********************************************************************************/
+int led_list_push_back(struct led_list* self,
+                       struct led* new_led);
+
+/********************************************************************************
+* led_list_pop_front: Tar bort eventuellt första lysdiod i angiven lista.
+*
+*                     - self: Pekare till listan.
+********************************************************************************/
+void led_list_pop_front(struct led_list* self);
+
+/********************************************************************************
+* led_list_pop_back: Tar bort eventuellt sista lysdiod i angiven lista. 
+*
+*                    - self: Pekare till listan.
+********************************************************************************/
+void led_list_pop_back(struct led_list* self);
+
+/********************************************************************************
+* led_list_insert_at: Lägger in en ny lysdiod på angivet index i en länkad lista
+*                     och flyttar bak efterföljande lysdioder ett steg. 
+*
+*                     Ifall angivet index inte ligger inom listans omgång eller 
+*                     om minnesallokeringen misslyckas så returneras felkod 1, 
+*                     annars returneras 0.
+*
+*                     - self : Pekare till listan.
+*                     - index: Index där den nya lysdioden ska lagras.
+*                     - led  : Pekare till lysdioden som ska lagras.
+********************************************************************************/
+int led_list_insert_at(struct led_list* self,
+                       const size_t index,
+                       struct led* led);
+
+/********************************************************************************
+* led_list_remove_at: Tar bort lysdiod på angivet index i en länkad lista oh
+*                     flyttar fram efterföljande lysdioder ett steg.
+*
+*                     Ifall angivet index inte ligger inom listans omgång så 
+*                     returneras felkod 1, annars returneras 0.
+*
+*                     - self : Pekare till listan.
+*                     - index: Index till lysdioden som ska tas bort ur listan.
+********************************************************************************/
+int led_list_remove_at(struct led_list* self,
+                       const size_t index);
+
+/********************************************************************************
+* led_list_assign: Ersätter innehållet i angiven lista med lysdioderna i
+*                  angiven array. Samtliga noder reserveras ur nodpoolen och
+*                  länkas samman i ett svep. Ifall nodpoolen inte rymmer
+*                  samtliga lysdioder lämnas listan orörd och felkod 1
+*                  returneras, annars returneras 0.
+*
+*                  - self : Pekare till listan som ska tilldelas.
+*                  - leds : Array med pekare till lysdioderna (eller null för
+*                           att lagra null i samtliga noder).
+*                  - count: Antalet lysdioder i arrayen.
+********************************************************************************/
+int led_list_assign(struct led_list* self,
+                    struct led* const* leds,
+                    const size_t count);
+
+/********************************************************************************
+* led_list_append_range: Lägger till lysdioderna i angiven array längst bak
+*                        i angiven lista, se led_list_insert_range.
+*
+*                        - self : Pekare till listan som ska tilldelas.
+*                        - leds : Array med pekare till lysdioderna (eller null).
+*                        - count: Antalet lysdioder i arrayen.
+********************************************************************************/
+int led_list_append_range(struct led_list* self,
+                          struct led* const* leds,
+                          const size_t count);
+
+/********************************************************************************
+* led_list_insert_range: Lägger in lysdioderna i angiven array med start på
+*                        angivet index och flyttar bak efterföljande
+*                        lysdioder motsvarande antal steg. Samtliga noder
+*                        reserveras ur nodpoolen och länkas samman i ett svep,
+*                        varefter kedjan länkas in i listan i konstant tid.
+*
+*                        Ifall index ligger utanför listans omfång (index
+*                        lika med listans storlek innebär tillägg längst bak)
+*                        eller om nodpoolen inte rymmer samtliga lysdioder
+*                        lämnas listan orörd och felkod 1 returneras, annars
+*                        returneras 0.
+*
+*                        - self : Pekare till listan.
+*                        - index: Index där den första lysdioden ska lagras.
+*                        - leds : Array med pekare till lysdioderna (eller null
+*                                 för att lagra null i samtliga noder).
+*                        - count: Antalet lysdioder i arrayen.
+********************************************************************************/
+int led_list_insert_range(struct led_list* self,
+                          const size_t index,
+                          struct led* const* leds,
+                          const size_t count);
+
+/********************************************************************************
+* led_list_remove_range: Tar bort angivet antal lysdioder med start på
+*                        angivet index och flyttar fram efterföljande
+*                        lysdioder. Segmentet länkas ur i konstant tid och
+*                        dess noder återlämnas till nodpoolen i ett svep.
+*
+*                        Ifall segmentet inte ryms inom listans omfång
+*                        returneras felkod 1, annars returneras 0.
+*
+*                        - self : Pekare till listan.
+*                        - index: Index till den första lysdioden som ska
+*                                 tas bort.
+*                        - count: Antalet lysdioder som ska tas bort.
+********************************************************************************/
+int led_list_remove_range(struct led_list* self,
+                          const size_t index,
+                          const size_t count);
+
+/********************************************************************************
+* led_list_splice: Flyttar nodsegmentet first - last från listan other till
+*                  positionen före angiven nod i angiven lista, utan någon
+*                  allokering. Noderna länkas om via sina pekare, varför
+*                  förflyttningen i sig sker i konstant tid. Segmentet
+*                  stegas dock igenom en gång för att uppdatera listornas
+*                  storlek samt, inom samma lista, kontrollera att
+*                  positionen inte ligger inom segmentet, vilket ger
+*                  tidskomplexitet O(k) för k flyttade noder.
+*
+*                  Ifall segmentet saknas eller om positionen ligger inom
+*                  segmentet returneras felkod 1, annars returneras 0.
+*
+*                  - self    : Pekare till listan som segmentet flyttas till.
+*                  - position: Nod som segmentet ska placeras före (eller null
+*                              för att placera segmentet längst bak).
+*                  - other   : Pekare till listan som segmentet flyttas från
+*                              (kan vara samma som self).
+*                  - first   : Första noden i segmentet.
+*                  - last    : Sista noden i segmentet.
+********************************************************************************/
+int led_list_splice(struct led_list* self,
+                    struct led_node* position,
+                    struct led_list* other,
+                    struct led_node* first,
+                    struct led_node* last);
+
+/********************************************************************************
+* led_list_split: Delar angiven lista vid angiven nod, så att noden samt
+*                 samtliga efterföljande noder flyttas till slutet av listan
+*                 tail, utan någon allokering. Svansen stegas igenom en gång
+*                 för att uppdatera listornas storlek, vilket ger
+*                 tidskomplexitet O(k) för k flyttade noder.
+*
+*                 Ifall noden saknas eller om listorna är desamma returneras
+*                 felkod 1, annars returneras 0.
+*
+*                 - self: Pekare till listan som ska delas.
+*                 - node: Första noden som ska flyttas till listan tail.
+*                 - tail: Pekare till listan som svansen läggs till i.
+********************************************************************************/
+int led_list_split(struct led_list* self,
+                   struct led_node* node,
+                   struct led_list* tail);
+
+/********************************************************************************
+* led_list_concat: Flyttar samtliga noder i listan other till slutet av
+*                  angiven lista i konstant tid, utan någon allokering.
+*                  Listan other är därefter tom.
+*
+*                  - self : Pekare till listan som ska utökas.
+*                  - other: Pekare till listan vars noder ska flyttas.
+********************************************************************************/
+void led_list_concat(struct led_list* self,
+                     struct led_list* other);
+
+/********************************************************************************
+* led_list_reverse: Vänder på ordningen av noderna i angiven lista på plats
+*                   genom att byta varje nods pekare till föregående samt
+*                   nästa nod, utan någon allokering.
+*
+*                   - self: Pekare till listan som ska vändas.
+********************************************************************************/
+void led_list_reverse(struct led_list* self);
+
+/********************************************************************************
+* led_list_invalidate_masks: Markerar listans cachade portmasker som inaktuella,
+*                            så att de byggs om vid nästa gruppoperation.
+*                            Behöver endast anropas ifall en lagrad lysdiod
+*                            har initierats om medan den ligger i listan.
+*
+*                            - self: Pekare till listan.
+********************************************************************************/
+void led_list_invalidate_masks(struct led_list* self);
+
+/********************************************************************************
+* led_list_on: Tänder samtliga lysdioder lagrade i angiven lista. Lysdioder
+*              på samma I/O-port tänds samtidigt via en skrivning per port.
+*
+*              - self: Pekare till listan vars lysdioder ska tändas.
+********************************************************************************/
+void led_list_on(struct led_list* self);
+
+
+/********************************************************************************
+* led_list_off: Släcker samtliga lysdioder lagrade i angiven lista. Lysdioder
+*               på samma I/O-port släcks samtidigt via en skrivning per port.
+*
+*               - self: Pekare till listan vars lysdioder ska släckas.
+********************************************************************************/
+void led_list_off(struct led_list* self);
+
+/********************************************************************************
+* led_list_toggle: Togglar samtliga lysdioder lagrade i angiven lista.
+*                  Lysdioder på samma I/O-port togglas samtidigt via en
+*                  skrivning per port till registret PINx, vilket är
+*                  atomärt gentemot avbrott. En lysdiod som förekommer
+*                  flera gånger i listan togglas endast en gång.
+*
+*                  - self: Pekare till listan vars lysdioder ska togglas.
+********************************************************************************/
+void led_list_toggle(struct led_list* self);
+
+/********************************************************************************
+* led_list_blink_collectively: Genomför kollektiv (synkroniserad) blinkning
+*                              av samtliga lysdioder lagrade i angiven lista.
+*
+*                              - self          : Pekare till listan vars
+*                                                lysdioder ska blinkas.
+*                              - blink_speed_ms: Lysdiodernas blinkhastighet
+*                                                mätt i millisekunder.
+*
+*                              Funktionen är blockerande, se
+*                              led_list_blink_start för motsvarande
+*                              icke-blockerande blinkning.
+********************************************************************************/
+void led_list_blink_colletively(struct led_list* self,
+                                const uint16_t blink_speed_ms);
+
+/********************************************************************************
+* led_list_blink_forward: Genomför sekventiell blinkning framåt av samtliga
+*                         lysdioder lagrade i angiven lista. Därmed blinkar
+*                         lysdioderna framåt i en sekvens en efter en.
+*
+*                         - self          : Pekare till listan vars lysdioder
+*                                           ska blinkas.
+*                         - blink_speed_ms: Lysdiodernas blinkhastighet
+*                                           mätt i millisekunder.
+*
+*                         Funktionen är blockerande, se led_list_blink_start
+*                         för motsvarande icke-blockerande blinkning.
+********************************************************************************/
+void led_list_blink_forward(struct led_list* self,
+                            const uint16_t blink_speed_ms);
+
+/********************************************************************************
+* led_list_blink_backward: Genomför sekventiell blinkning bakåt av samtliga
+*                          lysdioder lagrade i angiven lista. Därmed blinkar
+*                          lysdioderna bakåt i en sekvens en efter en.
+*
+*                          - self          : Pekare till listan vars lysdioder
+*                                            ska blinkas.
+*                          - blink_speed_ms: Lysdiodernas blinkhastighet
+*                                            mätt i millisekunder.
+*
+*                          Funktionen är blockerande, se led_list_blink_start
+*                          för motsvarande icke-blockerande blinkning.
+********************************************************************************/
+void led_list_blink_backward(struct led_list* self,
+                             const uint16_t blink_speed_ms);
+
+/********************************************************************************
+* led_list_blink_start: Startar icke-blockerande blinkning av lysdioderna i
+*                       angiven lista enligt angivet blinkmönster. Funktionen
+*                       returnerar direkt, varefter blinkningen drivs vidare
+*                       från systemticken (Timer 0) en gång per millisekund.
+*                       Eventuell pågående blinkning av listan ersätts.
+*
+*                       Under pågående blinkning får listan ändras via
+*                       listans funktioner för insättning, borttagning,
+*                       tilldelning, flytt samt omvändning av noder, vilka
+*                       spärrar blinkmotorn medan listan ändras. Tas den
+*                       aktuella blinknoden bort eller flyttas till en
+*                       annan lista börjar blinkmönstret om från listans
+*                       början respektive slut.
+*
+*                       Blinkmönstrets steg genomförs från avbrottsrutinen
+*                       för Timer 0 (se led_blink.h), som då stegar igenom
+*                       listan utan annat skydd än blinkmotorns spärr.
+*                       Medan blinkning pågår får listan därför inte ändras
+*                       på annat sätt, exempelvis via nodernas pekare eller
+*                       från en annan avbrottsrutin, utan blinkningen ska
+*                       då först stoppas via led_list_blink_stop.
+*
+*                       Ifall systemticken saknar ledig plats för
+*                       blinkmotorn returneras felkod 1, annars returneras 0.
+*
+*                       - self          : Pekare till listan vars lysdioder
+*                                         ska blinkas.
+*                       - mode          : Blinkmönster som ska användas.
+*                       - blink_speed_ms: Lysdiodernas blinkhastighet
+*                                         mätt i millisekunder.
+********************************************************************************/
+int led_list_blink_start(struct led_list* self,
+                         const enum led_list_blink_mode mode,
+                         const uint16_t blink_speed_ms);
+
+/********************************************************************************
+* led_list_blink_stop: Stoppar eventuell pågående icke-blockerande blinkning
+*                      av angiven lista och släcker samtliga lysdioder.
+*
+*                      - self: Pekare till listan vars blinkning ska stoppas.
+********************************************************************************/
+void led_list_blink_stop(struct led_list* self);
+
+/********************************************************************************
+* led_node_pool_get_stats: Läser av aktuell statistik för nodpoolen.
+*
+*                          - stats: Pekare till strukt där statistiken lagras.
+********************************************************************************/
+void led_node_pool_get_stats(struct led_node_pool_stats* stats);
+
 #endif /* LED_LIST_H_ */
\ No newline at end of file
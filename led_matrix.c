@@ -0,0 +1,361 @@
+/********************************************************************************
+* led_matrix.c: Innehåller funktionsdefinitioner för multiplexad styrning av
+*               en lysdiodmatris samt avbrottsrutin för Timer 2.
+********************************************************************************/
+#include "led_matrix.h"
+#include "led.h"
+
+/* Statiska variabler: */
+static struct led_matrix* volatile led_matrix_active = 0; /* Matris som drivs av Timer 2. */
+static struct led_matrix* led_matrix_instance = 0;        /* Matris för led_init_matrix. */
+
+/* Statiska funktioner: */
+static void led_matrix_port_set(const uint8_t io_port,
+                                const uint8_t mask);
+static void led_matrix_port_clear(const uint8_t io_port,
+                                  const uint8_t mask);
+
+/********************************************************************************
+* led_matrix_init: Initierar angiven matris med angivna rad- och
+*                  kolumnpinnar, varefter samtliga celler är släckta.
+*                  Matrisen blir därmed den som adresseras av lysdioder
+*                  initierade via led_init_matrix. Ifall antalet rader eller
+*                  kolumner är 0 eller överstiger 8, eller någon pin saknas
+*                  på Arduino Uno, returneras felkod 1, annars returneras 0.
+*
+*                  - self       : Pekare till matrisen som ska initieras.
+*                  - row_pins   : Pin-nummer för respektive rad.
+*                  - num_rows   : Antalet rader.
+*                  - column_pins: Pin-nummer för respektive kolumn.
+*                  - num_columns: Antalet kolumner.
+********************************************************************************/
+int led_matrix_init(struct led_matrix* self,
+                    const uint8_t* row_pins,
+                    const uint8_t num_rows,
+                    const uint8_t* column_pins,
+                    const uint8_t num_columns)
+{
+   if (num_rows == 0 || num_rows > LED_MATRIX_MAX_ROWS) return 1;
+   if (num_columns == 0 || num_columns > LED_MATRIX_MAX_COLUMNS) return 1;
+
+   for (uint8_t i = 0; i < num_rows; ++i)
+   {
+      if (PIN_IO_PORT(row_pins[i]) == IO_PORT_NONE) return 1;
+   }
+
+   for (uint8_t i = 0; i < num_columns; ++i)
+   {
+      if (PIN_IO_PORT(column_pins[i]) == IO_PORT_NONE) return 1;
+   }
+
+   led_matrix_stop(self);
+   self->num_rows = num_rows;
+   self->num_columns = num_columns;
+   self->row = num_rows - 1;
+
+   for (uint8_t port = 0; port < IO_PORT_NONE; ++port)
+   {
+      self->port_masks[port] = 0;
+   }
+
+   for (uint8_t i = 0; i < num_rows; ++i)
+   {
+      self->row_ports[i] = PIN_IO_PORT(row_pins[i]);
+      self->row_masks[i] = PIN_MASK(row_pins[i]);
+      led_pin_write(row_pins[i], LED_PIN_OFF);
+      led_pin_write(row_pins[i], LED_PIN_INIT);
+   }
+
+   for (uint8_t i = 0; i < num_columns; ++i)
+   {
+      self->column_ports[i] = PIN_IO_PORT(column_pins[i]);
+      self->column_masks[i] = PIN_MASK(column_pins[i]);
+      self->port_masks[self->column_ports[i]] |= self->column_masks[i];
+      led_pin_write(column_pins[i], LED_PIN_ON);
+      led_pin_write(column_pins[i], LED_PIN_INIT);
+   }
+
+   led_matrix_clear(self);
+   led_matrix_instance = self;
+   return 0;
+}
+
+/********************************************************************************
+* led_matrix_set: Tänder eller släcker angiven cell. Celler utanför matrisen
+*                 ignoreras.
+*
+*                 - self   : Pekare till matrisen.
+*                 - row    : Cellens rad.
+*                 - column : Cellens kolumn.
+*                 - enabled: Indikerar ifall cellen ska tändas.
+********************************************************************************/
+void led_matrix_set(struct led_matrix* self,
+                    const uint8_t row,
+                    const uint8_t column,
+                    const bool enabled)
+{
+   if (row >= self->num_rows || column >= self->num_columns) return;
+   const uint8_t port = self->column_ports[column];
+   const uint8_t mask = self->column_masks[column];
+
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      if (enabled)
+      {
+         self->frame[row] |= (1 << column);
+         self->lit_masks[row][port] |= mask;
+      }
+      else
+      {
+         self->frame[row] &= ~(1 << column);
+         self->lit_masks[row][port] &= ~mask;
+      }
+   }
+
+   return;
+}
+
+/********************************************************************************
+* led_matrix_toggle: Togglar angiven cell. Celler utanför matrisen ignoreras.
+*
+*                    - self  : Pekare till matrisen.
+*                    - row   : Cellens rad.
+*                    - column: Cellens kolumn.
+********************************************************************************/
+void led_matrix_toggle(struct led_matrix* self,
+                       const uint8_t row,
+                       const uint8_t column)
+{
+   if (row >= self->num_rows || column >= self->num_columns) return;
+
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      self->frame[row] ^= (1 << column);
+      self->lit_masks[row][self->column_ports[column]] ^= self->column_masks[column];
+   }
+
+   return;
+}
+
+/********************************************************************************
+* led_matrix_get: Indikerar ifall angiven cell är tänd.
+*
+*                 - self  : Pekare till matrisen.
+*                 - row   : Cellens rad.
+*                 - column: Cellens kolumn.
+********************************************************************************/
+bool led_matrix_get(const struct led_matrix* self,
+                    const uint8_t row,
+                    const uint8_t column)
+{
+   if (row >= self->num_rows || column >= self->num_columns) return false;
+   return self->frame[row] & (1 << column);
+}
+
+/********************************************************************************
+* led_matrix_set_frame: Ersätter hela bilden, där bit c i rows[r] anger
+*                       cellen på rad r och kolumn c. Kolumnmaskerna
+*                       beräknas först, varefter samtliga rader byts atomärt
+*                       gentemot avbrottsrutinen.
+*
+*                       - self: Pekare till matrisen.
+*                       - rows: En byte per rad i matrisen.
+********************************************************************************/
+void led_matrix_set_frame(struct led_matrix* self,
+                          const uint8_t* rows)
+{
+   uint8_t lit_masks[LED_MATRIX_MAX_ROWS][IO_PORT_NONE] = { { 0 } };
+   const uint8_t columns = (uint8_t)((1 << self->num_columns) - 1);
+
+   for (uint8_t row = 0; row < self->num_rows; ++row)
+   {
+      for (uint8_t column = 0; column < self->num_columns; ++column)
+      {
+         if (rows[row] & (1 << column))
+         {
+            lit_masks[row][self->column_ports[column]] |= self->column_masks[column];
+         }
+      }
+   }
+
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      for (uint8_t row = 0; row < self->num_rows; ++row)
+      {
+         self->frame[row] = rows[row] & columns;
+
+         for (uint8_t port = 0; port < IO_PORT_NONE; ++port)
+         {
+            self->lit_masks[row][port] = lit_masks[row][port];
+         }
+      }
+   }
+
+   return;
+}
+
+/********************************************************************************
+* led_matrix_clear: Släcker samtliga celler.
+*
+*                   - self: Pekare till matrisen.
+********************************************************************************/
+void led_matrix_clear(struct led_matrix* self)
+{
+   static const uint8_t rows[LED_MATRIX_MAX_ROWS] = { 0 };
+   led_matrix_set_frame(self, rows);
+   return;
+}
+
+/********************************************************************************
+* led_matrix_start: Startar multiplexningen via Timer 2 i CTC-mode med
+*                   prescaler 64 samt aktiverar avbrott globalt. Eventuell
+*                   annan aktiv matris ersätts.
+*
+*                   - self: Pekare till matrisen som ska aktiveras.
+********************************************************************************/
+void led_matrix_start(struct led_matrix* self)
+{
+   struct led_matrix* previous = led_matrix_active;
+   if (previous && previous != self) led_matrix_stop(previous);
+
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      led_matrix_active = self;
+      self->row = self->num_rows - 1;
+      REG_WRITE(TCCR2A, 1 << WGM21);
+      REG_WRITE(TCNT2, 0);
+      REG_WRITE(OCR2A, LED_MATRIX_TIMER_TOP);
+      REG_WRITE(TCCR2B, 1 << CS22);
+      REG_SET(TIMSK2, 1 << OCIE2A);
+   }
+
+   sei();
+   return;
+}
+
+/********************************************************************************
+* led_matrix_stop: Stoppar multiplexningen och släcker aktuell rad. Bilden
+*                  behålls och visas igen vid nästa led_matrix_start.
+*
+*                  - self: Pekare till matrisen som ska stoppas.
+********************************************************************************/
+void led_matrix_stop(struct led_matrix* self)
+{
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      if (led_matrix_active == self)
+      {
+         REG_WRITE(TCCR2B, 0);
+         REG_CLEAR(TIMSK2, 1 << OCIE2A);
+         led_matrix_active = 0;
+         led_matrix_port_clear(self->row_ports[self->row], self->row_masks[self->row]);
+      }
+   }
+
+   return;
+}
+
+/********************************************************************************
+* led_matrix_cell_write: Tänder eller släcker angiven cell i den matris som
+*                        senast initierades. Används av lysdioder
+*                        initierade via led_init_matrix. Ifall ingen matris
+*                        är initierad eller cellen ligger utanför matrisen
+*                        returneras felkod 1, annars returneras 0.
+*
+*                        - cell   : Cellnummer enligt LED_MATRIX_CELL.
+*                        - enabled: Indikerar ifall cellen ska tändas.
+********************************************************************************/
+int led_matrix_cell_write(const uint8_t cell,
+                          const bool enabled)
+{
+   struct led_matrix* self = led_matrix_instance;
+   const uint8_t row = cell >> 3;
+   const uint8_t column = cell & 0x07;
+
+   if (!self || row >= self->num_rows || column >= self->num_columns) return 1;
+   led_matrix_set(self, row, column, enabled);
+   return 0;
+}
+
+/********************************************************************************
+* led_matrix_cell_toggle: Togglar angiven cell i den matris som senast
+*                         initierades.
+*
+*                         - cell: Cellnummer enligt LED_MATRIX_CELL.
+********************************************************************************/
+void led_matrix_cell_toggle(const uint8_t cell)
+{
+   if (led_matrix_instance)
+   {
+      led_matrix_toggle(led_matrix_instance, cell >> 3, cell & 0x07);
+   }
+
+   return;
+}
+
+/********************************************************************************
+* led_matrix_port_set: Ettställer angivna bitar i PORTx för angiven I/O-port.
+*
+*                      - io_port: I/O-porten.
+*                      - mask   : Bitarna som ska ettställas.
+********************************************************************************/
+static void led_matrix_port_set(const uint8_t io_port,
+                                const uint8_t mask)
+{
+   if (io_port == IO_PORTB) REG_SET(PORTB, mask);
+   else if (io_port == IO_PORTC) REG_SET(PORTC, mask);
+   else if (io_port == IO_PORTD) REG_SET(PORTD, mask);
+   return;
+}
+
+/********************************************************************************
+* led_matrix_port_clear: Nollställer angivna bitar i PORTx för angiven
+*                        I/O-port.
+*
+*                        - io_port: I/O-porten.
+*                        - mask   : Bitarna som ska nollställas.
+********************************************************************************/
+static void led_matrix_port_clear(const uint8_t io_port,
+                                  const uint8_t mask)
+{
+   if (io_port == IO_PORTB) REG_CLEAR(PORTB, mask);
+   else if (io_port == IO_PORTC) REG_CLEAR(PORTC, mask);
+   else if (io_port == IO_PORTD) REG_CLEAR(PORTD, mask);
+   return;
+}
+
+/********************************************************************************
+* ISR (TIMER2_COMPA_vect): Avbrottsrutin som anropas vid varje radbyte.
+*                          Aktuell rad släcks, varefter kolumnerna för nästa
+*                          rad skrivs med en skrivning per I/O-port (låg för
+*                          tända celler) och nästa rad tänds. Raden släcks
+*                          före kolumnbytet, så att föregående rads bild
+*                          aldrig syns på nästa rad (ghosting).
+********************************************************************************/
+ISR (TIMER2_COMPA_vect)
+{
+   struct led_matrix* self = led_matrix_active;
+   if (!self) return;
+
+   const uint8_t row = self->row;
+   const uint8_t next = row + 1 < self->num_rows ? row + 1 : 0;
+   const uint8_t* lit = self->lit_masks[next];
+
+   led_matrix_port_clear(self->row_ports[row], self->row_masks[row]);
+
+   if (self->port_masks[IO_PORTB])
+   {
+      REG_WRITE(PORTB, (REG_READ(PORTB) | self->port_masks[IO_PORTB]) & ~lit[IO_PORTB]);
+   }
+   if (self->port_masks[IO_PORTC])
+   {
+      REG_WRITE(PORTC, (REG_READ(PORTC) | self->port_masks[IO_PORTC]) & ~lit[IO_PORTC]);
+   }
+   if (self->port_masks[IO_PORTD])
+   {
+      REG_WRITE(PORTD, (REG_READ(PORTD) | self->port_masks[IO_PORTD]) & ~lit[IO_PORTD]);
+   }
+
+   led_matrix_port_set(self->row_ports[next], self->row_masks[next]);
+   self->row = next;
+}
@@ -0,0 +1,184 @@
+/********************************************************************************
+* led_matrix.h: Innehåller funktionalitet för multiplexad styrning av en
+*               lysdiodmatris med upp till 8 x 8 lysdioder, realiserat via
+*               strukten led_matrix samt associerade funktioner.
+*
+*               Varje rad och kolumn ansluts till en egen pin, vilket ger
+*               64 lysdioder via 16 pinnar. Raderna tänds en i taget från
+*               avbrottsrutinen för Timer 2, där aktuell rad först släcks,
+*               varefter kolumnerna för nästa rad skrivs via förberäknade
+*               bitmasker med en skrivning per I/O-port och nästa rad tänds.
+*               Avbrottsrutinen tar därmed samma tid oavsett bildens innehåll.
+*
+*               Raderna är aktiva höga (anoder) och kolumnerna aktiva låga
+*               (katoder), dvs. en lysdiod lyser då dess rad är hög och dess
+*               kolumn är låg. Strömbegränsande resistorer placeras på
+*               kolumnerna.
+*
+*               Timer 2 används i CTC-mode med prescaler 64, vilket ger
+*               LED_MATRIX_ROW_RATE_HZ radbyten per sekund. Med standardvärdet
+*               2 kHz uppdateras en matris med 8 rader 250 gånger per sekund.
+*               Endast en matris kan vara aktiv åt gången.
+*
+*               Enskilda celler kan även adresseras som lysdioder via
+*               led_init_matrix (se led.h), så att de kan lagras i exempelvis
+*               en led_list. Sådana lysdioder adresserar den matris som senast
+*               initierades.
+********************************************************************************/
+#ifndef LED_MATRIX_H_
+#define LED_MATRIX_H_
+
+/* Inkluderingsdirektiv: */
+#include "misc.h"
+
+/* Maximalt antal rader samt kolumner: */
+#define LED_MATRIX_MAX_ROWS    8
+#define LED_MATRIX_MAX_COLUMNS 8
+
+/* Antalet radbyten per sekund: */
+#ifndef LED_MATRIX_ROW_RATE_HZ
+#define LED_MATRIX_ROW_RATE_HZ 2000
+#endif
+
+/* Toppvärde för Timer 2 med prescaler 64: */
+#define LED_MATRIX_TIMER_TOP (F_CPU / 64 / LED_MATRIX_ROW_RATE_HZ - 1)
+
+#if LED_MATRIX_TIMER_TOP < 1 || LED_MATRIX_TIMER_TOP > 255
+#error "LED_MATRIX_ROW_RATE_HZ måste ge ett toppvärde mellan 1 och 255 för Timer 2."
+#endif
+
+/* Makro för cellnummer, som lagras i strukten leds pin-fält: */
+#define LED_MATRIX_CELL(row, column) ((uint8_t)(((row) << 3) | (column)))
+
+/********************************************************************************
+* led_matrix: Strukt för multiplexad lysdiodmatris. Bilden lagras både som en
+*             byte per rad (bit c för kolumn c) och som förberäknade
+*             kolumnmasker per rad och I/O-port, vilka läses direkt av
+*             avbrottsrutinen.
+********************************************************************************/
+struct led_matrix
+{
+   uint8_t row_ports[LED_MATRIX_MAX_ROWS];              /* I/O-port per rad. */
+   uint8_t row_masks[LED_MATRIX_MAX_ROWS];              /* Bitmask per rad. */
+   uint8_t column_ports[LED_MATRIX_MAX_COLUMNS];        /* I/O-port per kolumn. */
+   uint8_t column_masks[LED_MATRIX_MAX_COLUMNS];        /* Bitmask per kolumn. */
+   uint8_t port_masks[IO_PORT_NONE];                    /* Samtliga kolumner per I/O-port. */
+   uint8_t lit_masks[LED_MATRIX_MAX_ROWS][IO_PORT_NONE]; /* Tända kolumner per rad och I/O-port. */
+   uint8_t frame[LED_MATRIX_MAX_ROWS];                  /* Tända celler per rad. */
+   uint8_t num_rows;                                    /* Antalet rader. */
+   uint8_t num_columns;                                 /* Antalet kolumner. */
+   volatile uint8_t row;                                /* Rad som för tillfället är tänd. */
+};
+
+/********************************************************************************
+* led_matrix_init: Initierar angiven matris med angivna rad- och
+*                  kolumnpinnar, varefter samtliga celler är släckta.
+*                  Matrisen blir därmed den som adresseras av lysdioder
+*                  initierade via led_init_matrix. Ifall antalet rader eller
+*                  kolumner är 0 eller överstiger 8, eller någon pin saknas
+*                  på Arduino Uno, returneras felkod 1, annars returneras 0.
+*
+*                  - self       : Pekare till matrisen som ska initieras.
+*                  - row_pins   : Pin-nummer för respektive rad.
+*                  - num_rows   : Antalet rader.
+*                  - column_pins: Pin-nummer för respektive kolumn.
+*                  - num_columns: Antalet kolumner.
+********************************************************************************/
+int led_matrix_init(struct led_matrix* self,
+                    const uint8_t* row_pins,
+                    const uint8_t num_rows,
+                    const uint8_t* column_pins,
+                    const uint8_t num_columns);
+
+/********************************************************************************
+* led_matrix_set: Tänder eller släcker angiven cell. Celler utanför matrisen
+*                 ignoreras.
+*
+*                 - self   : Pekare till matrisen.
+*                 - row    : Cellens rad.
+*                 - column : Cellens kolumn.
+*                 - enabled: Indikerar ifall cellen ska tändas.
+********************************************************************************/
+void led_matrix_set(struct led_matrix* self,
+                    const uint8_t row,
+                    const uint8_t column,
+                    const bool enabled);
+
+/********************************************************************************
+* led_matrix_toggle: Togglar angiven cell. Celler utanför matrisen ignoreras.
+*
+*                    - self  : Pekare till matrisen.
+*                    - row   : Cellens rad.
+*                    - column: Cellens kolumn.
+********************************************************************************/
+void led_matrix_toggle(struct led_matrix* self,
+                       const uint8_t row,
+                       const uint8_t column);
+
+/********************************************************************************
+* led_matrix_get: Indikerar ifall angiven cell är tänd.
+*
+*                 - self  : Pekare till matrisen.
+*                 - row   : Cellens rad.
+*                 - column: Cellens kolumn.
+********************************************************************************/
+bool led_matrix_get(const struct led_matrix* self,
+                    const uint8_t row,
+                    const uint8_t column);
+
+/********************************************************************************
+* led_matrix_set_frame: Ersätter hela bilden, där bit c i rows[r] anger
+*                       cellen på rad r och kolumn c. Samtliga rader byts
+*                       atomärt gentemot avbrottsrutinen.
+*
+*                       - self: Pekare till matrisen.
+*                       - rows: En byte per rad i matrisen.
+********************************************************************************/
+void led_matrix_set_frame(struct led_matrix* self,
+                          const uint8_t* rows);
+
+/********************************************************************************
+* led_matrix_clear: Släcker samtliga celler.
+*
+*                   - self: Pekare till matrisen.
+********************************************************************************/
+void led_matrix_clear(struct led_matrix* self);
+
+/********************************************************************************
+* led_matrix_start: Startar multiplexningen via Timer 2 samt aktiverar
+*                   avbrott globalt. Eventuell annan aktiv matris ersätts.
+*
+*                   - self: Pekare till matrisen som ska aktiveras.
+********************************************************************************/
+void led_matrix_start(struct led_matrix* self);
+
+/********************************************************************************
+* led_matrix_stop: Stoppar multiplexningen och släcker aktuell rad. Bilden
+*                  behålls och visas igen vid nästa led_matrix_start.
+*
+*                  - self: Pekare till matrisen som ska stoppas.
+********************************************************************************/
+void led_matrix_stop(struct led_matrix* self);
+
+/********************************************************************************
+* led_matrix_cell_write: Tänder eller släcker angiven cell i den matris som
+*                        senast initierades. Används av lysdioder
+*                        initierade via led_init_matrix. Ifall ingen matris
+*                        är initierad eller cellen ligger utanför matrisen
+*                        returneras felkod 1, annars returneras 0.
+*
+*                        - cell   : Cellnummer enligt LED_MATRIX_CELL.
+*                        - enabled: Indikerar ifall cellen ska tändas.
+********************************************************************************/
+int led_matrix_cell_write(const uint8_t cell,
+                          const bool enabled);
+
+/********************************************************************************
+* led_matrix_cell_toggle: Togglar angiven cell i den matris som senast
+*                         initierades.
+*
+*                         - cell: Cellnummer enligt LED_MATRIX_CELL.
+********************************************************************************/
+void led_matrix_cell_toggle(const uint8_t cell);
+
+#endif /* LED_MATRIX_H_ */
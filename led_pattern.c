@@ -0,0 +1,316 @@
+/********************************************************************************
+* led_pattern.c: Innehåller funktionsdefinitioner för uppspelning av
+*                ljusmönster lagrade i programminnet via strukten
+*                led_pattern.
+********************************************************************************/
+#include "led_pattern.h"
+
+/* Statiska funktioner: */
+static uint16_t led_pattern_read_u16(const struct led_pattern* self,
+                                     const uint16_t address);
+static void led_pattern_show(struct led_pattern* self,
+                             const uint16_t address,
+                             const uint8_t num_masks);
+static int led_pattern_loop(struct led_pattern* self,
+                            const uint16_t pc);
+static void led_pattern_run(struct led_pattern* self);
+static void led_pattern_tick(void);
+
+/* Statiska variabler: */
+static struct led_pattern* led_pattern_chain = 0; /* Mönster som spelas upp via tick. */
+
+/********************************************************************************
+* led_pattern_start: Startar uppspelning av angivet mönsterprogram mot
+*                    lysdioderna i angiven lista. Den första bilden visas
+*                    direkt, varefter uppspelningen drivs från systemticken.
+*                    Eventuell pågående uppspelning ersätts.
+*
+*                    Ifall systemticken saknar ledig plats returneras
+*                    felkod 1, annars returneras 0.
+*
+*                    - self   : Pekare till mönstret.
+*                    - list   : Pekare till listan vars lysdioder ska styras.
+*                    - program: Pekare till mönsterprogrammet i programminnet.
+********************************************************************************/
+int led_pattern_start(struct led_pattern* self,
+                      struct led_list* list,
+                      const uint8_t* program)
+{
+   led_pattern_stop(self);
+   if (timer_attach(led_pattern_tick)) return 1;
+
+   self->list = list;
+   self->program = program;
+   self->pc = 0;
+   self->remaining_ms = 0;
+   self->loop_depth = 0;
+   self->running = true;
+   led_pattern_run(self);
+
+   if (self->running)
+   {
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+      {
+         self->next = led_pattern_chain;
+         led_pattern_chain = self;
+      }
+   }
+   else if (!led_pattern_chain)
+   {
+      timer_detach(led_pattern_tick);
+   }
+
+   return 0;
+}
+
+/********************************************************************************
+* led_pattern_stop: Stoppar eventuell pågående uppspelning av angivet mönster.
+*                   Lysdioderna behåller sitt aktuella tillstånd. Om inget
+*                   mönster längre spelas upp kopplas mönstermotorn bort
+*                   från systemticken.
+*
+*                   - self: Pekare till mönstret vars uppspelning ska stoppas.
+********************************************************************************/
+void led_pattern_stop(struct led_pattern* self)
+{
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      for (struct led_pattern** i = &led_pattern_chain; *i; i = &(*i)->next)
+      {
+         if (*i == self)
+         {
+            *i = self->next;
+            break;
+         }
+      }
+   }
+
+   if (!led_pattern_chain)
+   {
+      timer_detach(led_pattern_tick);
+   }
+
+   self->running = false;
+   self->next = 0;
+   return;
+}
+
+/********************************************************************************
+* led_pattern_is_running: Indikerar ifall uppspelning av angivet mönster
+*                         pågår. Uppspelningen avslutas av sig själv när
+*                         instruktionen LED_PATTERN_END nås.
+*
+*                         - self: Pekare till mönstret.
+********************************************************************************/
+bool led_pattern_is_running(const struct led_pattern* self)
+{
+   bool running;
+
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      running = self->running;
+   }
+
+   return running;
+}
+
+/********************************************************************************
+* led_pattern_read_u16: Läser en 16-bitars operand (little endian) från
+*                       mönsterprogrammet på angiven adress.
+*
+*                       - self   : Pekare till mönstret.
+*                       - address: Adress till operandens första byte.
+********************************************************************************/
+static uint16_t led_pattern_read_u16(const struct led_pattern* self,
+                                     const uint16_t address)
+{
+   return pgm_read_byte(self->program + address) |
+          (pgm_read_byte(self->program + address + 1) << 8);
+}
+
+/********************************************************************************
+* led_pattern_show: Visar en bild genom att tända respektive släcka listans
+*                   lysdioder enligt angivna maskbytes. Bilden visas som en
+*                   egen ram via port_shadow, så att samtliga ändringar
+*                   skrivs med en skrivning per port och hela bilden byts
+*                   samtidigt. Pågår redan en ram skjuts bilden upp till
+*                   dess att den ramen avslutas. Skiftregisterutgångar
+*                   skiftas ut i en skur efter portskrivningarna, medan
+*                   matrisceller skrivs direkt till matrisens bild.
+*
+*                   - self     : Pekare till mönstret.
+*                   - address  : Adress till den första maskbyten.
+*                   - num_masks: Antalet maskbytes.
+********************************************************************************/
+static void led_pattern_show(struct led_pattern* self,
+                             const uint16_t address,
+                             const uint8_t num_masks)
+{
+   uint8_t on_masks[IO_PORT_NONE] = { 0 };
+   uint8_t off_masks[IO_PORT_NONE] = { 0 };
+   uint8_t mask = 0;
+   size_t index = 0;
+   port_shadow_begin();
+
+   for (struct led_node* i = self->list->first; i; i = i->next, ++index)
+   {
+      if ((index & 7) == 0)
+      {
+         mask = (index >> 3) < num_masks ? pgm_read_byte(self->program + address + (index >> 3)) : 0;
+      }
+
+      struct led* led = i->led;
+      if (!led || led->io_port == IO_PORT_NONE) continue;
+
+      led_set_enabled(led, mask & (1 << (index & 7)));
+      if (led->io_port >= IO_PORT_NONE) continue;
+      if (led->enabled) on_masks[led->io_port] |= (1 << led->pin);
+      else off_masks[led->io_port] |= (1 << led->pin);
+   }
+
+   port_shadow_write_masks(off_masks, PORT_SHADOW_CLEAR);
+   port_shadow_write_masks(on_masks, PORT_SHADOW_SET);
+   port_shadow_end();
+   return;
+}
+
+/********************************************************************************
+* led_pattern_loop: Exekverar loopinstruktionen på angiven adress. Loopens
+*                   räknare söks upp bland påbörjade loopar via adressen,
+*                   varvid eventuella räknare ovanför (från loopar som
+*                   lämnats via hopp) tas bort. Saknas räknaren påbörjas en
+*                   ny loop. Så länge antalet genomförda hopp understiger
+*                   angivet antal sker ett hopp, annars tas räknaren bort
+*                   och exekveringen fortsätter efter instruktionen.
+*
+*                   Ifall en ny loop inte får plats returneras felkod 1,
+*                   annars returneras 0.
+*
+*                   - self: Pekare till mönstret.
+*                   - pc  : Adress till loopinstruktionen.
+********************************************************************************/
+static int led_pattern_loop(struct led_pattern* self,
+                            const uint16_t pc)
+{
+   const uint8_t count = pgm_read_byte(self->program + pc + 1);
+   uint8_t level = self->loop_depth;
+
+   while (level > 0 && self->loop_addresses[level - 1] != pc)
+   {
+      level--;
+   }
+
+   if (level > 0)
+   {
+      self->loop_depth = level;
+   }
+   else if (count > 0)
+   {
+      if (self->loop_depth >= LED_PATTERN_MAX_LOOP_DEPTH) return 1;
+      self->loop_addresses[self->loop_depth] = pc;
+      self->loop_counters[self->loop_depth] = 0;
+      self->loop_depth++;
+   }
+   else
+   {
+      self->pc = pc + LED_PATTERN_LOOP_SIZE;
+      return 0;
+   }
+
+   if (self->loop_counters[self->loop_depth - 1] < count)
+   {
+      self->loop_counters[self->loop_depth - 1]++;
+      self->pc = led_pattern_read_u16(self, pc + 2);
+   }
+   else
+   {
+      self->loop_depth--;
+      self->pc = pc + LED_PATTERN_LOOP_SIZE;
+   }
+
+   return 0;
+}
+
+/********************************************************************************
+* led_pattern_run: Exekverar instruktioner i angivet mönster till dess att en
+*                  bild eller fördröjning med tid större än noll påträffas,
+*                  eller uppspelningen avslutas. Ifall fler än
+*                  LED_PATTERN_MAX_STEPS instruktioner exekveras i följd utan
+*                  att någon tid förflyter (exempelvis vid en ändlös loop av
+*                  hopp) avslutas uppspelningen.
+*
+*                  - self: Pekare till mönstret.
+********************************************************************************/
+static void led_pattern_run(struct led_pattern* self)
+{
+   for (uint8_t step = 0; step < LED_PATTERN_MAX_STEPS; ++step)
+   {
+      const uint16_t pc = self->pc;
+      const uint8_t opcode = pgm_read_byte(self->program + pc);
+
+      if (opcode == LED_PATTERN_OP_FRAME)
+      {
+         const uint8_t num_masks = pgm_read_byte(self->program + pc + 1);
+         self->remaining_ms = led_pattern_read_u16(self, pc + 2);
+         led_pattern_show(self, pc + 4, num_masks);
+         self->pc = pc + LED_PATTERN_FRAME_SIZE(num_masks);
+      }
+      else if (opcode == LED_PATTERN_OP_DELAY)
+      {
+         self->remaining_ms = led_pattern_read_u16(self, pc + 1);
+         self->pc = pc + LED_PATTERN_DELAY_SIZE;
+      }
+      else if (opcode == LED_PATTERN_OP_JUMP)
+      {
+         self->pc = led_pattern_read_u16(self, pc + 1);
+      }
+      else if (opcode == LED_PATTERN_OP_LOOP)
+      {
+         if (led_pattern_loop(self, pc))
+         {
+            self->running = false;
+            return;
+         }
+      }
+      else
+      {
+         self->running = false;
+         return;
+      }
+
+      if (self->remaining_ms > 0) return;
+   }
+
+   self->running = false;
+   return;
+}
+
+/********************************************************************************
+* led_pattern_tick: Callbackrutin som anropas från systemticken en gång per
+*                   millisekund och driver samtliga mönster vidare. Mönster
+*                   som har nått sitt slut länkas ur.
+********************************************************************************/
+static void led_pattern_tick(void)
+{
+   for (struct led_pattern** i = &led_pattern_chain; *i;)
+   {
+      struct led_pattern* pattern = *i;
+
+      if (--pattern->remaining_ms == 0)
+      {
+         led_pattern_run(pattern);
+      }
+
+      if (pattern->running)
+      {
+         i = &pattern->next;
+      }
+      else
+      {
+         *i = pattern->next;
+         pattern->next = 0;
+      }
+   }
+
+   return;
+}
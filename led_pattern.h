@@ -0,0 +1,130 @@
+/********************************************************************************
+* led_pattern.h: Innehåller funktionalitet för uppspelning av ljusmönster
+*                lagrade i programminnet mot lysdioderna i en led_list,
+*                realiserat via strukten led_pattern samt associerade
+*                funktioner. Uppspelningen drivs från systemticken (Timer 0)
+*                och är därmed icke-blockerande.
+*
+*                Ett mönster är ett program bestående av bytekod, som
+*                deklareras som en konstant array i programminnet via
+*                makrona nedan, exempelvis en löpande lysdiod över fem
+*                lysdioder, som upprepas i all oändlighet:
+*
+*                static const uint8_t chase[] PROGMEM =
+*                {
+*                   LED_PATTERN_FRAME(100, 0x01),
+*                   LED_PATTERN_FRAME(100, 0x02),
+*                   LED_PATTERN_FRAME(100, 0x04),
+*                   LED_PATTERN_FRAME(100, 0x08),
+*                   LED_PATTERN_FRAME(100, 0x10),
+*                   LED_PATTERN_JUMP(0)
+*                };
+*
+*                Bit i i en bitmask motsvarar lysdioden på index i i listan,
+*                där den första maskbyten avser index 0 - 7, den andra
+*                index 8 - 15 och så vidare. Lysdioder utanför angivna
+*                maskbytes släcks.
+********************************************************************************/
+#ifndef LED_PATTERN_H_
+#define LED_PATTERN_H_
+
+/* Inkluderingsdirektiv: */
+#include "misc.h"
+#include "led_list.h"
+#include "timer.h"
+
+/* Maximalt antal instruktioner som exekveras utan att en bild visas: */
+#define LED_PATTERN_MAX_STEPS 16
+
+/* Maximalt antal nästlade loopar: */
+#define LED_PATTERN_MAX_LOOP_DEPTH 4
+
+/********************************************************************************
+* led_pattern_opcode: Enumeration för instruktioner i ett mönsterprogram.
+********************************************************************************/
+enum led_pattern_opcode
+{
+   LED_PATTERN_OP_END,   /* Avslutar uppspelningen, lysdioderna behåller sitt tillstånd. */
+   LED_PATTERN_OP_FRAME, /* Visar en bild: antal maskbytes, tid (16 bit) samt maskbytes. */
+   LED_PATTERN_OP_DELAY, /* Behåller aktuell bild angiven tid (16 bit). */
+   LED_PATTERN_OP_JUMP,  /* Hoppar till angiven adress (16 bit). */
+   LED_PATTERN_OP_LOOP   /* Hoppar till angiven adress (16 bit) angivet antal gånger. */
+};
+
+/********************************************************************************
+* Loopar kan nästlas i upp till LED_PATTERN_MAX_LOOP_DEPTH nivåer, där varje
+* påbörjad loop har en egen räknare som identifieras via loopinstruktionens
+* adress. Räknaren tas bort när loopen är klar, så att en yttre loop räknar
+* vidare från sitt eget värde. Påbörjas ytterligare en loop när samtliga
+* nivåer redan används avslutas uppspelningen.
+********************************************************************************/
+
+/* Makron för att dela upp 16-bitars operander i bytes (little endian): */
+#define LED_PATTERN_U16(value) (uint8_t)((value) & 0xFF), (uint8_t)(((value) >> 8) & 0xFF)
+
+/* Makron för att skriva mönsterprogram: */
+#define LED_PATTERN_END()                      LED_PATTERN_OP_END
+#define LED_PATTERN_FRAME(duration_ms, mask)   LED_PATTERN_OP_FRAME, 1, LED_PATTERN_U16(duration_ms), (mask)
+#define LED_PATTERN_FRAME_N(duration_ms, num)  LED_PATTERN_OP_FRAME, (num), LED_PATTERN_U16(duration_ms)
+#define LED_PATTERN_DELAY(duration_ms)         LED_PATTERN_OP_DELAY, LED_PATTERN_U16(duration_ms)
+#define LED_PATTERN_JUMP(address)              LED_PATTERN_OP_JUMP, LED_PATTERN_U16(address)
+#define LED_PATTERN_LOOP(count, address)       LED_PATTERN_OP_LOOP, (count), LED_PATTERN_U16(address)
+
+/* Storlek i bytes för instruktionerna ovan, för beräkning av hoppadresser: */
+#define LED_PATTERN_FRAME_SIZE(num) (4 + (num))
+#define LED_PATTERN_DELAY_SIZE      3
+#define LED_PATTERN_JUMP_SIZE       3
+#define LED_PATTERN_LOOP_SIZE       4
+
+/********************************************************************************
+* led_pattern: Strukt för uppspelning av ett mönsterprogram mot en lista.
+*              Listan får inte modifieras medan uppspelning pågår.
+********************************************************************************/
+struct led_pattern
+{
+   struct led_list* list;                               /* Listan vars lysdioder styrs. */
+   const uint8_t* program;                              /* Mönsterprogrammet i programminnet. */
+   uint16_t pc;                                         /* Adress till nästa instruktion. */
+   uint16_t remaining_ms;                               /* Kvarvarande tid för aktuell bild. */
+   uint16_t loop_addresses[LED_PATTERN_MAX_LOOP_DEPTH]; /* Adress per påbörjad loop. */
+   uint8_t loop_counters[LED_PATTERN_MAX_LOOP_DEPTH];   /* Antal genomförda hopp per loop. */
+   uint8_t loop_depth;                                  /* Antalet påbörjade loopar. */
+   bool running;                                        /* Indikerar ifall uppspelning pågår. */
+   struct led_pattern* next;                            /* Nästa mönster som spelas upp via systemticken. */
+};
+
+/********************************************************************************
+* led_pattern_start: Startar uppspelning av angivet mönsterprogram mot
+*                    lysdioderna i angiven lista. Den första bilden visas
+*                    direkt, varefter uppspelningen drivs från systemticken.
+*                    Eventuell pågående uppspelning ersätts.
+*
+*                    Ifall systemticken saknar ledig plats returneras
+*                    felkod 1, annars returneras 0.
+*
+*                    - self   : Pekare till mönstret.
+*                    - list   : Pekare till listan vars lysdioder ska styras.
+*                    - program: Pekare till mönsterprogrammet i programminnet.
+********************************************************************************/
+int led_pattern_start(struct led_pattern* self,
+                      struct led_list* list,
+                      const uint8_t* program);
+
+/********************************************************************************
+* led_pattern_stop: Stoppar eventuell pågående uppspelning av angivet mönster.
+*                   Lysdioderna behåller sitt aktuella tillstånd.
+*
+*                   - self: Pekare till mönstret vars uppspelning ska stoppas.
+********************************************************************************/
+void led_pattern_stop(struct led_pattern* self);
+
+/********************************************************************************
+* led_pattern_is_running: Indikerar ifall uppspelning av angivet mönster
+*                         pågår. Uppspelningen avslutas av sig själv när
+*                         instruktionen LED_PATTERN_END nås.
+*
+*                         - self: Pekare till mönstret.
+********************************************************************************/
+bool led_pattern_is_running(const struct led_pattern* self);
+
+#endif /* LED_PATTERN_H_ */
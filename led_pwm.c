@@ -0,0 +1,213 @@
+/********************************************************************************
+* led_pwm.c: Innehåller funktionsdefinitioner för mjukvarubaserad PWM-styrning
+*            av lysdioder via binärkodsmodulering samt avbrottsrutin för
+*            Timer 1.
+********************************************************************************/
+#include "led_pwm.h"
+
+/* Statiska variabler: */
+static struct led_pwm* volatile led_pwm_active = 0; /* Instans som drivs av Timer 1. */
+
+/********************************************************************************
+* led_pwm_init: Initierar PWM-styrning av lysdioderna i angiven lista med
+*               ljusstyrkan 0 för samtliga lysdioder. Lysdioder på index
+*               LED_PWM_MAX_CHANNELS och uppåt styrs inte.
+*
+*               - self: Pekare till PWM-strukten som ska initieras.
+*               - list: Pekare till listan vars lysdioder ska styras.
+********************************************************************************/
+void led_pwm_init(struct led_pwm* self,
+                  struct led_list* list)
+{
+   self->list = list;
+   self->active_frame = 0;
+   self->slice = LED_PWM_SLICES - 1;
+
+   for (uint8_t i = 0; i < LED_PWM_MAX_CHANNELS; ++i)
+   {
+      self->brightness[i] = 0;
+   }
+
+   led_pwm_update(self);
+   return;
+}
+
+/********************************************************************************
+* led_pwm_set: Sätter ljusstyrkan för lysdioden på angivet index i listan.
+*              Ifall index ligger utanför omfånget returneras felkod 1,
+*              annars returneras 0.
+*
+*              - self      : Pekare till PWM-strukten.
+*              - index     : Index till lysdioden i listan.
+*              - brightness: Ny ljusstyrka (0 - 255).
+********************************************************************************/
+int led_pwm_set(struct led_pwm* self,
+                const size_t index,
+                const uint8_t brightness)
+{
+   if (index >= LED_PWM_MAX_CHANNELS || index >= self->list->size) return 1;
+   self->brightness[index] = brightness;
+   led_pwm_update(self);
+   return 0;
+}
+
+/********************************************************************************
+* led_pwm_set_all: Sätter samma ljusstyrka för samtliga lysdioder i listan.
+*
+*                  - self      : Pekare till PWM-strukten.
+*                  - brightness: Ny ljusstyrka (0 - 255).
+********************************************************************************/
+void led_pwm_set_all(struct led_pwm* self,
+                     const uint8_t brightness)
+{
+   for (uint8_t i = 0; i < LED_PWM_MAX_CHANNELS; ++i)
+   {
+      self->brightness[i] = brightness;
+   }
+
+   led_pwm_update(self);
+   return;
+}
+
+/********************************************************************************
+* led_pwm_get: Returnerar ljusstyrkan för lysdioden på angivet index i
+*              listan. Ifall index ligger utanför omfånget returneras 0.
+*
+*              - self : Pekare till PWM-strukten.
+*              - index: Index till lysdioden i listan.
+********************************************************************************/
+uint8_t led_pwm_get(const struct led_pwm* self,
+                    const size_t index)
+{
+   return index < LED_PWM_MAX_CHANNELS ? self->brightness[index] : 0;
+}
+
+/********************************************************************************
+* led_pwm_update: Beräknar om bitmaskerna i den buffert som inte läses av
+*                 avbrottsrutinen och byter sedan buffert, så att en ny
+*                 uppsättning aldrig läses halvfärdig.
+*
+*                 - self: Pekare till PWM-strukten.
+********************************************************************************/
+void led_pwm_update(struct led_pwm* self)
+{
+   struct led_pwm_frame* frame = &self->frames[self->active_frame ^ 1];
+   uint8_t index = 0;
+
+   for (uint8_t port = 0; port < IO_PORT_NONE; ++port)
+   {
+      frame->channel_masks[port] = 0;
+
+      for (uint8_t slice = 0; slice < LED_PWM_SLICES; ++slice)
+      {
+         frame->slice_masks[slice][port] = 0;
+      }
+   }
+
+   for (struct led_node* i = self->list->first; i && index < LED_PWM_MAX_CHANNELS; i = i->next, ++index)
+   {
+      struct led* led = i->led;
+      if (!led || led->io_port >= IO_PORT_NONE) continue;
+
+      const uint8_t mask = 1 << led->pin;
+      const uint8_t brightness = self->brightness[index];
+      frame->channel_masks[led->io_port] |= mask;
+      led->enabled = brightness > 0;
+
+      for (uint8_t slice = 0; slice < LED_PWM_SLICES; ++slice)
+      {
+         if (brightness & (1 << slice))
+         {
+            frame->slice_masks[slice][led->io_port] |= mask;
+         }
+      }
+   }
+
+   self->active_frame ^= 1;
+   return;
+}
+
+/********************************************************************************
+* led_pwm_start: Startar PWM-styrningen via Timer 1 i CTC-mode med prescaler 8.
+*                Eventuell annan aktiv instans ersätts.
+*
+*                - self: Pekare till PWM-strukten som ska aktiveras.
+********************************************************************************/
+void led_pwm_start(struct led_pwm* self)
+{
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      led_pwm_active = self;
+      self->slice = LED_PWM_SLICES - 1;
+      REG_WRITE(TCCR1A, 0);
+      REG16_WRITE(TCNT1, 0);
+      REG16_WRITE(OCR1A, LED_PWM_UNIT - 1);
+      REG_WRITE(TCCR1B, (1 << WGM12) | (1 << CS11));
+      REG_SET(TIMSK1, 1 << OCIE1A);
+   }
+
+   sei();
+   return;
+}
+
+/********************************************************************************
+* led_pwm_stop: Stoppar PWM-styrningen och släcker samtliga styrda lysdioder.
+*
+*               - self: Pekare till PWM-strukten som ska stoppas.
+********************************************************************************/
+void led_pwm_stop(struct led_pwm* self)
+{
+   const struct led_pwm_frame* frame = &self->frames[self->active_frame];
+
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      if (led_pwm_active == self)
+      {
+         REG_WRITE(TCCR1B, 0);
+         REG_CLEAR(TIMSK1, 1 << OCIE1A);
+         led_pwm_active = 0;
+      }
+   }
+
+   if (frame->channel_masks[IO_PORTB]) REG_CLEAR(PORTB, frame->channel_masks[IO_PORTB]);
+   if (frame->channel_masks[IO_PORTC]) REG_CLEAR(PORTC, frame->channel_masks[IO_PORTC]);
+   if (frame->channel_masks[IO_PORTD]) REG_CLEAR(PORTD, frame->channel_masks[IO_PORTD]);
+
+   for (struct led_node* i = self->list->first; i; i = i->next)
+   {
+      if (i->led) i->led->enabled = false;
+   }
+   return;
+}
+
+/********************************************************************************
+* ISR (TIMER1_COMPA_vect): Avbrottsrutin som anropas vid slutet av varje
+*                          tidslucka. Nästa tidsluckas bitmasker skrivs till
+*                          samtliga portar, varefter Timer 1 ställs in på
+*                          tidsluckans längd (2^b tidsenheter).
+********************************************************************************/
+ISR (TIMER1_COMPA_vect)
+{
+   struct led_pwm* self = led_pwm_active;
+   if (!self) return;
+
+   const uint8_t slice = (self->slice + 1) & (LED_PWM_SLICES - 1);
+   const struct led_pwm_frame* frame = &self->frames[self->active_frame];
+   const uint8_t* masks = frame->slice_masks[slice];
+   self->slice = slice;
+
+   if (frame->channel_masks[IO_PORTB])
+   {
+      REG_WRITE(PORTB, (REG_READ(PORTB) & ~frame->channel_masks[IO_PORTB]) | masks[IO_PORTB]);
+   }
+   if (frame->channel_masks[IO_PORTC])
+   {
+      REG_WRITE(PORTC, (REG_READ(PORTC) & ~frame->channel_masks[IO_PORTC]) | masks[IO_PORTC]);
+   }
+   if (frame->channel_masks[IO_PORTD])
+   {
+      REG_WRITE(PORTD, (REG_READ(PORTD) & ~frame->channel_masks[IO_PORTD]) | masks[IO_PORTD]);
+   }
+
+   REG16_WRITE(OCR1A, ((uint16_t)LED_PWM_UNIT << slice) - 1);
+}
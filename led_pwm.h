@@ -0,0 +1,126 @@
+/********************************************************************************
+* led_pwm.h: Innehåller funktionalitet för mjukvarubaserad PWM-styrning av
+*            ljusstyrkan (8 bitar) för samtliga lysdioder i en led_list,
+*            oavsett vilka pinnar de är anslutna till, realiserat via
+*            strukten led_pwm samt associerade funktioner.
+*
+*            Ljusstyrkan genereras via binärkodsmodulering (BCM), även kallat
+*            bit angle modulation. Varje period delas upp i åtta tidsluckor,
+*            där lucka b varar 2^b tidsenheter och lysdioder vars ljusstyrka
+*            har bit b ettställd är tända. Utporten ställs därmed om åtta
+*            gånger per period i stället för 256 gånger som vid vanlig
+*            mjukvaru-PWM, där varje omställning är en förberäknad bitmask
+*            per I/O-port.
+*
+*            Timer 1 används i CTC-mode med prescaler 8, där en tidsenhet
+*            motsvarar 64 klockpulser (32 us). En period blir därmed
+*            255 * 32 us = 8,16 ms, vilket motsvarar cirka 122 Hz.
+*            Endast en instans kan vara aktiv åt gången.
+********************************************************************************/
+#ifndef LED_PWM_H_
+#define LED_PWM_H_
+
+/* Inkluderingsdirektiv: */
+#include "misc.h"
+#include "led_list.h"
+
+/* Maximalt antal lysdioder (kanaler) som kan dimmas: */
+#ifndef LED_PWM_MAX_CHANNELS
+#define LED_PWM_MAX_CHANNELS 20
+#endif
+
+/* Antalet tidsluckor per period samt längden på en tidsenhet i timerpulser: */
+#define LED_PWM_SLICES 8
+#define LED_PWM_UNIT   64
+
+/********************************************************************************
+* led_pwm_frame: Förberäknade bitmasker per tidslucka och I/O-port, som skrivs
+*                direkt till PORTx från avbrottsrutinen.
+********************************************************************************/
+struct led_pwm_frame
+{
+   uint8_t slice_masks[LED_PWM_SLICES][IO_PORT_NONE]; /* Tända lysdioder per tidslucka. */
+   uint8_t channel_masks[IO_PORT_NONE];               /* Samtliga styrda lysdioder. */
+};
+
+/********************************************************************************
+* led_pwm: Strukt för PWM-styrning av lysdioderna i en lista. Bitmaskerna
+*          dubbelbuffras, så att avbrottsrutinen alltid läser en komplett
+*          uppsättning medan en ny beräknas.
+********************************************************************************/
+struct led_pwm
+{
+   struct led_list* list;                      /* Listan vars lysdioder styrs. */
+   uint8_t brightness[LED_PWM_MAX_CHANNELS];   /* Ljusstyrka per index i listan. */
+   struct led_pwm_frame frames[2];             /* Dubbelbuffrade bitmasker. */
+   volatile uint8_t active_frame;              /* Buffert som läses av avbrottsrutinen. */
+   uint8_t slice;                              /* Aktuell tidslucka. */
+};
+
+/********************************************************************************
+* led_pwm_init: Initierar PWM-styrning av lysdioderna i angiven lista med
+*               ljusstyrkan 0 för samtliga lysdioder. Lysdioder på index
+*               LED_PWM_MAX_CHANNELS och uppåt styrs inte.
+*
+*               - self: Pekare till PWM-strukten som ska initieras.
+*               - list: Pekare till listan vars lysdioder ska styras.
+********************************************************************************/
+void led_pwm_init(struct led_pwm* self,
+                  struct led_list* list);
+
+/********************************************************************************
+* led_pwm_set: Sätter ljusstyrkan för lysdioden på angivet index i listan.
+*              Ifall index ligger utanför omfånget returneras felkod 1,
+*              annars returneras 0.
+*
+*              - self      : Pekare till PWM-strukten.
+*              - index     : Index till lysdioden i listan.
+*              - brightness: Ny ljusstyrka (0 - 255).
+********************************************************************************/
+int led_pwm_set(struct led_pwm* self,
+                const size_t index,
+                const uint8_t brightness);
+
+/********************************************************************************
+* led_pwm_set_all: Sätter samma ljusstyrka för samtliga lysdioder i listan.
+*
+*                  - self      : Pekare till PWM-strukten.
+*                  - brightness: Ny ljusstyrka (0 - 255).
+********************************************************************************/
+void led_pwm_set_all(struct led_pwm* self,
+                     const uint8_t brightness);
+
+/********************************************************************************
+* led_pwm_get: Returnerar ljusstyrkan för lysdioden på angivet index i
+*              listan. Ifall index ligger utanför omfånget returneras 0.
+*
+*              - self : Pekare till PWM-strukten.
+*              - index: Index till lysdioden i listan.
+********************************************************************************/
+uint8_t led_pwm_get(const struct led_pwm* self,
+                    const size_t index);
+
+/********************************************************************************
+* led_pwm_update: Beräknar om bitmaskerna efter att listan har modifierats.
+*                 Anropas automatiskt av led_pwm_set samt led_pwm_set_all.
+*
+*                 - self: Pekare till PWM-strukten.
+********************************************************************************/
+void led_pwm_update(struct led_pwm* self);
+
+/********************************************************************************
+* led_pwm_start: Startar PWM-styrningen via Timer 1. Eventuell annan aktiv
+*                instans ersätts.
+*
+*                - self: Pekare till PWM-strukten som ska aktiveras.
+********************************************************************************/
+void led_pwm_start(struct led_pwm* self);
+
+/********************************************************************************
+* led_pwm_stop: Stoppar PWM-styrningen och släcker samtliga styrda lysdioder.
+*
+*               - self: Pekare till PWM-strukten som ska stoppas.
+********************************************************************************/
+void led_pwm_stop(struct led_pwm* self);
+
+#endif /* LED_PWM_H_ */
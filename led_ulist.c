@@ -0,0 +1,664 @@
+/********************************************************************************
+* led_ulist.c: Innehåller funktionsdefinitioner för utrullade länkade listor
+*              för lagring och styrning av lysdioder.
+********************************************************************************/
+#include "led_ulist.h"
+
+/* Statiska funktioner: */
+static struct led_chunk* led_chunk_new(void);
+static void led_chunk_delete(struct led_chunk* self);
+static struct led_chunk* led_ulist_locate(const struct led_ulist* self,
+                                          const size_t index,
+                                          uint8_t* offset);
+static void led_ulist_link_after(struct led_ulist* self,
+                                 struct led_chunk* chunk,
+                                 struct led_chunk* position);
+static void led_ulist_unlink(struct led_ulist* self,
+                             struct led_chunk* chunk);
+static void led_ulist_remove_from(struct led_ulist* self,
+                                  struct led_chunk* chunk,
+                                  const uint8_t offset);
+static void led_ulist_update_masks(struct led_ulist* self);
+
+/* Statiska variabler: */
+static struct led_chunk led_chunk_pool[LED_ULIST_POOL_SIZE]; /* Länkpool. */
+static struct led_chunk* led_chunk_free_list = 0;            /* Frigjorda länkar. */
+static size_t led_chunk_pool_next = 0;                       /* Första aldrig använda länk. */
+static size_t led_chunk_pool_used = 0;                       /* Antalet använda länkar. */
+
+/********************************************************************************
+* led_ulist_init: Initierar angiven lista till tom vid start.
+*
+*                 - self: Pekare till listan som ska initieras.
+********************************************************************************/
+void led_ulist_init(struct led_ulist* self)
+{
+   self->first = 0;
+   self->last = 0;
+   self->size = 0;
+   self->port_masks_valid = false;
+   return;
+}
+
+/********************************************************************************
+* led_ulist_clear: Tömmer angiven lista och återlämnar dess länkar till
+*                  länkpoolen.
+*
+*                  - self: Pekare till listan som ska tömmas.
+********************************************************************************/
+void led_ulist_clear(struct led_ulist* self)
+{
+   struct led_chunk* i = self->first;
+
+   while (i)
+   {
+      struct led_chunk* next = i->next;
+      led_chunk_delete(i);
+      i = next;
+   }
+
+   led_ulist_init(self);
+   return;
+}
+
+/********************************************************************************
+* led_ulist_at: Returnerar en pekare till elementet på angivet index. Sökningen
+*               startar från närmaste ände och hoppar över hela länkar. Ifall
+*               ett index utanför listans omfång passeras returneras null.
+*
+*               - self : Pekare till listan.
+*               - index: Index till elementet vars adress ska returneras.
+********************************************************************************/
+struct led** led_ulist_at(const struct led_ulist* self,
+                          const size_t index)
+{
+   uint8_t offset;
+   struct led_chunk* chunk = led_ulist_locate(self, index, &offset);
+   return chunk ? &chunk->leds[offset] : 0;
+}
+
+/********************************************************************************
+* led_ulist_set: Lagrar adressen till angiven lysdiod på angivet index. Ifall
+*                ett index utanför listans omfång passeras returneras felkod 1,
+*                annars returneras 0.
+*
+*                - self : Pekare till listan.
+*                - index: Index där adressen till angiven lysdiod ska lagras.
+*                - led  : Pekare till lysdioden som ska lagras.
+********************************************************************************/
+int led_ulist_set(struct led_ulist* self,
+                  const size_t index,
+                  struct led* led)
+{
+   struct led** element = led_ulist_at(self, index);
+   if (!element) return 1;
+   *element = led;
+   self->port_masks_valid = false;
+   return 0;
+}
+
+/********************************************************************************
+* led_ulist_resize: Ändrar storleken på angiven lista, där nya platser sätts
+*                   till null. Vid utökning kontrolleras först att länkpoolen
+*                   rymmer samtliga nya länkar, så att listan lämnas orörd och
+*                   felkod 1 returneras om så inte är fallet. Annars
+*                   returneras 0.
+*
+*                   - self    : Pekare till listan vars storlek ska ändras.
+*                   - new_size: Listans nya storlek.
+********************************************************************************/
+int led_ulist_resize(struct led_ulist* self,
+                     const size_t new_size)
+{
+   if (new_size > self->size)
+   {
+      const size_t room = self->last ? LED_ULIST_CHUNK_SIZE - self->last->count : 0;
+      const size_t missing = new_size - self->size > room ? new_size - self->size - room : 0;
+      const size_t num_chunks = (missing + LED_ULIST_CHUNK_SIZE - 1) / LED_ULIST_CHUNK_SIZE;
+      if (num_chunks > LED_ULIST_POOL_SIZE - led_chunk_pool_used) return 1;
+   }
+
+   while (self->size > new_size)
+   {
+      led_ulist_pop_back(self);
+   }
+   while (self->size < new_size)
+   {
+      led_ulist_push_back(self, 0);
+   }
+
+   return 0;
+}
+
+/********************************************************************************
+* led_ulist_push_front: Lägger till en ny lysdiod längst fram i angiven lista.
+*                       Ifall den första länken är full läggs en ny länk till
+*                       först. Ifall länkpoolen är full returneras felkod 1,
+*                       annars returneras 0.
+*
+*                       - self   : Pekare till listan som ska tilldelas.
+*                       - new_led: Den nya lysdiod som ska läggas till.
+********************************************************************************/
+int led_ulist_push_front(struct led_ulist* self,
+                         struct led* new_led)
+{
+   struct led_chunk* chunk = self->first;
+
+   if (!chunk || chunk->count == LED_ULIST_CHUNK_SIZE)
+   {
+      chunk = led_chunk_new();
+      if (!chunk) return 1;
+      led_ulist_link_after(self, chunk, 0);
+   }
+
+   for (uint8_t i = chunk->count; i > 0; --i)
+   {
+      chunk->leds[i] = chunk->leds[i - 1];
+   }
+
+   chunk->leds[0] = new_led;
+   chunk->count++;
+   self->size++;
+   self->port_masks_valid = false;
+   return 0;
+}
+
+/********************************************************************************
+* led_ulist_push_back: Lägger till en ny lysdiod längst bak i angiven lista.
+*                      Ifall den sista länken är full läggs en ny länk till
+*                      sist. Ifall länkpoolen är full returneras felkod 1,
+*                      annars returneras 0.
+*
+*                      - self   : Pekare till listan som ska tilldelas.
+*                      - new_led: Den nya lysdiod som ska läggas till.
+********************************************************************************/
+int led_ulist_push_back(struct led_ulist* self,
+                        struct led* new_led)
+{
+   struct led_chunk* chunk = self->last;
+
+   if (!chunk || chunk->count == LED_ULIST_CHUNK_SIZE)
+   {
+      chunk = led_chunk_new();
+      if (!chunk) return 1;
+      led_ulist_link_after(self, chunk, self->last);
+   }
+
+   chunk->leds[chunk->count++] = new_led;
+   self->size++;
+   self->port_masks_valid = false;
+   return 0;
+}
+
+/********************************************************************************
+* led_ulist_pop_front: Tar bort eventuell första lysdiod i angiven lista.
+*
+*                      - self: Pekare till listan.
+********************************************************************************/
+void led_ulist_pop_front(struct led_ulist* self)
+{
+   if (self->first) led_ulist_remove_from(self, self->first, 0);
+   return;
+}
+
+/********************************************************************************
+* led_ulist_pop_back: Tar bort eventuell sista lysdiod i angiven lista.
+*
+*                     - self: Pekare till listan.
+********************************************************************************/
+void led_ulist_pop_back(struct led_ulist* self)
+{
+   if (self->last) led_ulist_remove_from(self, self->last, self->last->count - 1);
+   return;
+}
+
+/********************************************************************************
+* led_ulist_insert_at: Lägger in en ny lysdiod på angivet index och flyttar bak
+*                      efterföljande lysdioder ett steg. Ifall länken är full
+*                      delas den, varvid dess övre halva flyttas till en ny
+*                      länk direkt efter. Ifall index ligger utanför listans
+*                      omfång eller om länkpoolen är full returneras felkod 1,
+*                      annars returneras 0.
+*
+*                      - self : Pekare till listan.
+*                      - index: Index där den nya lysdioden ska lagras.
+*                      - led  : Pekare till lysdioden som ska lagras.
+********************************************************************************/
+int led_ulist_insert_at(struct led_ulist* self,
+                        const size_t index,
+                        struct led* led)
+{
+   uint8_t offset;
+   struct led_chunk* chunk = led_ulist_locate(self, index, &offset);
+   if (!chunk) return 1;
+
+   if (chunk->count == LED_ULIST_CHUNK_SIZE)
+   {
+      struct led_chunk* upper = led_chunk_new();
+      if (!upper) return 1;
+
+      for (uint8_t i = LED_ULIST_CHUNK_SIZE / 2; i < LED_ULIST_CHUNK_SIZE; ++i)
+      {
+         upper->leds[upper->count++] = chunk->leds[i];
+      }
+
+      chunk->count = LED_ULIST_CHUNK_SIZE / 2;
+      led_ulist_link_after(self, upper, chunk);
+
+      if (offset > chunk->count)
+      {
+         offset -= chunk->count;
+         chunk = upper;
+      }
+   }
+
+   for (uint8_t i = chunk->count; i > offset; --i)
+   {
+      chunk->leds[i] = chunk->leds[i - 1];
+   }
+
+   chunk->leds[offset] = led;
+   chunk->count++;
+   self->size++;
+   self->port_masks_valid = false;
+   return 0;
+}
+
+/********************************************************************************
+* led_ulist_remove_at: Tar bort lysdioden på angivet index och flyttar fram
+*                      efterföljande lysdioder ett steg. Ifall index ligger
+*                      utanför listans omfång returneras felkod 1, annars 0.
+*
+*                      - self : Pekare till listan.
+*                      - index: Index till lysdioden som ska tas bort.
+********************************************************************************/
+int led_ulist_remove_at(struct led_ulist* self,
+                        const size_t index)
+{
+   uint8_t offset;
+   struct led_chunk* chunk = led_ulist_locate(self, index, &offset);
+   if (!chunk) return 1;
+   led_ulist_remove_from(self, chunk, offset);
+   return 0;
+}
+
+/********************************************************************************
+* led_ulist_on: Tänder samtliga lysdioder lagrade i angiven lista. Lysdioder
+*               på samma I/O-port tänds samtidigt via en skrivning per port.
+*
+*               - self: Pekare till listan vars lysdioder ska tändas.
+********************************************************************************/
+void led_ulist_on(struct led_ulist* self)
+{
+   led_ulist_update_masks(self);
+
+   port_shadow_write_masks(self->port_masks, PORT_SHADOW_SET);
+   if (!self->shift_register_leds && !self->matrix_leds) return;
+
+   if (self->shift_register_leds) shift_register_begin();
+
+   for (struct led_chunk* i = self->first; i; i = i->next)
+   {
+      for (uint8_t j = 0; j < i->count; ++j)
+      {
+         if (i->leds[j]) led_set_enabled(i->leds[j], true);
+      }
+   }
+
+   if (self->shift_register_leds) shift_register_end();
+
+   return;
+}
+
+/********************************************************************************
+* led_ulist_off: Släcker samtliga lysdioder lagrade i angiven lista. Lysdioder
+*                på samma I/O-port släcks samtidigt via en skrivning per port.
+*
+*                - self: Pekare till listan vars lysdioder ska släckas.
+********************************************************************************/
+void led_ulist_off(struct led_ulist* self)
+{
+   led_ulist_update_masks(self);
+
+   port_shadow_write_masks(self->port_masks, PORT_SHADOW_CLEAR);
+   if (!self->shift_register_leds && !self->matrix_leds) return;
+
+   if (self->shift_register_leds) shift_register_begin();
+
+   for (struct led_chunk* i = self->first; i; i = i->next)
+   {
+      for (uint8_t j = 0; j < i->count; ++j)
+      {
+         if (i->leds[j]) led_set_enabled(i->leds[j], false);
+      }
+   }
+
+   if (self->shift_register_leds) shift_register_end();
+
+   return;
+}
+
+/********************************************************************************
+* led_ulist_toggle: Togglar samtliga lysdioder lagrade i angiven lista via en
+*                   skrivning per port till registret PINx.
+*
+*                   - self: Pekare till listan vars lysdioder ska togglas.
+********************************************************************************/
+void led_ulist_toggle(struct led_ulist* self)
+{
+   led_ulist_update_masks(self);
+
+   port_shadow_write_masks(self->port_masks, PORT_SHADOW_TOGGLE);
+   if (!self->shift_register_leds && !self->matrix_leds) return;
+
+   if (self->shift_register_leds) shift_register_begin();
+
+   for (struct led_chunk* i = self->first; i; i = i->next)
+   {
+      for (uint8_t j = 0; j < i->count; ++j)
+      {
+         struct led* led = i->leds[j];
+         if (!led) continue;
+
+         if (led->io_port < IO_PORT_NONE) led->enabled = led_is_enabled(led);
+         else led_set_enabled(led, !led->enabled);
+      }
+   }
+
+   if (self->shift_register_leds) shift_register_end();
+
+   return;
+}
+
+/********************************************************************************
+* led_ulist_blink_collectively: Genomför kollektiv (synkroniserad) blinkning
+*                               av samtliga lysdioder lagrade i angiven lista.
+*
+*                               - self          : Pekare till listan.
+*                               - blink_speed_ms: Blinkhastighet mätt i
+*                                                 millisekunder.
+********************************************************************************/
+void led_ulist_blink_collectively(struct led_ulist* self,
+                                  const uint16_t blink_speed_ms)
+{
+   led_ulist_on(self);
+   delay_ms(blink_speed_ms);
+   led_ulist_off(self);
+   delay_ms(blink_speed_ms);
+   return;
+}
+
+/********************************************************************************
+* led_ulist_blink_forward: Genomför sekventiell blinkning framåt av samtliga
+*                          lysdioder lagrade i angiven lista.
+*
+*                          - self          : Pekare till listan.
+*                          - blink_speed_ms: Blinkhastighet mätt i
+*                                            millisekunder.
+********************************************************************************/
+void led_ulist_blink_forward(struct led_ulist* self,
+                             const uint16_t blink_speed_ms)
+{
+   led_ulist_off(self);
+
+   for (struct led_chunk* i = self->first; i; i = i->next)
+   {
+      for (uint8_t j = 0; j < i->count; ++j)
+      {
+         if (!i->leds[j]) continue;
+         led_on(i->leds[j]);
+         delay_ms(blink_speed_ms);
+         led_off(i->leds[j]);
+      }
+   }
+
+   return;
+}
+
+/********************************************************************************
+* led_ulist_blink_backward: Genomför sekventiell blinkning bakåt av samtliga
+*                           lysdioder lagrade i angiven lista.
+*
+*                           - self          : Pekare till listan.
+*                           - blink_speed_ms: Blinkhastighet mätt i
+*                                             millisekunder.
+********************************************************************************/
+void led_ulist_blink_backward(struct led_ulist* self,
+                              const uint16_t blink_speed_ms)
+{
+   led_ulist_off(self);
+
+   for (struct led_chunk* i = self->last; i; i = i->previous)
+   {
+      for (uint8_t j = i->count; j > 0; --j)
+      {
+         if (!i->leds[j - 1]) continue;
+         led_on(i->leds[j - 1]);
+         delay_ms(blink_speed_ms);
+         led_off(i->leds[j - 1]);
+      }
+   }
+
+   return;
+}
+
+/********************************************************************************
+* led_chunk_new: Allokerar en tom länk från den statiska länkpoolen i konstant
+*                tid, i första hand från den fria listan. Om poolen är full
+*                returneras null.
+********************************************************************************/
+static struct led_chunk* led_chunk_new(void)
+{
+   struct led_chunk* self = led_chunk_free_list;
+
+   if (self)
+   {
+      led_chunk_free_list = self->next;
+   }
+   else if (led_chunk_pool_next < LED_ULIST_POOL_SIZE)
+   {
+      self = &led_chunk_pool[led_chunk_pool_next++];
+   }
+   else
+   {
+      return 0;
+   }
+
+   led_chunk_pool_used++;
+   self->previous = 0;
+   self->next = 0;
+   self->count = 0;
+   return self;
+}
+
+/********************************************************************************
+* led_chunk_delete: Återlämnar angiven länk till länkpoolen genom att lägga
+*                   den först i den fria listan.
+*
+*                   - self: Pekare till länken som ska återlämnas.
+********************************************************************************/
+static void led_chunk_delete(struct led_chunk* self)
+{
+   self->previous = 0;
+   self->count = 0;
+   self->next = led_chunk_free_list;
+   led_chunk_free_list = self;
+   led_chunk_pool_used--;
+   return;
+}
+
+/********************************************************************************
+* led_ulist_locate: Returnerar länken som innehåller elementet på angivet
+*                   index samt elementets position i länken. Sökningen startar
+*                   från närmaste ände och hoppar över hela länkar via deras
+*                   antal. Ifall index ligger utanför listans omfång
+*                   returneras null.
+*
+*                   - self  : Pekare till listan.
+*                   - index : Index till elementet.
+*                   - offset: Pekare där elementets position i länken lagras.
+********************************************************************************/
+static struct led_chunk* led_ulist_locate(const struct led_ulist* self,
+                                          const size_t index,
+                                          uint8_t* offset)
+{
+   if (index >= self->size) return 0;
+
+   if (index < self->size / 2)
+   {
+      struct led_chunk* chunk = self->first;
+      size_t remaining = index;
+
+      while (remaining >= chunk->count)
+      {
+         remaining -= chunk->count;
+         chunk = chunk->next;
+      }
+
+      *offset = (uint8_t)remaining;
+      return chunk;
+   }
+   else
+   {
+      struct led_chunk* chunk = self->last;
+      size_t remaining = self->size - 1 - index;
+
+      while (remaining >= chunk->count)
+      {
+         remaining -= chunk->count;
+         chunk = chunk->previous;
+      }
+
+      *offset = (uint8_t)(chunk->count - 1 - remaining);
+      return chunk;
+   }
+}
+
+/********************************************************************************
+* led_ulist_link_after: Länkar in angiven länk efter angiven position, eller
+*                       först i listan om positionen är null.
+*
+*                       - self    : Pekare till listan.
+*                       - chunk   : Pekare till länken som ska länkas in.
+*                       - position: Länken som den nya länken placeras efter.
+********************************************************************************/
+static void led_ulist_link_after(struct led_ulist* self,
+                                 struct led_chunk* chunk,
+                                 struct led_chunk* position)
+{
+   struct led_chunk* next = position ? position->next : self->first;
+   chunk->previous = position;
+   chunk->next = next;
+
+   if (position) position->next = chunk;
+   else self->first = chunk;
+
+   if (next) next->previous = chunk;
+   else self->last = chunk;
+   return;
+}
+
+/********************************************************************************
+* led_ulist_unlink: Länkar ur angiven länk ur listan och återlämnar den till
+*                   länkpoolen.
+*
+*                   - self : Pekare till listan.
+*                   - chunk: Pekare till länken som ska tas bort.
+********************************************************************************/
+static void led_ulist_unlink(struct led_ulist* self,
+                             struct led_chunk* chunk)
+{
+   if (chunk->previous) chunk->previous->next = chunk->next;
+   else self->first = chunk->next;
+
+   if (chunk->next) chunk->next->previous = chunk->previous;
+   else self->last = chunk->previous;
+
+   led_chunk_delete(chunk);
+   return;
+}
+
+/********************************************************************************
+* led_ulist_remove_from: Tar bort elementet på angiven position i angiven
+*                        länk. En tom länk tas bort, medan en länk som är
+*                        mindre än halvfull slås samman med nästa länk ifall
+*                        deras sammanlagda innehåll ryms i en länk.
+*
+*                        - self  : Pekare till listan.
+*                        - chunk : Pekare till länken.
+*                        - offset: Elementets position i länken.
+********************************************************************************/
+static void led_ulist_remove_from(struct led_ulist* self,
+                                  struct led_chunk* chunk,
+                                  const uint8_t offset)
+{
+   struct led_chunk* next = chunk->next;
+
+   for (uint8_t i = offset + 1; i < chunk->count; ++i)
+   {
+      chunk->leds[i - 1] = chunk->leds[i];
+   }
+
+   chunk->count--;
+   self->size--;
+   self->port_masks_valid = false;
+
+   if (chunk->count == 0)
+   {
+      led_ulist_unlink(self, chunk);
+   }
+   else if (chunk->count < LED_ULIST_CHUNK_SIZE / 2 && next &&
+            chunk->count + next->count <= LED_ULIST_CHUNK_SIZE)
+   {
+      for (uint8_t i = 0; i < next->count; ++i)
+      {
+         chunk->leds[chunk->count++] = next->leds[i];
+      }
+
+      led_ulist_unlink(self, next);
+   }
+
+   return;
+}
+
+/********************************************************************************
+* led_ulist_update_masks: Bygger om listans bitmasker för I/O-port B, C och D
+*                         ifall listan har modifierats sedan senaste
+*                         gruppoperationen. Tomma platser (null) ignoreras.
+*
+*                         - self: Pekare till listan.
+********************************************************************************/
+static void led_ulist_update_masks(struct led_ulist* self)
+{
+   if (self->port_masks_valid) return;
+
+   self->port_masks[IO_PORTB] = 0;
+   self->port_masks[IO_PORTC] = 0;
+   self->port_masks[IO_PORTD] = 0;
+   self->shift_register_leds = false;
+   self->matrix_leds = false;
+
+   for (struct led_chunk* i = self->first; i; i = i->next)
+   {
+      for (uint8_t j = 0; j < i->count; ++j)
+      {
+         const struct led* led = i->leds[j];
+
+         if (led && led->io_port < IO_PORT_NONE)
+         {
+            self->port_masks[led->io_port] |= 1 << led->pin;
+         }
+         else if (led && led->io_port == IO_PORT_SHIFT_REGISTER)
+         {
+            self->shift_register_leds = true;
+         }
+         else if (led && led->io_port == IO_PORT_MATRIX)
+         {
+            self->matrix_leds = true;
+         }
+      }
+   }
+
+   self->port_masks_valid = true;
+   return;
+}
@@ -0,0 +1,240 @@
+/********************************************************************************
+* led_ulist.h: Innehåller funktionalitet för implementering av utrullade
+*              (unrolled) länkade listor för lagring och styrning av multipla
+*              lysdioder, realiserat via struktar led_ulist och led_chunk
+*              samt associerade funktioner. Gränssnittet motsvarar
+*              led_vector.h, där element anges som pekare till lysdiodpekare.
+*
+*              I stället för en nod per lysdiod lagrar varje länk (chunk)
+*              upp till LED_ULIST_CHUNK_SIZE lysdiodpekare i ett fält samt
+*              antalet använda platser. Indexering hoppar därmed över hela
+*              länkar åt gången och gruppoperationer itererar över täta fält.
+*              Antalet allokeringar samt pekare minskar med länkstorleken,
+*              vilket på ATmega328P ger cirka 2,6 byte per lysdiod vid fulla
+*              länkar, jämfört med 6 byte per nod i led_list.
+*
+*              Insättning och borttagning i båda ändar samt inom en länk
+*              sker i konstant tid (begränsat av länkstorleken). En full
+*              länk delas vid insättning och en länk slås samman med nästa
+*              länk när deras sammanlagda innehåll ryms i en länk.
+*
+*              Länkarna allokeras från en statisk pool med
+*              LED_ULIST_POOL_SIZE länkar, som delas av samtliga listor.
+********************************************************************************/
+#ifndef LED_ULIST_H_
+#define LED_ULIST_H_
+
+/* Inkluderingsdirektiv: */
+#include "misc.h"
+#include "led.h"
+
+/* Antalet lysdiodpekare per länk (kan ändras vid kompilering): */
+#ifndef LED_ULIST_CHUNK_SIZE
+#define LED_ULIST_CHUNK_SIZE 8
+#endif
+
+/* Antalet länkar i den statiska länkpoolen (kan ändras vid kompilering): */
+#ifndef LED_ULIST_POOL_SIZE
+#define LED_ULIST_POOL_SIZE 8
+#endif
+
+/********************************************************************************
+* led_chunk: Länk i en utrullad lista med ett fält av lysdiodpekare, där
+*            platserna 0 till count - 1 används.
+********************************************************************************/
+struct led_chunk
+{
+   struct led_chunk* previous;              /* Pekare till föregående länk. */
+   struct led_chunk* next;                  /* Pekare till nästa länk. */
+   uint8_t count;                           /* Antalet använda platser. */
+   struct led* leds[LED_ULIST_CHUNK_SIZE];  /* Lagrade lysdiodpekare. */
+};
+
+/********************************************************************************
+* led_ulist: Utrullad länkad lista för lagring och styrning av lysdioder. I
+*            likhet med led_list cachas en bitmask per I/O-port för
+*            gruppoperationer, som för listor med enbart lysdioder på
+*            I/O-port B, C och D sker utan genomstegning av länkarna.
+********************************************************************************/
+struct led_ulist
+{
+   struct led_chunk* first;          /* Pekare till första länken. */
+   struct led_chunk* last;           /* Pekare till sista länken. */
+   size_t size;                      /* Antalet lagrade lysdioder. */
+   uint8_t port_masks[IO_PORT_NONE]; /* Bitmask för lysdioderna på I/O-port B, C och D. */
+   bool port_masks_valid;            /* Indikerar ifall bitmaskerna är aktuella. */
+   bool shift_register_leds;         /* Indikerar ifall listan innehåller skiftregisterutgångar. */
+   bool matrix_leds;                 /* Indikerar ifall listan innehåller matrisceller. */
+};
+
+/********************************************************************************
+* led_ulist_init: Initierar angiven lista till tom vid start.
+*
+*                 - self: Pekare till listan som ska initieras.
+********************************************************************************/
+void led_ulist_init(struct led_ulist* self);
+
+/********************************************************************************
+* led_ulist_clear: Tömmer angiven lista och återlämnar dess länkar till
+*                  länkpoolen.
+*
+*                  - self: Pekare till listan som ska tömmas.
+********************************************************************************/
+void led_ulist_clear(struct led_ulist* self);
+
+/********************************************************************************
+* led_ulist_at: Returnerar en pekare till elementet på angivet index. Sökningen
+*               startar från närmaste ände och hoppar över hela länkar. Ifall
+*               ett index utanför listans omfång passeras returneras null.
+*
+*               - self : Pekare till listan.
+*               - index: Index till elementet vars adress ska returneras.
+********************************************************************************/
+struct led** led_ulist_at(const struct led_ulist* self,
+                          const size_t index);
+
+/********************************************************************************
+* led_ulist_set: Lagrar adressen till angiven lysdiod på angivet index. Ifall
+*                ett index utanför listans omfång passeras returneras felkod 1,
+*                annars returneras 0.
+*
+*                - self : Pekare till listan.
+*                - index: Index där adressen till angiven lysdiod ska lagras.
+*                - led  : Pekare till lysdioden som ska lagras.
+********************************************************************************/
+int led_ulist_set(struct led_ulist* self,
+                  const size_t index,
+                  struct led* led);
+
+/********************************************************************************
+* led_ulist_resize: Ändrar storleken på angiven lista, där nya platser sätts
+*                   till null. Ifall länkpoolen tar slut returneras felkod 1,
+*                   annars returneras 0.
+*
+*                   - self    : Pekare till listan vars storlek ska ändras.
+*                   - new_size: Listans nya storlek.
+********************************************************************************/
+int led_ulist_resize(struct led_ulist* self,
+                     const size_t new_size);
+
+/********************************************************************************
+* led_ulist_push_front: Lägger till en ny lysdiod längst fram i angiven lista.
+*                       Ifall länkpoolen är full returneras felkod 1, annars 0.
+*
+*                       - self   : Pekare till listan som ska tilldelas.
+*                       - new_led: Den nya lysdiod som ska läggas till.
+********************************************************************************/
+int led_ulist_push_front(struct led_ulist* self,
+                         struct led* new_led);
+
+/********************************************************************************
+* led_ulist_push_back: Lägger till en ny lysdiod längst bak i angiven lista.
+*                      Ifall länkpoolen är full returneras felkod 1, annars 0.
+*
+*                      - self   : Pekare till listan som ska tilldelas.
+*                      - new_led: Den nya lysdiod som ska läggas till.
+********************************************************************************/
+int led_ulist_push_back(struct led_ulist* self,
+                        struct led* new_led);
+
+/********************************************************************************
+* led_ulist_pop_front: Tar bort eventuell första lysdiod i angiven lista.
+*
+*                      - self: Pekare till listan.
+********************************************************************************/
+void led_ulist_pop_front(struct led_ulist* self);
+
+/********************************************************************************
+* led_ulist_pop_back: Tar bort eventuell sista lysdiod i angiven lista.
+*
+*                     - self: Pekare till listan.
+********************************************************************************/
+void led_ulist_pop_back(struct led_ulist* self);
+
+/********************************************************************************
+* led_ulist_insert_at: Lägger in en ny lysdiod på angivet index och flyttar bak
+*                      efterföljande lysdioder ett steg. Ifall index ligger
+*                      utanför listans omfång eller om länkpoolen är full
+*                      returneras felkod 1, annars returneras 0.
+*
+*                      - self : Pekare till listan.
+*                      - index: Index där den nya lysdioden ska lagras.
+*                      - led  : Pekare till lysdioden som ska lagras.
+********************************************************************************/
+int led_ulist_insert_at(struct led_ulist* self,
+                        const size_t index,
+                        struct led* led);
+
+/********************************************************************************
+* led_ulist_remove_at: Tar bort lysdioden på angivet index och flyttar fram
+*                      efterföljande lysdioder ett steg. Ifall index ligger
+*                      utanför listans omfång returneras felkod 1, annars 0.
+*
+*                      - self : Pekare till listan.
+*                      - index: Index till lysdioden som ska tas bort.
+********************************************************************************/
+int led_ulist_remove_at(struct led_ulist* self,
+                        const size_t index);
+
+/********************************************************************************
+* led_ulist_on: Tänder samtliga lysdioder lagrade i angiven lista. Lysdioder
+*               på samma I/O-port tänds samtidigt via en skrivning per port.
+*
+*               - self: Pekare till listan vars lysdioder ska tändas.
+********************************************************************************/
+void led_ulist_on(struct led_ulist* self);
+
+/********************************************************************************
+* led_ulist_off: Släcker samtliga lysdioder lagrade i angiven lista. Lysdioder
+*                på samma I/O-port släcks samtidigt via en skrivning per port.
+*
+*                - self: Pekare till listan vars lysdioder ska släckas.
+********************************************************************************/
+void led_ulist_off(struct led_ulist* self);
+
+/********************************************************************************
+* led_ulist_toggle: Togglar samtliga lysdioder lagrade i angiven lista via en
+*                   skrivning per port till registret PINx. En lysdiod som
+*                   förekommer flera gånger i listan togglas endast en gång.
+*
+*                   - self: Pekare till listan vars lysdioder ska togglas.
+********************************************************************************/
+void led_ulist_toggle(struct led_ulist* self);
+
+/********************************************************************************
+* led_ulist_blink_collectively: Genomför kollektiv (synkroniserad) blinkning
+*                               av samtliga lysdioder lagrade i angiven lista.
+*                               Funktionen är blockerande.
+*
+*                               - self          : Pekare till listan.
+*                               - blink_speed_ms: Blinkhastighet mätt i
+*                                                 millisekunder.
+********************************************************************************/
+void led_ulist_blink_collectively(struct led_ulist* self,
+                                  const uint16_t blink_speed_ms);
+
+/********************************************************************************
+* led_ulist_blink_forward: Genomför sekventiell blinkning framåt av samtliga
+*                          lysdioder lagrade i angiven lista. Funktionen är
+*                          blockerande.
+*
+*                          - self          : Pekare till listan.
+*                          - blink_speed_ms: Blinkhastighet mätt i
+*                                            millisekunder.
+********************************************************************************/
+void led_ulist_blink_forward(struct led_ulist* self,
+                             const uint16_t blink_speed_ms);
+
+/********************************************************************************
+* led_ulist_blink_backward: Genomför sekventiell blinkning bakåt av samtliga
+*                           lysdioder lagrade i angiven lista. Funktionen är
+*                           blockerande.
+*
+*                           - self          : Pekare till listan.
+*                           - blink_speed_ms: Blinkhastighet mätt i
+*                                             millisekunder.
+********************************************************************************/
+void led_ulist_blink_backward(struct led_ulist* self,
+                              const uint16_t blink_speed_ms);
+
+#endif /* LED_ULIST_H_ */
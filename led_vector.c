@@ -0,0 +1,654 @@
+/********************************************************************************
+* led_vector.c: Innehåller funktionsdefinitioner för implementering av
+*               vektorer för lagring och styrning av lysdioder via strukten
+*               led_vector.
+********************************************************************************/
+#include "led_vector.h"
+
+/* Statiska funktioner: */
+static int led_vector_reserve(struct led_vector* self,
+                              const size_t min_capacity);
+static void led_vector_update_masks(struct led_vector* self);
+static void led_vector_blink_release(struct led_vector* self,
+                                     const size_t index,
+                                     const size_t count);
+static void led_vector_blink_step(void* container);
+
+/********************************************************************************
+* led_vector_init: Initierar angiven vektor till tom vid start. Minne för
+*                  lysdiodpekarna allokeras dynamiskt vid behov.
+*
+*                  - self: Pekare till vektorn som ska initieras.
+********************************************************************************/
+void led_vector_init(struct led_vector* self)
+{
+   self->data = 0;
+   self->size = 0;
+   self->capacity = 0;
+   self->fixed_capacity = false;
+   self->port_masks_valid = false;
+   led_blink_init(&self->blink);
+   self->blink_index = 0;
+   return;
+}
+
+/********************************************************************************
+* led_vector_init_static: Initierar angiven vektor till tom vid start med en
+*                         statisk buffert av fast kapacitet, så att ingen
+*                         dynamisk minnesallokering sker.
+*
+*                         - self    : Pekare till vektorn som ska initieras.
+*                         - buffer  : Buffert för lysdiodpekarna.
+*                         - capacity: Antalet platser i bufferten.
+********************************************************************************/
+void led_vector_init_static(struct led_vector* self,
+                            struct led** buffer,
+                            const size_t capacity)
+{
+   led_vector_init(self);
+   self->data = buffer;
+   self->capacity = capacity;
+   self->fixed_capacity = true;
+   return;
+}
+
+/********************************************************************************
+* led_vector_clear: Tömmer och nollställer angiven vektor. Dynamiskt allokerat
+*                   minne frigörs, medan en statisk buffert behålls.
+*
+*                   - self: Pekare till vektorn som ska tömmas.
+********************************************************************************/
+void led_vector_clear(struct led_vector* self)
+{
+   led_blink_lock(&self->blink);
+   led_vector_blink_release(self, 0, self->size);
+
+   if (!self->fixed_capacity)
+   {
+      free(self->data);
+      self->data = 0;
+      self->capacity = 0;
+   }
+
+   self->size = 0;
+   self->port_masks_valid = false;
+   led_blink_unlock(&self->blink);
+   return;
+}
+
+/********************************************************************************
+* led_vector_begin: Returnerar en pekare till det första elementet i angiven
+*                   vektor. Ifall vektorn är tom returneras null.
+*
+*                   - self: Pekare till vektorn.
+********************************************************************************/
+struct led** led_vector_begin(const struct led_vector* self)
+{
+   return self->size > 0 ? self->data : 0;
+}
+
+/********************************************************************************
+* led_vector_end: Returnerar en pekare till adressen direkt efter det sista
+*                 elementet i angiven vektor. Ifall vektorn är tom returneras
+*                 null.
+*
+*                 - self: Pekare till vektorn.
+********************************************************************************/
+struct led** led_vector_end(const struct led_vector* self)
+{
+   return self->size > 0 ? self->data + self->size : 0;
+}
+
+/********************************************************************************
+* led_vector_last: Returnerar en pekare till det sista elementet i angiven
+*                  vektor. Ifall vektorn är tom returneras null.
+*
+*                  - self: Pekare till vektorn.
+********************************************************************************/
+struct led** led_vector_last(const struct led_vector* self)
+{
+   return self->size > 0 ? self->data + self->size - 1 : 0;
+}
+
+/********************************************************************************
+* led_vector_at: Returnerar en pekare till elementet på angivet index i
+*                konstant tid. Ifall ett index utanför vektorns omfång
+*                passeras så returneras null.
+*
+*                - self : Pekare till vektorn.
+*                - index: Index till elementet vars adress ska returneras.
+********************************************************************************/
+struct led** led_vector_at(const struct led_vector* self,
+                           const size_t index)
+{
+   return index < self->size ? self->data + index : 0;
+}
+
+/********************************************************************************
+* led_vector_set: Lagrar adressen till angiven lysdiod på angivet index.
+*                 Ifall ett index utanför vektorns befintliga omfång passeras
+*                 så returneras felkod 1, annars returneras 0.
+*
+*                 - self : Pekare till vektorn.
+*                 - index: Index där adressen till angiven lysdiod ska lagras.
+*                 - led  : Pekare (adressen) till lysdioden som ska läggas till.
+********************************************************************************/
+int led_vector_set(struct led_vector* self,
+                   const size_t index,
+                   struct led* led)
+{
+   if (index < self->size)
+   {
+      led_blink_lock(&self->blink);
+      self->data[index] = led;
+      self->port_masks_valid = false;
+      led_blink_unlock(&self->blink);
+      return 0;
+   }
+   else
+   {
+      return 1;
+   }
+}
+
+/********************************************************************************
+* led_vector_resize: Ändrar storleken på angiven vektor så att den rymmer
+*                    angivet antal lysdioder, som kan tilldelas direkt via
+*                    index. Nya platser sätts till null. Vid misslyckad
+*                    minnesallokering, eller om en statisk buffert är för
+*                    liten, returneras felkod 1, annars returneras 0.
+*
+*                    - self    : Pekare till vektorn vars storlek ska ändras.
+*                    - new_size: Vektorns nya storlek.
+********************************************************************************/
+int led_vector_resize(struct led_vector* self,
+                      const size_t new_size)
+{
+   led_blink_lock(&self->blink);
+
+   if (led_vector_reserve(self, new_size))
+   {
+      led_blink_unlock(&self->blink);
+      return 1;
+   }
+
+   if (new_size < self->size)
+   {
+      led_vector_blink_release(self, new_size, self->size - new_size);
+   }
+
+   for (size_t i = self->size; i < new_size; ++i)
+   {
+      self->data[i] = 0;
+   }
+
+   self->size = new_size;
+   self->port_masks_valid = false;
+   led_blink_unlock(&self->blink);
+   return 0;
+}
+
+/********************************************************************************
+* led_vector_push_front: Lägger till en ny lysdiod längst fram i angiven
+*                        vektor. Vid misslyckad minnesallokering returneras
+*                        felkod 1, annars returneras 0.
+*
+*                        - self   : Pekare till vektorn som ska tilldelas.
+*                        - new_led: Den nya lysdiod som ska läggas till.
+********************************************************************************/
+int led_vector_push_front(struct led_vector* self,
+                          struct led* new_led)
+{
+   return led_vector_insert_at(self, 0, new_led);
+}
+
+/********************************************************************************
+* led_vector_push_back: Lägger till en ny lysdiod längst bak i angiven vektor
+*                       i amorterat konstant tid. Vid misslyckad
+*                       minnesallokering returneras felkod 1, annars 0.
+*
+*                       - self   : Pekare till vektorn som ska tilldelas.
+*                       - new_led: Den nya lysdiod som ska läggas till.
+********************************************************************************/
+int led_vector_push_back(struct led_vector* self,
+                         struct led* new_led)
+{
+   led_blink_lock(&self->blink);
+
+   if (led_vector_reserve(self, self->size + 1))
+   {
+      led_blink_unlock(&self->blink);
+      return 1;
+   }
+
+   self->data[self->size++] = new_led;
+   self->port_masks_valid = false;
+   led_blink_unlock(&self->blink);
+   return 0;
+}
+
+/********************************************************************************
+* led_vector_pop_front: Tar bort eventuell första lysdiod i angiven vektor.
+*
+*                       - self: Pekare till vektorn.
+********************************************************************************/
+void led_vector_pop_front(struct led_vector* self)
+{
+   led_vector_remove_at(self, 0);
+   return;
+}
+
+/********************************************************************************
+* led_vector_pop_back: Tar bort eventuell sista lysdiod i angiven vektor.
+*
+*                      - self: Pekare till vektorn.
+********************************************************************************/
+void led_vector_pop_back(struct led_vector* self)
+{
+   if (self->size > 0)
+   {
+      led_blink_lock(&self->blink);
+      led_vector_blink_release(self, self->size - 1, 1);
+      self->size--;
+      self->port_masks_valid = false;
+      led_blink_unlock(&self->blink);
+   }
+
+   return;
+}
+
+/********************************************************************************
+* led_vector_insert_at: Lägger in en ny lysdiod på angivet index i vektorn
+*                       och flyttar bak efterföljande lysdioder ett steg.
+*
+*                       Ifall angivet index inte ligger inom vektorns omfång
+*                       eller om minnesallokeringen misslyckas så returneras
+*                       felkod 1, annars returneras 0.
+*
+*                       - self : Pekare till vektorn.
+*                       - index: Index där den nya lysdioden ska lagras.
+*                       - led  : Pekare till lysdioden som ska lagras.
+********************************************************************************/
+int led_vector_insert_at(struct led_vector* self,
+                         const size_t index,
+                         struct led* led)
+{
+   if (index > self->size) return 1;
+   led_blink_lock(&self->blink);
+
+   if (led_vector_reserve(self, self->size + 1))
+   {
+      led_blink_unlock(&self->blink);
+      return 1;
+   }
+
+   for (size_t i = self->size; i > index; --i)
+   {
+      self->data[i] = self->data[i - 1];
+   }
+
+   if (self->size > 0 && index <= self->blink_index) self->blink_index++;
+   self->data[index] = led;
+   self->size++;
+   self->port_masks_valid = false;
+   led_blink_unlock(&self->blink);
+   return 0;
+}
+
+/********************************************************************************
+* led_vector_remove_at: Tar bort lysdiod på angivet index i vektorn och
+*                       flyttar fram efterföljande lysdioder ett steg.
+*
+*                       Ifall angivet index inte ligger inom vektorns omfång
+*                       så returneras felkod 1, annars returneras 0.
+*
+*                       - self : Pekare till vektorn.
+*                       - index: Index till lysdioden som ska tas bort.
+********************************************************************************/
+int led_vector_remove_at(struct led_vector* self,
+                         const size_t index)
+{
+   if (index >= self->size) return 1;
+   led_blink_lock(&self->blink);
+   led_vector_blink_release(self, index, 1);
+
+   for (size_t i = index; i + 1 < self->size; ++i)
+   {
+      self->data[i] = self->data[i + 1];
+   }
+
+   self->size--;
+   self->port_masks_valid = false;
+   led_blink_unlock(&self->blink);
+   return 0;
+}
+
+/********************************************************************************
+* led_vector_on: Tänder samtliga lysdioder lagrade i angiven vektor. Lysdioder
+*                på samma I/O-port tänds samtidigt via en skrivning per port.
+*
+*                - self: Pekare till vektorn vars lysdioder ska tändas.
+********************************************************************************/
+void led_vector_on(struct led_vector* self)
+{
+   led_vector_update_masks(self);
+
+   port_shadow_write_masks(self->port_masks, PORT_SHADOW_SET);
+   if (!self->shift_register_leds && !self->matrix_leds) return;
+
+   if (self->shift_register_leds) shift_register_begin();
+
+   for (size_t i = 0; i < self->size; ++i)
+   {
+      if (self->data[i]) led_set_enabled(self->data[i], true);
+   }
+
+   if (self->shift_register_leds) shift_register_end();
+   return;
+}
+
+/********************************************************************************
+* led_vector_off: Släcker samtliga lysdioder lagrade i angiven vektor.
+*                 Lysdioder på samma I/O-port släcks samtidigt via en
+*                 skrivning per port.
+*
+*                 - self: Pekare till vektorn vars lysdioder ska släckas.
+********************************************************************************/
+void led_vector_off(struct led_vector* self)
+{
+   led_vector_update_masks(self);
+
+   port_shadow_write_masks(self->port_masks, PORT_SHADOW_CLEAR);
+   if (!self->shift_register_leds && !self->matrix_leds) return;
+
+   if (self->shift_register_leds) shift_register_begin();
+
+   for (size_t i = 0; i < self->size; ++i)
+   {
+      if (self->data[i]) led_set_enabled(self->data[i], false);
+   }
+
+   if (self->shift_register_leds) shift_register_end();
+   return;
+}
+
+/********************************************************************************
+* led_vector_toggle: Togglar samtliga lysdioder lagrade i angiven vektor.
+*                    Lysdioder på samma I/O-port togglas samtidigt via en
+*                    skrivning per port till registret PINx, vilket är
+*                    atomärt gentemot avbrott.
+*
+*                    - self: Pekare till vektorn vars lysdioder ska togglas.
+********************************************************************************/
+void led_vector_toggle(struct led_vector* self)
+{
+   led_vector_update_masks(self);
+
+   port_shadow_write_masks(self->port_masks, PORT_SHADOW_TOGGLE);
+   if (!self->shift_register_leds && !self->matrix_leds) return;
+
+   if (self->shift_register_leds) shift_register_begin();
+
+   for (size_t i = 0; i < self->size; ++i)
+   {
+      struct led* led = self->data[i];
+      if (!led) continue;
+
+      if (led->io_port < IO_PORT_NONE) led->enabled = led_is_enabled(led);
+      else led_set_enabled(led, !led->enabled);
+   }
+
+   if (self->shift_register_leds) shift_register_end();
+   return;
+}
+
+/********************************************************************************
+* led_vector_blink_collectively: Genomför kollektiv (synkroniserad) blinkning
+*                                av samtliga lysdioder lagrade i angiven
+*                                vektor. Funktionen är blockerande.
+*
+*                                - self          : Pekare till vektorn vars
+*                                                  lysdioder ska blinkas.
+*                                - blink_speed_ms: Lysdiodernas blinkhastighet
+*                                                  mätt i millisekunder.
+********************************************************************************/
+void led_vector_blink_collectively(struct led_vector* self,
+                                   const uint16_t blink_speed_ms)
+{
+   led_vector_on(self);
+   delay_ms(blink_speed_ms);
+   led_vector_off(self);
+   delay_ms(blink_speed_ms);
+   return;
+}
+
+/********************************************************************************
+* led_vector_blink_forward: Genomför sekventiell blinkning framåt av samtliga
+*                           lysdioder lagrade i angiven vektor. Funktionen
+*                           är blockerande.
+*
+*                           - self          : Pekare till vektorn vars
+*                                             lysdioder ska blinkas.
+*                           - blink_speed_ms: Lysdiodernas blinkhastighet
+*                                             mätt i millisekunder.
+********************************************************************************/
+void led_vector_blink_forward(struct led_vector* self,
+                              const uint16_t blink_speed_ms)
+{
+   led_vector_off(self);
+
+   for (size_t i = 0; i < self->size; ++i)
+   {
+      if (!self->data[i]) continue;
+      led_on(self->data[i]);
+      delay_ms(blink_speed_ms);
+      led_off(self->data[i]);
+   }
+
+   return;
+}
+
+/********************************************************************************
+* led_vector_blink_backward: Genomför sekventiell blinkning bakåt av samtliga
+*                            lysdioder lagrade i angiven vektor. Funktionen
+*                            är blockerande.
+*
+*                            - self          : Pekare till vektorn vars
+*                                              lysdioder ska blinkas.
+*                            - blink_speed_ms: Lysdiodernas blinkhastighet
+*                                              mätt i millisekunder.
+********************************************************************************/
+void led_vector_blink_backward(struct led_vector* self,
+                               const uint16_t blink_speed_ms)
+{
+   led_vector_off(self);
+
+   for (size_t i = self->size; i > 0; --i)
+   {
+      if (!self->data[i - 1]) continue;
+      led_on(self->data[i - 1]);
+      delay_ms(blink_speed_ms);
+      led_off(self->data[i - 1]);
+   }
+
+   return;
+}
+
+/********************************************************************************
+* led_vector_blink_start: Startar icke-blockerande blinkning av lysdioderna i
+*                         angiven vektor enligt angivet blinkmönster, som
+*                         drivs från systemticken. Medan blinkning pågår får
+*                         vektorn endast ändras via vektorns egna funktioner
+*                         (se led_vector.h). Ifall systemticken saknar
+*                         ledig plats returneras felkod 1, annars 0.
+*
+*                         - self          : Pekare till vektorn vars
+*                                           lysdioder ska blinkas.
+*                         - mode          : Blinkmönster som ska användas.
+*                         - blink_speed_ms: Lysdiodernas blinkhastighet
+*                                           mätt i millisekunder.
+********************************************************************************/
+int led_vector_blink_start(struct led_vector* self,
+                           const enum led_list_blink_mode mode,
+                           const uint16_t blink_speed_ms)
+{
+   led_vector_blink_stop(self);
+   if (mode == LED_LIST_BLINK_NONE || self->size == 0) return 0;
+   self->blink_index = mode == LED_LIST_BLINK_FORWARD ? self->size - 1 : 0;
+   return led_blink_start(&self->blink, mode, blink_speed_ms, led_vector_blink_step, self);
+}
+
+/********************************************************************************
+* led_vector_blink_stop: Stoppar eventuell pågående icke-blockerande
+*                        blinkning av angiven vektor och släcker samtliga
+*                        lysdioder.
+*
+*                        - self: Pekare till vektorn vars blinkning ska
+*                                stoppas.
+********************************************************************************/
+void led_vector_blink_stop(struct led_vector* self)
+{
+   led_blink_stop(&self->blink);
+   led_vector_off(self);
+   return;
+}
+
+/********************************************************************************
+* led_vector_reserve: Säkerställer att angiven vektor rymmer minst angivet
+*                     antal lysdioder. Vid behov fördubblas kapaciteten, så
+*                     att push_back sker i amorterat konstant tid. Vid
+*                     misslyckad allokering, eller om en statisk buffert är
+*                     för liten, returneras felkod 1, annars returneras 0.
+*
+*                     - self        : Pekare till vektorn.
+*                     - min_capacity: Minsta antal platser som krävs.
+********************************************************************************/
+static int led_vector_reserve(struct led_vector* self,
+                              const size_t min_capacity)
+{
+   if (min_capacity <= self->capacity) return 0;
+   if (self->fixed_capacity) return 1;
+
+   size_t new_capacity = self->capacity > 0 ? self->capacity * 2 : 4;
+   if (new_capacity < min_capacity) new_capacity = min_capacity;
+
+   struct led** copy = (struct led**)realloc(self->data, sizeof(struct led*) * new_capacity);
+   if (!copy) return 1;
+
+   self->data = copy;
+   self->capacity = new_capacity;
+   return 0;
+}
+
+/********************************************************************************
+* led_vector_update_masks: Bygger om vektorns bitmasker för I/O-port B, C
+*                          och D ifall vektorn har modifierats sedan senaste
+*                          gruppoperationen. Tomma platser ignoreras.
+*
+*                          - self: Pekare till vektorn.
+********************************************************************************/
+static void led_vector_update_masks(struct led_vector* self)
+{
+   if (self->port_masks_valid) return;
+
+   self->port_masks[IO_PORTB] = 0;
+   self->port_masks[IO_PORTC] = 0;
+   self->port_masks[IO_PORTD] = 0;
+   self->shift_register_leds = false;
+   self->matrix_leds = false;
+
+   for (size_t i = 0; i < self->size; ++i)
+   {
+      const struct led* led = self->data[i];
+
+      if (led && led->io_port < IO_PORT_NONE)
+      {
+         self->port_masks[led->io_port] |= (1 << led->pin);
+      }
+      else if (led && led->io_port == IO_PORT_SHIFT_REGISTER)
+      {
+         self->shift_register_leds = true;
+      }
+      else if (led && led->io_port == IO_PORT_MATRIX)
+      {
+         self->matrix_leds = true;
+      }
+   }
+
+   self->port_masks_valid = true;
+   return;
+}
+
+/********************************************************************************
+* led_vector_blink_release: Justerar vektorns aktuella blinkindex inför att
+*                           angivet antal element med start på angivet
+*                           index tas bort. Ligger blinkindex efter de
+*                           borttagna elementen flyttas det med, medan
+*                           lysdioden på blinkindex släcks om den själv tas
+*                           bort, varefter blinkmönstret börjar om från
+*                           vektorns början respektive slut. Påverkar
+*                           endast sekventiell blinkning och anropas med
+*                           blinkmotorn spärrad.
+*
+*                           - self : Pekare till vektorn.
+*                           - index: Index till det första elementet som
+*                                    ska tas bort.
+*                           - count: Antalet element som ska tas bort.
+********************************************************************************/
+static void led_vector_blink_release(struct led_vector* self,
+                                     const size_t index,
+                                     const size_t count)
+{
+   const size_t size = self->size - count;
+
+   if (self->blink.mode != LED_LIST_BLINK_FORWARD &&
+       self->blink.mode != LED_LIST_BLINK_BACKWARD) return;
+
+   if (self->blink_index >= index + count)
+   {
+      self->blink_index -= count;
+   }
+   else if (self->blink_index >= index)
+   {
+      if (self->data[self->blink_index]) led_off(self->data[self->blink_index]);
+      self->blink_index = self->blink.mode == LED_LIST_BLINK_FORWARD && size > 0 ? size - 1 : 0;
+   }
+
+   return;
+}
+
+/********************************************************************************
+* led_vector_blink_step: Genomför nästa steg i angiven vektors blinkmönster.
+*
+*                        Anropas från den gemensamma blinkmotorn (se
+*                        led_blink.h).
+*
+*                        - container: Pekare till vektorn.
+********************************************************************************/
+static void led_vector_blink_step(void* container)
+{
+   struct led_vector* self = (struct led_vector*)container;
+   if (self->size == 0) return;
+
+   if (self->blink.mode == LED_LIST_BLINK_COLLECTIVELY)
+   {
+      led_vector_toggle(self);
+      return;
+   }
+
+   shift_register_begin();
+   if (self->data[self->blink_index]) led_off(self->data[self->blink_index]);
+
+   if (self->blink.mode == LED_LIST_BLINK_FORWARD)
+   {
+      self->blink_index = self->blink_index + 1 < self->size ? self->blink_index + 1 : 0;
+   }
+   else if (self->blink.mode == LED_LIST_BLINK_BACKWARD)
+   {
+      self->blink_index = self->blink_index > 0 ? self->blink_index - 1 : self->size - 1;
+   }
+
+   if (self->data[self->blink_index]) led_on(self->data[self->blink_index]);
+   shift_register_end();
+   return;
+}
@@ -0,0 +1,311 @@
+/********************************************************************************
+* led_vector.h: Innehåller funktionalitet för implementering av vektorer för
+*               lagring och styrning över multipla lysdioder eller andra
+*               utportar, realiserat via strukten led_vector samt associerade
+*               funktioner. Gränssnittet motsvarar led_list.h, så att
+*               anropande kod kan byta mellan länkad lista och vektor.
+*
+*               Lysdiodpekarna lagras sammanhängande i minnet, vilket ger
+*               indexering i konstant tid samt 2 byte per lysdiod på
+*               ATmega328P, jämfört med en nod om 6 byte i led_list.
+*               Vektorn kan antingen växa dynamiskt (kapaciteten fördubblas
+*               vid behov) eller använda en statisk buffert med fast
+*               kapacitet via led_vector_init_static.
+********************************************************************************/
+#ifndef LED_VECTOR_H_
+#define LED_VECTOR_H_
+
+/* Inkluderingsdirektiv: */
+#include "misc.h"
+#include "led.h"
+#include "led_list.h"
+
+/********************************************************************************
+* led_vector: Vektor för lagring och styrning av lysdioder eller andra digitala
+*             utportar, implementerade via strukten led. I likhet med
+*             led_list cachas en bitmask per I/O-port för gruppoperationer,
+*             som för vektorer med enbart lysdioder på I/O-port B, C och D
+*             sker utan genomstegning av elementen.
+********************************************************************************/
+struct led_vector
+{
+   struct led** data;                    /* Pekare till fältet med lysdiodpekare. */
+   size_t size;                          /* Antalet lagrade lysdioder. */
+   size_t capacity;                      /* Antalet platser i fältet. */
+   bool fixed_capacity;                  /* Indikerar statisk buffert. */
+   uint8_t port_masks[IO_PORT_NONE];     /* Bitmask för lysdioderna på I/O-port B, C och D. */
+   bool port_masks_valid;                /* Indikerar ifall bitmaskerna är aktuella. */
+   bool shift_register_leds;             /* Indikerar ifall listan innehåller skiftregisterutgångar. */
+   bool matrix_leds;                     /* Indikerar ifall listan innehåller matrisceller. */
+
+   struct led_blink blink;               /* Blinkmotor för icke-blockerande blinkning. */
+   size_t blink_index;                   /* Aktuellt index vid sekventiell blinkning. */
+};
+
+/********************************************************************************
+* led_vector_init: Initierar angiven vektor till tom vid start. Minne för
+*                  lysdiodpekarna allokeras dynamiskt vid behov.
+*
+*                  - self: Pekare till vektorn som ska initieras.
+********************************************************************************/
+void led_vector_init(struct led_vector* self);
+
+/********************************************************************************
+* led_vector_init_static: Initierar angiven vektor till tom vid start med en
+*                         statisk buffert av fast kapacitet, så att ingen
+*                         dynamisk minnesallokering sker.
+*
+*                         - self    : Pekare till vektorn som ska initieras.
+*                         - buffer  : Buffert för lysdiodpekarna.
+*                         - capacity: Antalet platser i bufferten.
+********************************************************************************/
+void led_vector_init_static(struct led_vector* self,
+                            struct led** buffer,
+                            const size_t capacity);
+
+/********************************************************************************
+* led_vector_clear: Tömmer och nollställer angiven vektor. Dynamiskt allokerat
+*                   minne frigörs, medan en statisk buffert behålls.
+*
+*                   - self: Pekare till vektorn som ska tömmas.
+********************************************************************************/
+void led_vector_clear(struct led_vector* self);
+
+/********************************************************************************
+* led_vector_begin: Returnerar en pekare till det första elementet i angiven
+*                   vektor. Ifall vektorn är tom returneras null.
+*
+*                   - self: Pekare till vektorn.
+********************************************************************************/
+struct led** led_vector_begin(const struct led_vector* self);
+
+/********************************************************************************
+* led_vector_end: Returnerar en pekare till adressen direkt efter det sista
+*                 elementet i angiven vektor. Ifall vektorn är tom returneras
+*                 null.
+*
+*                 - self: Pekare till vektorn.
+********************************************************************************/
+struct led** led_vector_end(const struct led_vector* self);
+
+/********************************************************************************
+* led_vector_last: Returnerar en pekare till det sista elementet i angiven
+*                  vektor. Ifall vektorn är tom returneras null.
+*
+*                  - self: Pekare till vektorn.
+********************************************************************************/
+struct led** led_vector_last(const struct led_vector* self);
+
+/********************************************************************************
+* led_vector_at: Returnerar en pekare till elementet på angivet index i
+*                konstant tid. Ifall ett index utanför vektorns omfång
+*                passeras så returneras null.
+*
+*                - self : Pekare till vektorn.
+*                - index: Index till elementet vars adress ska returneras.
+********************************************************************************/
+struct led** led_vector_at(const struct led_vector* self,
+                           const size_t index);
+
+/********************************************************************************
+* led_vector_set: Lagrar adressen till angiven lysdiod på angivet index.
+*                 Ifall ett index utanför vektorns befintliga omfång passeras
+*                 så returneras felkod 1, annars returneras 0.
+*
+*                 - self : Pekare till vektorn.
+*                 - index: Index där adressen till angiven lysdiod ska lagras.
+*                 - led  : Pekare (adressen) till lysdioden som ska läggas till.
+********************************************************************************/
+int led_vector_set(struct led_vector* self,
+                   const size_t index,
+                   struct led* led);
+
+/********************************************************************************
+* led_vector_resize: Ändrar storleken på angiven vektor så att den rymmer
+*                    angivet antal lysdioder, som kan tilldelas direkt via
+*                    index. Nya platser sätts till null. Vid misslyckad
+*                    minnesallokering, eller om en statisk buffert är för
+*                    liten, returneras felkod 1, annars returneras 0.
+*
+*                    - self    : Pekare till vektorn vars storlek ska ändras.
+*                    - new_size: Vektorns nya storlek.
+********************************************************************************/
+int led_vector_resize(struct led_vector* self,
+                      const size_t new_size);
+
+/********************************************************************************
+* led_vector_push_front: Lägger till en ny lysdiod längst fram i angiven
+*                        vektor. Vid misslyckad minnesallokering returneras
+*                        felkod 1, annars returneras 0.
+*
+*                        - self   : Pekare till vektorn som ska tilldelas.
+*                        - new_led: Den nya lysdiod som ska läggas till.
+********************************************************************************/
+int led_vector_push_front(struct led_vector* self,
+                          struct led* new_led);
+
+/********************************************************************************
+* led_vector_push_back: Lägger till en ny lysdiod längst bak i angiven vektor
+*                       i amorterat konstant tid. Vid misslyckad
+*                       minnesallokering returneras felkod 1, annars 0.
+*
+*                       - self   : Pekare till vektorn som ska tilldelas.
+*                       - new_led: Den nya lysdiod som ska läggas till.
+********************************************************************************/
+int led_vector_push_back(struct led_vector* self,
+                         struct led* new_led);
+
+/********************************************************************************
+* led_vector_pop_front: Tar bort eventuell första lysdiod i angiven vektor.
+*
+*                       - self: Pekare till vektorn.
+********************************************************************************/
+void led_vector_pop_front(struct led_vector* self);
+
+/********************************************************************************
+* led_vector_pop_back: Tar bort eventuell sista lysdiod i angiven vektor.
+*
+*                      - self: Pekare till vektorn.
+********************************************************************************/
+void led_vector_pop_back(struct led_vector* self);
+
+/********************************************************************************
+* led_vector_insert_at: Lägger in en ny lysdiod på angivet index i vektorn
+*                       och flyttar bak efterföljande lysdioder ett steg.
+*
+*                       Ifall angivet index inte ligger inom vektorns omfång
+*                       eller om minnesallokeringen misslyckas så returneras
+*                       felkod 1, annars returneras 0.
+*
+*                       - self : Pekare till vektorn.
+*                       - index: Index där den nya lysdioden ska lagras.
+*                       - led  : Pekare till lysdioden som ska lagras.
+********************************************************************************/
+int led_vector_insert_at(struct led_vector* self,
+                         const size_t index,
+                         struct led* led);
+
+/********************************************************************************
+* led_vector_remove_at: Tar bort lysdiod på angivet index i vektorn och
+*                       flyttar fram efterföljande lysdioder ett steg.
+*
+*                       Ifall angivet index inte ligger inom vektorns omfång
+*                       så returneras felkod 1, annars returneras 0.
+*
+*                       - self : Pekare till vektorn.
+*                       - index: Index till lysdioden som ska tas bort.
+********************************************************************************/
+int led_vector_remove_at(struct led_vector* self,
+                         const size_t index);
+
+/********************************************************************************
+* led_vector_on: Tänder samtliga lysdioder lagrade i angiven vektor. Lysdioder
+*                på samma I/O-port tänds samtidigt via en skrivning per port.
+*
+*                - self: Pekare till vektorn vars lysdioder ska tändas.
+********************************************************************************/
+void led_vector_on(struct led_vector* self);
+
+/********************************************************************************
+* led_vector_off: Släcker samtliga lysdioder lagrade i angiven vektor.
+*                 Lysdioder på samma I/O-port släcks samtidigt via en
+*                 skrivning per port.
+*
+*                 - self: Pekare till vektorn vars lysdioder ska släckas.
+********************************************************************************/
+void led_vector_off(struct led_vector* self);
+
+/********************************************************************************
+* led_vector_toggle: Togglar samtliga lysdioder lagrade i angiven vektor.
+*                    Lysdioder på samma I/O-port togglas samtidigt via en
+*                    skrivning per port till registret PINx, vilket är
+*                    atomärt gentemot avbrott. En lysdiod som förekommer
+*                    flera gånger i vektorn togglas endast en gång.
+*
+*                    - self: Pekare till vektorn vars lysdioder ska togglas.
+********************************************************************************/
+void led_vector_toggle(struct led_vector* self);
+
+/********************************************************************************
+* led_vector_blink_collectively: Genomför kollektiv (synkroniserad) blinkning
+*                                av samtliga lysdioder lagrade i angiven
+*                                vektor. Funktionen är blockerande.
+*
+*                                - self          : Pekare till vektorn vars
+*                                                  lysdioder ska blinkas.
+*                                - blink_speed_ms: Lysdiodernas blinkhastighet
+*                                                  mätt i millisekunder.
+********************************************************************************/
+void led_vector_blink_collectively(struct led_vector* self,
+                                   const uint16_t blink_speed_ms);
+
+/********************************************************************************
+* led_vector_blink_forward: Genomför sekventiell blinkning framåt av samtliga
+*                           lysdioder lagrade i angiven vektor. Funktionen
+*                           är blockerande.
+*
+*                           - self          : Pekare till vektorn vars
+*                                             lysdioder ska blinkas.
+*                           - blink_speed_ms: Lysdiodernas blinkhastighet
+*                                             mätt i millisekunder.
+********************************************************************************/
+void led_vector_blink_forward(struct led_vector* self,
+                              const uint16_t blink_speed_ms);
+
+/********************************************************************************
+* led_vector_blink_backward: Genomför sekventiell blinkning bakåt av samtliga
+*                            lysdioder lagrade i angiven vektor. Funktionen
+*                            är blockerande.
+*
+*                            - self          : Pekare till vektorn vars
+*                                              lysdioder ska blinkas.
+*                            - blink_speed_ms: Lysdiodernas blinkhastighet
+*                                              mätt i millisekunder.
+********************************************************************************/
+void led_vector_blink_backward(struct led_vector* self,
+                               const uint16_t blink_speed_ms);
+
+/********************************************************************************
+* led_vector_blink_start: Startar icke-blockerande blinkning av lysdioderna i
+*                         angiven vektor enligt angivet blinkmönster, som
+*                         drivs från systemticken. Under pågående blinkning
+*                         får vektorn ändras via vektorns funktioner för
+*                         insättning, borttagning, tilldelning samt
+*                         storleksändring, vilka spärrar blinkmotorn medan
+*                         vektorn ändras. Tas den aktuella lysdioden bort
+*                         börjar blinkmönstret om från vektorns början
+*                         respektive slut.
+*
+*                         Blinkmönstrets steg genomförs från avbrottsrutinen
+*                         för Timer 0 (se led_blink.h), som då läser
+*                         vektorns element utan annat skydd än blinkmotorns
+*                         spärr. Medan blinkning pågår får vektorn därför
+*                         inte ändras på annat sätt, exempelvis via pekare
+*                         från led_vector_at eller från en annan
+*                         avbrottsrutin, utan blinkningen ska då först
+*                         stoppas via led_vector_blink_stop.
+*
+*                         Ifall systemticken saknar ledig plats returneras
+*                         felkod 1, annars 0.
+*
+*                         - self          : Pekare till vektorn vars
+*                                           lysdioder ska blinkas.
+*                         - mode          : Blinkmönster som ska användas.
+*                         - blink_speed_ms: Lysdiodernas blinkhastighet
+*                                           mätt i millisekunder.
+********************************************************************************/
+int led_vector_blink_start(struct led_vector* self,
+                           const enum led_list_blink_mode mode,
+                           const uint16_t blink_speed_ms);
+
+/********************************************************************************
+* led_vector_blink_stop: Stoppar eventuell pågående icke-blockerande
+*                        blinkning av angiven vektor och släcker samtliga
+*                        lysdioder.
+*
+*                        - self: Pekare till vektorn vars blinkning ska
+*                                stoppas.
+********************************************************************************/
+void led_vector_blink_stop(struct led_vector* self);
+
+#endif /* LED_VECTOR_H_ */
@@ -0,0 +1,268 @@
+/********************************************************************************
+* led_wheel.c: Innehåller funktionsdefinitioner för oberoende blinkning av
+*              lysdioder via ett hashat tidshjul.
+********************************************************************************/
+#include "led_wheel.h"
+#include "timer.h"
+
+/* Statiska funktioner: */
+static void led_wheel_schedule(struct led_wheel* self,
+                               struct led_wheel_timer* timer,
+                               const uint16_t delay_ms);
+static bool led_wheel_unlink(struct led_wheel* self,
+                             struct led_wheel_timer* timer);
+static void led_wheel_advance(struct led_wheel* self);
+static void led_wheel_tick(void);
+
+/* Statiska variabler: */
+static struct led_wheel* led_wheel_chain = 0; /* Tidshjul som drivs via tick. */
+
+/********************************************************************************
+* led_wheel_init: Initierar ett tomt tidshjul.
+*
+*                 - self: Pekare till tidshjulet som ska initieras.
+********************************************************************************/
+void led_wheel_init(struct led_wheel* self)
+{
+   for (uint8_t i = 0; i < LED_WHEEL_SLOTS; ++i)
+   {
+      self->slots[i] = 0;
+   }
+
+   self->slot = 0;
+   self->size = 0;
+   self->next = 0;
+   return;
+}
+
+/********************************************************************************
+* led_wheel_add: Lägger till en blinkare för angiven lysdiod i tidshjulet.
+*                Lysdioden släcks och tänds första gången efter angiven
+*                fasförskjutning (minst en tick), varefter den hålls tänd
+*                respektive släckt under angivna tider. Ifall blinkaren redan
+*                ligger i ett tidshjul, lysdioden saknar giltig port eller
+*                någon av tiderna är 0 returneras felkod 1, annars returneras 0.
+*
+*                - self       : Pekare till tidshjulet.
+*                - timer      : Pekare till blinkaren som ska läggas till.
+*                - led        : Pekare till lysdioden som ska blinkas.
+*                - on_time_ms : Tid som lysdioden hålls tänd.
+*                - off_time_ms: Tid som lysdioden hålls släckt.
+*                - phase_ms   : Fördröjning innan lysdioden tänds första gången.
+********************************************************************************/
+int led_wheel_add(struct led_wheel* self,
+                  struct led_wheel_timer* timer,
+                  struct led* led,
+                  const uint16_t on_time_ms,
+                  const uint16_t off_time_ms,
+                  const uint16_t phase_ms)
+{
+   if (timer->wheel || !led || led->io_port == IO_PORT_NONE) return 1;
+   if (on_time_ms == 0 || off_time_ms == 0) return 1;
+
+   led_off(led);
+   timer->led = led;
+   timer->on_time_ms = on_time_ms;
+   timer->off_time_ms = off_time_ms;
+   timer->wheel = self;
+
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      led_wheel_schedule(self, timer, phase_ms > 0 ? phase_ms : 1);
+      self->size++;
+   }
+
+   return 0;
+}
+
+/********************************************************************************
+* led_wheel_remove: Tar bort angiven blinkare ur sitt tidshjul och släcker
+*                   dess lysdiod. Blinkaren söks upp i samtliga fack, då
+*                   dess aktuella fack inte lagras. Ifall blinkaren inte
+*                   ligger i något tidshjul returneras felkod 1, annars
+*                   returneras 0.
+*
+*                   - timer: Pekare till blinkaren som ska tas bort.
+********************************************************************************/
+int led_wheel_remove(struct led_wheel_timer* timer)
+{
+   struct led_wheel* self = timer->wheel;
+   if (!self) return 1;
+
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      if (led_wheel_unlink(self, timer)) self->size--;
+   }
+
+   timer->wheel = 0;
+   timer->next = 0;
+   led_off(timer->led);
+   return 0;
+}
+
+/********************************************************************************
+* led_wheel_start: Startar tidshjulet, så att det drivs vidare från
+*                  systemticken en gång per millisekund. Om tidshjulet redan
+*                  är igång sker ingen åtgärd. Ifall systemticken saknar
+*                  ledig plats returneras felkod 1, annars returneras 0.
+*
+*                  - self: Pekare till tidshjulet som ska startas.
+********************************************************************************/
+int led_wheel_start(struct led_wheel* self)
+{
+   led_wheel_stop(self);
+   if (timer_attach(led_wheel_tick)) return 1;
+
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      self->next = led_wheel_chain;
+      led_wheel_chain = self;
+   }
+
+   return 0;
+}
+
+/********************************************************************************
+* led_wheel_stop: Stoppar tidshjulet. Blinkarna ligger kvar och lysdioderna
+*                 behåller sitt aktuella tillstånd. Systemticken kopplas bort
+*                 när inget tidshjul längre är igång.
+*
+*                 - self: Pekare till tidshjulet som ska stoppas.
+********************************************************************************/
+void led_wheel_stop(struct led_wheel* self)
+{
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      for (struct led_wheel** i = &led_wheel_chain; *i; i = &(*i)->next)
+      {
+         if (*i == self)
+         {
+            *i = self->next;
+            break;
+         }
+      }
+   }
+
+   if (!led_wheel_chain)
+   {
+      timer_detach(led_wheel_tick);
+   }
+
+   self->next = 0;
+   return;
+}
+
+/********************************************************************************
+* led_wheel_schedule: Lägger in angiven blinkare i facket som motsvarar
+*                     angiven fördröjning räknat från aktuell tick. En
+*                     fördröjning på exakt ett varv hamnar i aktuellt fack
+*                     med 0 kvarvarande varv. Måste anropas med avbrott
+*                     inaktiverade eller från avbrottsrutinen.
+*
+*                     - self    : Pekare till tidshjulet.
+*                     - timer   : Pekare till blinkaren som ska läggas in.
+*                     - delay_ms: Fördröjning mätt i millisekunder (minst 1).
+********************************************************************************/
+static void led_wheel_schedule(struct led_wheel* self,
+                               struct led_wheel_timer* timer,
+                               const uint16_t delay_ms)
+{
+   const uint8_t slot = (self->slot + delay_ms) & (LED_WHEEL_SLOTS - 1);
+   timer->rounds = (delay_ms - 1) / LED_WHEEL_SLOTS;
+   timer->next = self->slots[slot];
+   self->slots[slot] = timer;
+   return;
+}
+
+/********************************************************************************
+* led_wheel_unlink: Länkar ur angiven blinkare ur det fack den ligger i.
+*                   Returnerar true ifall blinkaren hittades, annars false.
+*                   Måste anropas med avbrott inaktiverade.
+*
+*                   - self : Pekare till tidshjulet.
+*                   - timer: Pekare till blinkaren som ska länkas ur.
+********************************************************************************/
+static bool led_wheel_unlink(struct led_wheel* self,
+                             struct led_wheel_timer* timer)
+{
+   for (uint8_t slot = 0; slot < LED_WHEEL_SLOTS; ++slot)
+   {
+      for (struct led_wheel_timer** i = &self->slots[slot]; *i; i = &(*i)->next)
+      {
+         if (*i == timer)
+         {
+            *i = timer->next;
+            return true;
+         }
+      }
+   }
+
+   return false;
+}
+
+/********************************************************************************
+* led_wheel_advance: Stegar tidshjulet en tick framåt. Blinkare i det nya
+*                    facket som har varv kvar räknas ned, övriga lyfts ut,
+*                    växlas och läggs in i facket för nästa deadline. Samtliga
+*                    växlingar skrivs via port_shadow med en skrivning per
+*                    port (PINx utanför en ram), medan växlade
+*                    skiftregisterutgångar skiftas ut i en skur. Pågår en
+*                    ram skjuts båda upp till dess att ramen avslutas.
+*
+*                    - self: Pekare till tidshjulet.
+********************************************************************************/
+static void led_wheel_advance(struct led_wheel* self)
+{
+   uint8_t masks[IO_PORT_NONE] = { 0 };
+   bool shift_register_leds = false;
+   struct led_wheel_timer* due = 0;
+
+   self->slot = (self->slot + 1) & (LED_WHEEL_SLOTS - 1);
+
+   for (struct led_wheel_timer** i = &self->slots[self->slot]; *i;)
+   {
+      struct led_wheel_timer* timer = *i;
+
+      if (timer->rounds)
+      {
+         timer->rounds--;
+         i = &timer->next;
+      }
+      else
+      {
+         *i = timer->next;
+         timer->next = due;
+         due = timer;
+      }
+   }
+
+   while (due)
+   {
+      struct led_wheel_timer* timer = due;
+      struct led* led = timer->led;
+      due = timer->next;
+
+      if (led->io_port < IO_PORT_NONE) masks[led->io_port] |= 1 << led->pin;
+      else if (led->io_port == IO_PORT_SHIFT_REGISTER) shift_register_leds = true;
+      led_set_enabled(led, !led_is_enabled(led));
+      led_wheel_schedule(self, timer, led->enabled ? timer->on_time_ms : timer->off_time_ms);
+   }
+
+   port_shadow_write_masks(masks, PORT_SHADOW_TOGGLE);
+   if (shift_register_leds) shift_register_commit();
+   return;
+}
+
+/********************************************************************************
+* led_wheel_tick: Callbackrutin som anropas från systemticken en gång per
+*                 millisekund och stegar samtliga aktiva tidshjul.
+********************************************************************************/
+static void led_wheel_tick(void)
+{
+   for (struct led_wheel* i = led_wheel_chain; i; i = i->next)
+   {
+      led_wheel_advance(i);
+   }
+
+   return;
+}
@@ -0,0 +1,116 @@
+/********************************************************************************
+* led_wheel.h: Innehåller funktionalitet för oberoende blinkning av ett stort
+*              antal lysdioder, där varje lysdiod har en egen tändtid,
+*              släcktid samt fasförskjutning, realiserat via ett hashat
+*              tidshjul (hashed timing wheel) som drivs från systemticken.
+*
+*              Tidshjulet består av LED_WHEEL_SLOTS fack, där facket för
+*              en deadline utgörs av tickräknaren modulo antalet fack. En
+*              deadline som ligger mer än ett varv bort lagras tillsammans
+*              med antalet kvarvarande varv. Vid varje tick besöks endast
+*              ett fack, varvid lysdioder vars deadline har inträffat växlas
+*              och läggs in i facket för nästa deadline. Samtliga växlingar
+*              under en tick samlas till en bitmask per I/O-port, som skrivs
+*              till PINx en gång per port, alternativt till port_shadow
+*              under en pågående ram (se port_shadow.h).
+*
+*              Kostnaden per tick blir därmed proportionell mot antalet
+*              lysdioder i facket, dvs. i praktiken de som står i tur, i
+*              stället för mot det totala antalet lysdioder.
+*
+*              Blinkarna (led_wheel_timer) allokeras av anroparen, så att
+*              ingen dynamisk minnesallokering sker i avbrottskontext, och
+*              ska vara nollställda innan de läggs till första gången.
+********************************************************************************/
+#ifndef LED_WHEEL_H_
+#define LED_WHEEL_H_
+
+/* Inkluderingsdirektiv: */
+#include "misc.h"
+#include "led.h"
+
+/* Antalet fack i tidshjulet (måste vara en tvåpotens): */
+#ifndef LED_WHEEL_SLOTS
+#define LED_WHEEL_SLOTS 64
+#endif
+
+/********************************************************************************
+* led_wheel_timer: Strukt för blinkning av en enskild lysdiod i ett tidshjul.
+********************************************************************************/
+struct led_wheel_timer
+{
+   struct led* led;              /* Lysdioden som blinkas. */
+   uint16_t on_time_ms;          /* Tid som lysdioden hålls tänd. */
+   uint16_t off_time_ms;         /* Tid som lysdioden hålls släckt. */
+   uint16_t rounds;              /* Antalet hela varv kvar till deadline. */
+   struct led_wheel_timer* next; /* Nästa blinkare i samma fack. */
+   struct led_wheel* wheel;      /* Tidshjulet som blinkaren ligger i. */
+};
+
+/********************************************************************************
+* led_wheel: Strukt för ett tidshjul med blinkare.
+********************************************************************************/
+struct led_wheel
+{
+   struct led_wheel_timer* slots[LED_WHEEL_SLOTS]; /* Blinkare per fack. */
+   uint8_t slot;                                   /* Fack för aktuell tick. */
+   uint16_t size;                                  /* Antalet blinkare. */
+   struct led_wheel* next;                         /* Nästa tidshjul via systemticken. */
+};
+
+/********************************************************************************
+* led_wheel_init: Initierar ett tomt tidshjul.
+*
+*                 - self: Pekare till tidshjulet som ska initieras.
+********************************************************************************/
+void led_wheel_init(struct led_wheel* self);
+
+/********************************************************************************
+* led_wheel_add: Lägger till en blinkare för angiven lysdiod i tidshjulet.
+*                Lysdioden släcks och tänds första gången efter angiven
+*                fasförskjutning, varefter den hålls tänd respektive släckt
+*                under angivna tider. Ifall blinkaren redan ligger i ett
+*                tidshjul, lysdioden saknar giltig port eller någon av
+*                tiderna är 0 returneras felkod 1, annars returneras 0.
+*
+*                - self       : Pekare till tidshjulet.
+*                - timer      : Pekare till blinkaren som ska läggas till.
+*                - led        : Pekare till lysdioden som ska blinkas.
+*                - on_time_ms : Tid som lysdioden hålls tänd.
+*                - off_time_ms: Tid som lysdioden hålls släckt.
+*                - phase_ms   : Fördröjning innan lysdioden tänds första gången.
+********************************************************************************/
+int led_wheel_add(struct led_wheel* self,
+                  struct led_wheel_timer* timer,
+                  struct led* led,
+                  const uint16_t on_time_ms,
+                  const uint16_t off_time_ms,
+                  const uint16_t phase_ms);
+
+/********************************************************************************
+* led_wheel_remove: Tar bort angiven blinkare ur sitt tidshjul och släcker
+*                   dess lysdiod. Ifall blinkaren inte ligger i något
+*                   tidshjul returneras felkod 1, annars returneras 0.
+*
+*                   - timer: Pekare till blinkaren som ska tas bort.
+********************************************************************************/
+int led_wheel_remove(struct led_wheel_timer* timer);
+
+/********************************************************************************
+* led_wheel_start: Startar tidshjulet, så att det drivs vidare från
+*                  systemticken en gång per millisekund. Ifall systemticken
+*                  saknar ledig plats returneras felkod 1, annars returneras 0.
+*
+*                  - self: Pekare till tidshjulet som ska startas.
+********************************************************************************/
+int led_wheel_start(struct led_wheel* self);
+
+/********************************************************************************
+* led_wheel_stop: Stoppar tidshjulet. Blinkarna ligger kvar och lysdioderna
+*                 behåller sitt aktuella tillstånd.
+*
+*                 - self: Pekare till tidshjulet som ska stoppas.
+********************************************************************************/
+void led_wheel_stop(struct led_wheel* self);
+
+#endif /* LED_WHEEL_H_ */
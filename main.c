@@ -1,43 +1,103 @@
-/********************************************************************************
-* main.c: Demonstration av dubbellnkad lista fr lagring och styrning av 
-*         multipla lysdioder.
+/********************************************************************************
+* main.c: Demonstration av dubbellänkad lista för lagring och styrning av 
+*         multipla lysdioder.
 ********************************************************************************/
 #include "led.h"
 #include "button.h"
 #include "led_list.h"
+#include "power.h"
+#include "scheduler.h"
 
-/********************************************************************************
-* num_buttons_pressed: Returnerar antalet nedtryckta tryckknappar.
-*
-*                      - button1: Pekare till den frsta tryckknappen.
-*                      - button2: Pekare till den andra tryckknappen.
-*                      - button3: Pekare till den tredje tryckknappen.
-*                      - button4: Pekare till den fjrde tryckknappen.
+/* Tryckknappar med pin-nummer kända vid kompilering: */
+BUTTON_DEFINE(button1, 11);
+BUTTON_DEFINE(button2, 12);
+BUTTON_DEFINE(button3, 13);
+BUTTON_DEFINE(button4, 2);
+
+/********************************************************************************
+* num_buttons_pressed: Returnerar antalet nedtryckta tryckknappar enligt
+*                      avstudsat tillstånd, så att studsar inte medför att
+*                      blinkmönstret växlar fram och tillbaka.
 ********************************************************************************/
-static uint8_t num_buttons_pressed(struct button* button1,
-                                   struct button* button2,
-                                   struct button* button3,
-                                   struct button* button4)
+static uint8_t num_buttons_pressed(void)
 {
    uint8_t num = 0;
-   if (button_is_pressed(button1)) num++;
-   if (button_is_pressed(button2)) num++;
-   if (button_is_pressed(button3)) num++;
-   if (button_is_pressed(button4)) num++;
+   if (button_pin_is_pressed_debounced(button1)) num++;
+   if (button_pin_is_pressed_debounced(button2)) num++;
+   if (button_pin_is_pressed_debounced(button3)) num++;
+   if (button_pin_is_pressed_debounced(button4)) num++;
    return num;
 }
 
-/********************************************************************************
-* main: Ansluter fem lysdioder till pin 6 - 10 samt fyra tryckknappar till pin
-*       11 - 13 samt pin 2. Lysdioderna lagras i en dynamisk array.
-*       Beroende p antalet tryckknappar som trycks ned s blinkar lysdioderna
-*       antingen framt, bakt eller synkroniserat, eller s hlls de tnda
-*       eller slckta.
+/********************************************************************************
+* blink_control: Strukt med tillståndet för uppgiften som väljer blinkmönster.
+********************************************************************************/
+struct blink_control
+{
+   struct led_list* leds;            /* Listan vars lysdioder styrs. */
+   uint8_t previous_buttons_pressed; /* Antalet nedtryckta knappar vid förra körningen. */
+};
+
+/********************************************************************************
+* blink_control_task: Uppgift som läser av tryckknapparna och byter
+*                     blinkmönster när antalet nedtryckta knappar ändras.
+*
+*                     - arg: Pekare till strukt av typen blink_control.
+********************************************************************************/
+static void blink_control_task(void* arg)
+{
+   struct blink_control* self = (struct blink_control*)arg;
+   const uint8_t buttons_pressed = num_buttons_pressed();
+
+   if (buttons_pressed == self->previous_buttons_pressed) return;
+   self->previous_buttons_pressed = buttons_pressed;
+
+   if (buttons_pressed == 1)
+   {
+      led_list_blink_start(self->leds, LED_LIST_BLINK_COLLECTIVELY, 100);
+   }
+   else if (buttons_pressed == 2)
+   {
+      led_list_blink_start(self->leds, LED_LIST_BLINK_FORWARD, 100);
+   }
+   else if (buttons_pressed == 3)
+   {
+      led_list_blink_start(self->leds, LED_LIST_BLINK_BACKWARD, 100);
+   }
+   else if (buttons_pressed == 4)
+   {
+      led_list_blink_stop(self->leds);
+      led_list_on(self->leds);
+   }
+   else
+   {
+      led_list_blink_stop(self->leds);
+   }
+
+   return;
+}
+
+/********************************************************************************
+* main: Ansluter fem lysdioder till pin 6 - 10 samt fyra tryckknappar till pin
+*       11 - 13 samt pin 2. Lysdioderna lagras i en dubbellänkad lista.
+*       Beroende på antalet tryckknappar som trycks ned så blinkar lysdioderna
+*       antingen framåt, bakåt eller synkroniserat, eller så hålls de tända
+*       eller släckta. Blinkningen drivs från systemticken, så att
+*       tryckknapparna kan läsas av kontinuerligt även under blinkning.
+*       Blinkmönstret byts endast när antalet nedtryckta knappar ändras,
+*       vilket kontrolleras av en periodisk uppgift i schemaläggaren.
+*
+*       När ingen uppgift är redo vilar mikrodatorn. Under blinkning eller pågående
+*       avstudsning används idle, så att systemticken väcker mikrodatorn
+*       varje millisekund. Annars används power-down, där endast PCI-avbrott
+*       från tryckknapparna väcker mikrodatorn. Avbrott inaktiveras före
+*       kontrollen, så att en flank mellan kontrollen och sleep inte går
+*       förlorad. Under power-down står systemticken still, varför
+*       uppgifterna i schemaläggaren då inte heller blir redo.
 ********************************************************************************/
 int main(void)
 { 
    struct led l1, l2, l3, l4, l5;
-   struct button b1, b2, b3, b4;
    struct led_list leds;
 
    led_init(&l1, 6);
@@ -46,46 +106,40 @@ int main(void)
    led_init(&l4, 9);
    led_init(&l5, 10);
 
-   button_init(&b1, 11);
-   button_init(&b2, 12);
-   button_init(&b3, 13);
-   button_init(&b4, 2);
+   button_pin_init(button1);
+   button_pin_init(button2);
+   button_pin_init(button3);
+   button_pin_init(button4);
+   button_pin_enable_interrupt(button1);
+   button_pin_enable_interrupt(button2);
+   button_pin_enable_interrupt(button3);
+   button_pin_enable_interrupt(button4);
+   button_debounce_start();
 
+   struct led* const led_array[] = { &l1, &l2, &l3, &l4, &l5 };
    led_list_init(&leds);
+   led_list_assign(&leds, led_array, sizeof(led_array) / sizeof(led_array[0]));
 
-   led_list_push_back(&leds, &l1);
-   led_list_push_back(&leds, &l2);
-   led_list_push_back(&leds, &l3);
-   led_list_push_back(&leds, &l4);
-   led_list_push_back(&leds, &l5);
+   struct blink_control control = { &leds, UINT8_MAX };
+   scheduler_add(blink_control_task, &control, 0, BUTTON_DEBOUNCE_INTERVAL_MS, 0, 0);
 
    while (1)
    {
-      const uint8_t buttons_pressed = num_buttons_pressed(&b1, &b2, &b3, &b4);
+      if (scheduler_run_once()) continue;
 
-      if (buttons_pressed == 0)
-      {
-         led_list_off(&leds);
-      }
-      else if (buttons_pressed == 1)
-      {
-         led_list_blink_colletively(&leds, 100);
-      }
-      else if (buttons_pressed == 2)
-      {
-         led_list_blink_forward(&leds, 100);
-      }
-      else if (buttons_pressed == 3)
+      cli();
+
+      if (scheduler_has_ready_task())
       {
-         led_list_blink_backward(&leds, 100);
+         sei();
       }
-      else if (buttons_pressed == 4)
+      else if (leds.blink.mode == LED_LIST_BLINK_NONE && button_debounce_is_stable())
       {
-         led_list_on(&leds);
+         power_sleep(POWER_MODE_POWER_DOWN);
       }
       else
       {
-         led_list_off(&leds);
+         power_sleep(POWER_MODE_IDLE);
       }
    }
   
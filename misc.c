@@ -1,19 +1,34 @@
-/********************************************************************************
-* misc.c: Innehller diverse funktionsdefinitioner.
-********************************************************************************/
-#include "misc.h"
-
-/********************************************************************************
-* delay_ms: Genererar frdrjning mtt i millisekunder.
-*
-*           - delay_time_ms: Angiven frdrjningstid i millisekunder.
-********************************************************************************/
-void delay_ms(const uint16_t delay_time_ms)
-{
-   for (uint16_t i = 0; i < delay_time_ms; ++i)
-   {
-      _delay_ms(1);
-   }
-
-   return;
+/********************************************************************************
+* misc.c: Innehåller diverse funktionsdefinitioner.
+********************************************************************************/
+#include "misc.h"
+#include "timer.h"
+
+/********************************************************************************
+* delay_ms: Genererar fördröjning mätt i millisekunder. Om systemticken är
+*           igång väntas till dess att motsvarande tid mätt i mikrosekunder
+*           har förflutit, så att tid som förbrukas i avbrottsrutiner inte
+*           förlänger fördröjningen. Annars används en kalibrerad väntloop,
+*           vilket även gäller med avbrott inaktiverade (exempelvis i en
+*           avbrottsrutin eller inom ATOMIC_BLOCK), eftersom systemticken
+*           då inte räknas upp.
+*
+*           - delay_time_ms: Angiven fördröjningstid i millisekunder.
+********************************************************************************/
+void delay_ms(const uint16_t delay_time_ms)
+{
+   if (timer_is_running() && INTERRUPTS_ENABLED())
+   {
+      const uint32_t start_us = timer_micros();
+      const uint32_t delay_time_us = delay_time_ms * 1000UL;
+      while (timer_elapsed_us(start_us) < delay_time_us);
+      return;
+   }
+
+   for (uint16_t i = 0; i < delay_time_ms; ++i)
+   {
+      _delay_ms(1);
+   }
+
+   return;
 }
\ No newline at end of file
@@ -0,0 +1,329 @@
+/********************************************************************************
+* port_shadow.c: Innehåller funktionsdefinitioner för dubbelbuffrad skuggning
+*                av PORTB, PORTC och PORTD.
+********************************************************************************/
+#include "port_shadow.h"
+#include "shift_register.h"
+
+/* Statiska variabler: */
+static uint8_t port_shadow_values[IO_PORT_NONE];                /* Bakre buffert per port. */
+static uint8_t port_shadow_dirty[IO_PORT_NONE];                 /* Satta eller nollställda bitar per port. */
+static uint8_t port_shadow_toggles[IO_PORT_NONE];               /* Togglade bitar per port. */
+static volatile uint8_t port_shadow_depth = 0;                  /* Nästlingsdjup för ramar. */
+static struct port_shadow_stats port_shadow_stats = { 0, 0, 0 }; /* Statistik. */
+
+/* Statiska funktioner: */
+static uint8_t port_shadow_merge(const uint8_t io_port,
+                                 const uint8_t current);
+static void port_shadow_hardware_write(const uint8_t io_port,
+                                       const uint8_t mask,
+                                       const enum port_shadow_operation operation);
+static void port_shadow_buffer_write(const uint8_t io_port,
+                                     const uint8_t mask,
+                                     const enum port_shadow_operation operation);
+
+/********************************************************************************
+* port_shadow_begin: Påbörjar en ram. Vid den yttersta ramen kopieras aktuellt
+*                    innehåll i PORTB, PORTC och PORTD till den bakre
+*                    bufferten.
+********************************************************************************/
+void port_shadow_begin(void)
+{
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      if (!port_shadow_depth)
+      {
+         port_shadow_values[IO_PORTB] = REG_READ(PORTB);
+         port_shadow_values[IO_PORTC] = REG_READ(PORTC);
+         port_shadow_values[IO_PORTD] = REG_READ(PORTD);
+         port_shadow_dirty[IO_PORTB] = 0;
+         port_shadow_dirty[IO_PORTC] = 0;
+         port_shadow_dirty[IO_PORTD] = 0;
+         port_shadow_toggles[IO_PORTB] = 0;
+         port_shadow_toggles[IO_PORTC] = 0;
+         port_shadow_toggles[IO_PORTD] = 0;
+      }
+
+      port_shadow_depth++;
+   }
+
+   shift_register_begin();
+   return;
+}
+
+/********************************************************************************
+* port_shadow_end: Avslutar en ram påbörjad via port_shadow_begin. När den
+*                  yttersta ramen avslutas skrivs ändringarna till hårdvaran
+*                  via port_shadow_commit. Nedräkningen av nästlingsdjupet
+*                  och skrivningen sker i samma atomära block, så att en
+*                  avbrottsrutin som påbörjar en ny ram däremellan inte kan
+*                  skriva över den bakre bufferten innan den har skrivits.
+********************************************************************************/
+void port_shadow_end(void)
+{
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      if (port_shadow_depth)
+      {
+         port_shadow_depth--;
+         if (!port_shadow_depth) port_shadow_commit();
+      }
+   }
+
+   shift_register_end();
+   return;
+}
+
+/********************************************************************************
+* port_shadow_commit: Skriver ändrade bitar i den bakre bufferten till
+*                     PORTB, PORTC och PORTD i följd med avbrott
+*                     inaktiverade. Portar vars värde inte ändras hoppas
+*                     över. Kan även anropas inom en ram för att visa
+*                     ändringarna så här långt, varefter ramen fortsätter.
+********************************************************************************/
+void port_shadow_commit(void)
+{
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      const uint8_t changed[IO_PORT_NONE] =
+      {
+         port_shadow_dirty[IO_PORTB] | port_shadow_toggles[IO_PORTB],
+         port_shadow_dirty[IO_PORTC] | port_shadow_toggles[IO_PORTC],
+         port_shadow_dirty[IO_PORTD] | port_shadow_toggles[IO_PORTD]
+      };
+
+      if (changed[IO_PORTB] | changed[IO_PORTC] | changed[IO_PORTD])
+      {
+         port_shadow_stats.commits++;
+      }
+
+      if (changed[IO_PORTB])
+      {
+         const uint8_t current = REG_READ(PORTB);
+         const uint8_t value = port_shadow_merge(IO_PORTB, current);
+         if (value != current) REG_WRITE(PORTB, value);
+      }
+      if (changed[IO_PORTC])
+      {
+         const uint8_t current = REG_READ(PORTC);
+         const uint8_t value = port_shadow_merge(IO_PORTC, current);
+         if (value != current) REG_WRITE(PORTC, value);
+      }
+      if (changed[IO_PORTD])
+      {
+         const uint8_t current = REG_READ(PORTD);
+         const uint8_t value = port_shadow_merge(IO_PORTD, current);
+         if (value != current) REG_WRITE(PORTD, value);
+      }
+   }
+
+   return;
+}
+
+/********************************************************************************
+* port_shadow_active: Indikerar ifall en ram pågår.
+********************************************************************************/
+bool port_shadow_active(void)
+{
+   return port_shadow_depth > 0;
+}
+
+/********************************************************************************
+* port_shadow_write: Genomför angiven bitoperation på angiven I/O-port, i den
+*                    bakre bufferten under en ram och annars direkt i
+*                    hårdvaran.
+*
+*                    - io_port  : I/O-porten (B, C eller D).
+*                    - mask     : Bitmask för de bitar som ska påverkas.
+*                    - operation: Bitoperation som ska genomföras.
+********************************************************************************/
+void port_shadow_write(const uint8_t io_port,
+                       const uint8_t mask,
+                       const enum port_shadow_operation operation)
+{
+   if (io_port >= IO_PORT_NONE) return;
+
+   if (port_shadow_depth)
+   {
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+      {
+         port_shadow_buffer_write(io_port, mask, operation);
+      }
+   }
+   else
+   {
+      port_shadow_hardware_write(io_port, mask, operation);
+   }
+
+   return;
+}
+
+/********************************************************************************
+* port_shadow_write_masks: Genomför angiven bitoperation med en bitmask per
+*                          I/O-port, i den bakre bufferten under en ram och
+*                          annars direkt i hårdvaran via en skrivning per
+*                          port. Portar med tom bitmask påverkas inte.
+*
+*                          - masks    : Bitmasker indexerade med io_port.
+*                          - operation: Bitoperation som ska genomföras.
+********************************************************************************/
+void port_shadow_write_masks(const uint8_t* masks,
+                             const enum port_shadow_operation operation)
+{
+   if (port_shadow_depth)
+   {
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+      {
+         if (masks[IO_PORTB]) port_shadow_buffer_write(IO_PORTB, masks[IO_PORTB], operation);
+         if (masks[IO_PORTC]) port_shadow_buffer_write(IO_PORTC, masks[IO_PORTC], operation);
+         if (masks[IO_PORTD]) port_shadow_buffer_write(IO_PORTD, masks[IO_PORTD], operation);
+      }
+   }
+   else
+   {
+      if (masks[IO_PORTB]) port_shadow_hardware_write(IO_PORTB, masks[IO_PORTB], operation);
+      if (masks[IO_PORTC]) port_shadow_hardware_write(IO_PORTC, masks[IO_PORTC], operation);
+      if (masks[IO_PORTD]) port_shadow_hardware_write(IO_PORTD, masks[IO_PORTD], operation);
+   }
+
+   return;
+}
+
+/********************************************************************************
+* port_shadow_read: Returnerar det värde som angiven I/O-port har efter nästa
+*                   commit, dvs. aktuellt innehåll i PORTx med ändringar i
+*                   den bakre bufferten inräknade. Utanför en ram returneras
+*                   aktuellt innehåll i PORTx.
+*
+*                   - io_port: I/O-porten (B, C eller D).
+********************************************************************************/
+uint8_t port_shadow_read(const uint8_t io_port)
+{
+   uint8_t value = 0;
+   if (io_port >= IO_PORT_NONE) return 0;
+
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      if (io_port == IO_PORTB) value = REG_READ(PORTB);
+      else if (io_port == IO_PORTC) value = REG_READ(PORTC);
+      else value = REG_READ(PORTD);
+
+      if (port_shadow_depth)
+      {
+         const uint8_t dirty = port_shadow_dirty[io_port];
+         value = (uint8_t)(((value & ~dirty) | (port_shadow_values[io_port] & dirty)) ^
+                           port_shadow_toggles[io_port]);
+      }
+   }
+
+   return value;
+}
+
+/********************************************************************************
+* port_shadow_get_stats: Läser av statistik över skrivningar vid commit.
+*
+*                        - stats: Pekare till strukt där statistiken lagras.
+********************************************************************************/
+void port_shadow_get_stats(struct port_shadow_stats* stats)
+{
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      *stats = port_shadow_stats;
+   }
+
+   return;
+}
+
+/********************************************************************************
+* port_shadow_merge: Returnerar nytt värde för angiven port, där satta och
+*                    nollställda bitar hämtas från den bakre bufferten och
+*                    övriga från aktuellt innehåll, varefter togglade bitar
+*                    inverteras relativt aktuellt innehåll. En avbrottsrutin
+*                    som har växlat samma pin under ramen tas därmed med i
+*                    beräkningen. Noterade ändringar nollställs och
+*                    statistiken uppdateras. Anropas med avbrott inaktiverade.
+*
+*                    - io_port: I/O-porten.
+*                    - current: Aktuellt innehåll i PORTx.
+********************************************************************************/
+static uint8_t port_shadow_merge(const uint8_t io_port,
+                                 const uint8_t current)
+{
+   const uint8_t dirty = port_shadow_dirty[io_port];
+   const uint8_t value = (uint8_t)(((current & ~dirty) | (port_shadow_values[io_port] & dirty)) ^
+                                   port_shadow_toggles[io_port]);
+
+   port_shadow_values[io_port] = value;
+   port_shadow_dirty[io_port] = 0;
+   port_shadow_toggles[io_port] = 0;
+
+   if (value != current) port_shadow_stats.port_writes++;
+   else port_shadow_stats.skipped_writes++;
+   return value;
+}
+
+/********************************************************************************
+* port_shadow_hardware_write: Genomför angiven bitoperation direkt i
+*                             hårdvaran. Toggling sker via registret PINx.
+*
+*                             - io_port  : I/O-porten.
+*                             - mask     : Bitmask för de bitar som ska påverkas.
+*                             - operation: Bitoperation som ska genomföras.
+********************************************************************************/
+static void port_shadow_hardware_write(const uint8_t io_port,
+                                       const uint8_t mask,
+                                       const enum port_shadow_operation operation)
+{
+   if (io_port == IO_PORTB)
+   {
+      if (operation == PORT_SHADOW_SET) REG_SET(PORTB, mask);
+      else if (operation == PORT_SHADOW_CLEAR) REG_CLEAR(PORTB, mask);
+      else REG_WRITE(PINB, mask);
+   }
+   else if (io_port == IO_PORTC)
+   {
+      if (operation == PORT_SHADOW_SET) REG_SET(PORTC, mask);
+      else if (operation == PORT_SHADOW_CLEAR) REG_CLEAR(PORTC, mask);
+      else REG_WRITE(PINC, mask);
+   }
+   else if (io_port == IO_PORTD)
+   {
+      if (operation == PORT_SHADOW_SET) REG_SET(PORTD, mask);
+      else if (operation == PORT_SHADOW_CLEAR) REG_CLEAR(PORTD, mask);
+      else REG_WRITE(PIND, mask);
+   }
+
+   return;
+}
+
+/********************************************************************************
+* port_shadow_buffer_write: Genomför angiven bitoperation i den bakre
+*                           bufferten och noterar påverkade bitar som
+*                           ändrade. Bitar som redan har satts eller
+*                           nollställts under ramen togglas i bufferten,
+*                           medan övriga bitar noteras som togglade och
+*                           inverteras först vid commit, relativt portens
+*                           innehåll då. Anropas med avbrott inaktiverade.
+*
+*                           - io_port  : I/O-porten.
+*                           - mask     : Bitmask för de bitar som ska påverkas.
+*                           - operation: Bitoperation som ska genomföras.
+********************************************************************************/
+static void port_shadow_buffer_write(const uint8_t io_port,
+                                     const uint8_t mask,
+                                     const enum port_shadow_operation operation)
+{
+   if (operation == PORT_SHADOW_TOGGLE)
+   {
+      port_shadow_values[io_port] ^= mask & port_shadow_dirty[io_port];
+      port_shadow_toggles[io_port] ^= mask & ~port_shadow_dirty[io_port];
+      return;
+   }
+
+   if (operation == PORT_SHADOW_SET) port_shadow_values[io_port] |= mask;
+   else port_shadow_values[io_port] &= ~mask;
+
+   port_shadow_dirty[io_port] |= mask;
+   port_shadow_toggles[io_port] &= ~mask;
+   return;
+}
@@ -0,0 +1,130 @@
+/********************************************************************************
+* port_shadow.h: Innehåller funktionalitet för dubbelbuffrad skuggning av
+*                PORTB, PORTC och PORTD, så att en uppdatering av flera
+*                lysdioder på olika I/O-portar kan förberedas i RAM och
+*                sedan visas samtidigt.
+*
+*                Mellan port_shadow_begin och port_shadow_end (en ram)
+*                skrivs ändringar från led_on, led_off, led_toggle,
+*                listornas gruppoperationer, mönsterbilder (led_pattern)
+*                samt tidshjulets växlingar (led_wheel) endast till en
+*                bakre buffert, där även vilka bitar som har ändrats
+*                noteras. Vid port_shadow_commit skrivs endast ändrade
+*                bitar tillbaka, en skrivning per port i följd med avbrott
+*                inaktiverade, varvid portar utan ändringar hoppas över
+*                helt. Övriga bitar läses från respektive PORTx vid
+*                skrivningen, så att exempelvis pinnar som styrs av PWM-
+*                eller matrisavbrott inte påverkas. Togglade bitar
+*                inverteras relativt portens innehåll vid skrivningen, så
+*                att en pin som även har växlats av en avbrottsrutin under
+*                ramen inte skrivs med ett inaktuellt värde.
+*
+*                En ram omfattar även skiftregisterkedjan (se
+*                shift_register.h), vars utskiftning sker direkt efter
+*                portskrivningarna. Ramar kan nästlas, varvid endast den
+*                yttersta ramen skriver till hårdvaran. Ändringar från
+*                blinkmotorn, mönstermotorn samt tidshjulet, som körs
+*                från systemticken, skjuts därmed också upp under en
+*                pågående ram. PWM- och matrisavbrotten skriver däremot
+*                alltid direkt till hårdvaran.
+*
+*                Utanför en ram skrivs ändringarna direkt till hårdvaran,
+*                precis som tidigare.
+********************************************************************************/
+#ifndef PORT_SHADOW_H_
+#define PORT_SHADOW_H_
+
+/* Inkluderingsdirektiv: */
+#include "misc.h"
+
+/********************************************************************************
+* port_shadow_operation: Enumeration för bitoperationer på en I/O-port.
+********************************************************************************/
+enum port_shadow_operation
+{
+   PORT_SHADOW_SET,   /* Ettställning av bitar i PORTx. */
+   PORT_SHADOW_CLEAR, /* Nollställning av bitar i PORTx. */
+   PORT_SHADOW_TOGGLE /* Toggling av bitar, utanför ram via registret PINx, annars vid commit. */
+};
+
+/********************************************************************************
+* port_shadow_stats: Strukt för statistik över skrivningar vid commit.
+********************************************************************************/
+struct port_shadow_stats
+{
+   uint32_t commits;        /* Antalet commits med ändrade bitar. */
+   uint32_t port_writes;    /* Antalet skrivningar till PORTx. */
+   uint32_t skipped_writes; /* Portar med noterade ändringar men oförändrat värde. */
+};
+
+/********************************************************************************
+* port_shadow_begin: Påbörjar en ram. Vid den yttersta ramen kopieras aktuellt
+*                    innehåll i PORTB, PORTC och PORTD till den bakre
+*                    bufferten.
+********************************************************************************/
+void port_shadow_begin(void);
+
+/********************************************************************************
+* port_shadow_end: Avslutar en ram påbörjad via port_shadow_begin. När den
+*                  yttersta ramen avslutas skrivs ändringarna till hårdvaran
+*                  via port_shadow_commit.
+********************************************************************************/
+void port_shadow_end(void);
+
+/********************************************************************************
+* port_shadow_commit: Skriver ändrade bitar i den bakre bufferten till
+*                     PORTB, PORTC och PORTD i följd med avbrott
+*                     inaktiverade. Portar vars värde inte ändras hoppas
+*                     över. Kan även anropas inom en ram för att visa
+*                     ändringarna så här långt, varefter ramen fortsätter.
+********************************************************************************/
+void port_shadow_commit(void);
+
+/********************************************************************************
+* port_shadow_active: Indikerar ifall en ram pågår.
+********************************************************************************/
+bool port_shadow_active(void);
+
+/********************************************************************************
+* port_shadow_write: Genomför angiven bitoperation på angiven I/O-port, i den
+*                    bakre bufferten under en ram och annars direkt i
+*                    hårdvaran.
+*
+*                    - io_port  : I/O-porten (B, C eller D).
+*                    - mask     : Bitmask för de bitar som ska påverkas.
+*                    - operation: Bitoperation som ska genomföras.
+********************************************************************************/
+void port_shadow_write(const uint8_t io_port,
+                       const uint8_t mask,
+                       const enum port_shadow_operation operation);
+
+/********************************************************************************
+* port_shadow_write_masks: Genomför angiven bitoperation med en bitmask per
+*                          I/O-port, i den bakre bufferten under en ram och
+*                          annars direkt i hårdvaran via en skrivning per
+*                          port. Portar med tom bitmask påverkas inte.
+*
+*                          - masks    : Bitmasker indexerade med io_port.
+*                          - operation: Bitoperation som ska genomföras.
+********************************************************************************/
+void port_shadow_write_masks(const uint8_t* masks,
+                             const enum port_shadow_operation operation);
+
+/********************************************************************************
+* port_shadow_read: Returnerar det värde som angiven I/O-port har efter nästa
+*                   commit, dvs. aktuellt innehåll i PORTx med ändringar i
+*                   den bakre bufferten inräknade. Utanför en ram returneras
+*                   aktuellt innehåll i PORTx.
+*
+*                   - io_port: I/O-porten (B, C eller D).
+********************************************************************************/
+uint8_t port_shadow_read(const uint8_t io_port);
+
+/********************************************************************************
+* port_shadow_get_stats: Läser av statistik över skrivningar vid commit.
+*
+*                        - stats: Pekare till strukt där statistiken lagras.
+********************************************************************************/
+void port_shadow_get_stats(struct port_shadow_stats* stats);
+
+#endif /* PORT_SHADOW_H_ */
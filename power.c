@@ -0,0 +1,47 @@
+/********************************************************************************
+* power.c: Innehåller funktionsdefinitioner för att försätta mikrodatorn i
+*          viloläge via registret SMCR.
+********************************************************************************/
+#include "power.h"
+
+/* Statiska variabler: */
+static struct power_stats power_stats = { 0, 0 }; /* Statistik över vilolägen. */
+
+/********************************************************************************
+* power_sleep: Försätter mikrodatorn i angivet viloläge till dess att ett
+*              avbrott inträffar. Viloläget väljs via bitarna SM2 - SM0 i
+*              SMCR (000 = idle, 010 = power-down), varefter SE ettställs
+*              och instruktionen sleep exekveras. SE nollställs efter
+*              uppvaknandet så att en oavsiktlig sleep inte får effekt.
+*
+*              - mode: Viloläget som ska användas.
+********************************************************************************/
+void power_sleep(const enum power_mode mode)
+{
+   if (mode == POWER_MODE_POWER_DOWN)
+   {
+      REG_WRITE(SMCR, (1 << SM1) | (1 << SE));
+      power_stats.power_down_sleeps++;
+   }
+   else
+   {
+      REG_WRITE(SMCR, 1 << SE);
+      power_stats.idle_sleeps++;
+   }
+
+   sei();
+   sleep_cpu();
+   REG_WRITE(SMCR, 0);
+   return;
+}
+
+/********************************************************************************
+* power_get_stats: Läser av statistik över antalet vilolägen.
+*
+*                  - stats: Pekare till strukt där statistiken lagras.
+********************************************************************************/
+void power_get_stats(struct power_stats* stats)
+{
+   *stats = power_stats;
+   return;
+}
@@ -0,0 +1,59 @@
+/********************************************************************************
+* power.h: Innehåller funktionalitet för att försätta mikrodatorn i viloläge
+*          mellan händelser, så att strömförbrukningen minskar när inget
+*          behöver utföras.
+*
+*          - Idle       : CPU:n stoppas medan timrar och avbrott fortsätter.
+*                         Mikrodatorn väcks av nästa avbrott, exempelvis
+*                         systemticken varje millisekund eller PCI-avbrott.
+*                         Används när en animation eller avstudsning pågår.
+*          - Power-down : Samtliga klockor stoppas, inklusive systemticken.
+*                         Mikrodatorn väcks endast av PCI-avbrott, exempelvis
+*                         vid nedtryckning av en tryckknapp. Utportarna
+*                         behåller sina värden, så tända lysdioder förblir
+*                         tända.
+********************************************************************************/
+#ifndef POWER_H_
+#define POWER_H_
+
+/* Inkluderingsdirektiv: */
+#include "misc.h"
+
+/********************************************************************************
+* power_mode: Enumeration för val av viloläge.
+********************************************************************************/
+enum power_mode
+{
+   POWER_MODE_IDLE,      /* CPU stoppas, timrar och avbrott är aktiva. */
+   POWER_MODE_POWER_DOWN /* Samtliga klockor stoppas, väcks av PCI-avbrott. */
+};
+
+/********************************************************************************
+* power_stats: Strukt för statistik över antalet vilolägen, som kan användas
+*              för att uppskatta genomsnittlig strömförbrukning.
+********************************************************************************/
+struct power_stats
+{
+   uint32_t idle_sleeps;       /* Antalet gånger i idle. */
+   uint32_t power_down_sleeps; /* Antalet gånger i power-down. */
+};
+
+/********************************************************************************
+* power_sleep: Försätter mikrodatorn i angivet viloläge till dess att ett
+*              avbrott inträffar. Avbrott aktiveras globalt. Instruktionen
+*              sei exekveras direkt före sleep, vilket medför att ett avbrott
+*              som inträffar däremellan väcker mikrodatorn direkt i stället
+*              för att gå förlorat.
+*
+*              - mode: Viloläget som ska användas.
+********************************************************************************/
+void power_sleep(const enum power_mode mode);
+
+/********************************************************************************
+* power_get_stats: Läser av statistik över antalet vilolägen.
+*
+*                  - stats: Pekare till strukt där statistiken lagras.
+********************************************************************************/
+void power_get_stats(struct power_stats* stats);
+
+#endif /* POWER_H_ */
@@ -0,0 +1,170 @@
+/********************************************************************************
+* scheduler.c: Innehåller funktionsdefinitioner för den kooperativa
+*              schemaläggaren.
+********************************************************************************/
+#include "scheduler.h"
+
+/* Statiska funktioner: */
+static struct scheduler_task* scheduler_next_ready(const uint32_t now_ms);
+
+/* Statiska variabler: */
+static struct scheduler_task scheduler_tasks[SCHEDULER_MAX_TASKS]; /* Uppgiftstabell. */
+static struct scheduler_task* scheduler_current = 0;               /* Uppgift som körs för tillfället. */
+
+/********************************************************************************
+* scheduler_add: Lägger till en uppgift i schemaläggaren. Systemticken
+*                startas vid behov. Platsen för den uppgift som körs för
+*                tillfället återanvänds inte, så att dess statistik inte
+*                hamnar på den nya uppgiften. Ifall samtliga platser är
+*                upptagna returneras felkod 1, annars returneras 0.
+*
+*                - function : Rutinen som ska köras.
+*                - arg      : Argument som passeras till rutinen (eller null).
+*                - delay_ms : Fördröjning till första körningen.
+*                - period_ms: Periodtid, alternativt 0 för en engångsuppgift.
+*                - priority : Prioritet, där lägre värde går före.
+*                - id       : Pekare där uppgiftens id lagras (eller null).
+********************************************************************************/
+int scheduler_add(void (*function)(void* arg),
+                  void* arg,
+                  const uint16_t delay_ms,
+                  const uint16_t period_ms,
+                  const uint8_t priority,
+                  uint8_t* id)
+{
+   timer_init();
+
+   for (uint8_t i = 0; i < SCHEDULER_MAX_TASKS; ++i)
+   {
+      struct scheduler_task* task = &scheduler_tasks[i];
+      if (task->active || task == scheduler_current) continue;
+
+      task->function = function;
+      task->arg = arg;
+      task->next_run_ms = timer_millis() + delay_ms;
+      task->period_ms = period_ms;
+      task->priority = priority;
+      task->stats.runs = 0;
+      task->stats.total_time_us = 0;
+      task->stats.max_time_us = 0;
+      task->active = true;
+
+      if (id) *id = i;
+      return 0;
+   }
+
+   return 1;
+}
+
+/********************************************************************************
+* scheduler_remove: Tar bort angiven uppgift ur schemaläggaren. Ifall id
+*                   inte motsvarar en aktiv uppgift returneras felkod 1,
+*                   annars returneras 0.
+*
+*                   - id: Uppgiftens id.
+********************************************************************************/
+int scheduler_remove(const uint8_t id)
+{
+   if (id >= SCHEDULER_MAX_TASKS || !scheduler_tasks[id].active) return 1;
+   scheduler_tasks[id].active = false;
+   return 0;
+}
+
+/********************************************************************************
+* scheduler_run_once: Kör den uppgift som är redo och har högst prioritet.
+*                     Periodiska uppgifter schemaläggs om en period efter
+*                     föregående planerade tidpunkt, så att ingen drift
+*                     uppstår. Har en uppgift hamnat mer än en period efter
+*                     hoppas missade körningar över. Engångsuppgifter tas
+*                     bort efter att de har körts och statistiken har
+*                     uppdaterats. En uppgift som lägger till sig själv igen
+*                     hamnar därmed på en annan plats. Returnerar true ifall
+*                     en uppgift kördes.
+********************************************************************************/
+bool scheduler_run_once(void)
+{
+   const uint32_t now_ms = timer_millis();
+   struct scheduler_task* task = scheduler_next_ready(now_ms);
+   if (!task) return false;
+
+   if (task->period_ms)
+   {
+      task->next_run_ms += task->period_ms;
+
+      if ((int32_t)(now_ms - task->next_run_ms) >= 0)
+      {
+         task->next_run_ms = now_ms + task->period_ms;
+      }
+   }
+
+   scheduler_current = task;
+   const uint32_t start_us = timer_micros();
+   task->function(task->arg);
+   const uint32_t time_us = timer_elapsed_us(start_us);
+   scheduler_current = 0;
+
+   task->stats.runs++;
+   task->stats.total_time_us += time_us;
+
+   if (time_us > task->stats.max_time_us)
+   {
+      task->stats.max_time_us = time_us < UINT16_MAX ? (uint16_t)time_us : UINT16_MAX;
+   }
+
+   if (!task->period_ms) task->active = false;
+   return true;
+}
+
+/********************************************************************************
+* scheduler_has_ready_task: Indikerar ifall någon uppgift är redo att köras.
+********************************************************************************/
+bool scheduler_has_ready_task(void)
+{
+   return scheduler_next_ready(timer_millis()) != 0;
+}
+
+/********************************************************************************
+* scheduler_get_stats: Läser av körtidsstatistik för angiven uppgift.
+*                      Statistiken för en avslutad engångsuppgift eller en
+*                      borttagen uppgift kan läsas av till dess att platsen
+*                      återanvänds av scheduler_add. Ifall id inte motsvarar
+*                      någon uppgift som är aktiv eller har körts returneras
+*                      felkod 1, annars returneras 0.
+*
+*                      - id   : Uppgiftens id.
+*                      - stats: Pekare till strukt där statistiken lagras.
+********************************************************************************/
+int scheduler_get_stats(const uint8_t id,
+                        struct scheduler_task_stats* stats)
+{
+   if (id >= SCHEDULER_MAX_TASKS) return 1;
+   if (!scheduler_tasks[id].active && !scheduler_tasks[id].stats.runs) return 1;
+   *stats = scheduler_tasks[id].stats;
+   return 0;
+}
+
+/********************************************************************************
+* scheduler_next_ready: Returnerar den uppgift som är redo och har högst
+*                       prioritet, vid lika prioritet den som har väntat
+*                       längst. Ifall ingen uppgift är redo returneras null.
+*
+*                       - now_ms: Aktuell tid mätt i millisekunder.
+********************************************************************************/
+static struct scheduler_task* scheduler_next_ready(const uint32_t now_ms)
+{
+   struct scheduler_task* next = 0;
+
+   for (uint8_t i = 0; i < SCHEDULER_MAX_TASKS; ++i)
+   {
+      struct scheduler_task* task = &scheduler_tasks[i];
+      if (!task->active || (int32_t)(now_ms - task->next_run_ms) < 0) continue;
+
+      if (!next || task->priority < next->priority ||
+          (task->priority == next->priority && (int32_t)(task->next_run_ms - next->next_run_ms) < 0))
+      {
+         next = task;
+      }
+   }
+
+   return next;
+}
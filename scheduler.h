@@ -0,0 +1,105 @@
+/********************************************************************************
+* scheduler.h: Innehåller funktionalitet för en kooperativ schemaläggare, där
+*              ett fast antal uppgifter (tasks) körs till fullbordan från
+*              huvudloopen, antingen periodiskt eller en gång efter angiven
+*              fördröjning. Tidpunkterna baseras på systemticken (Timer 0).
+*
+*              Bland de uppgifter som är redo körs den med högst prioritet
+*              först (lägst värde), vid lika prioritet den som har väntat
+*              längst. En uppgift avbryts aldrig av en annan uppgift och bör
+*              därför vara kort samt inte anropa blockerande funktioner.
+*
+*              Körtiden för varje uppgift mäts via timer_micros, så att det
+*              går att se var processortiden förbrukas.
+********************************************************************************/
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+/* Inkluderingsdirektiv: */
+#include "misc.h"
+#include "timer.h"
+
+/* Maximalt antal uppgifter i schemaläggaren: */
+#ifndef SCHEDULER_MAX_TASKS
+#define SCHEDULER_MAX_TASKS 8
+#endif
+
+/********************************************************************************
+* scheduler_task_stats: Strukt för körtidsstatistik för en uppgift.
+********************************************************************************/
+struct scheduler_task_stats
+{
+   uint32_t runs;            /* Antalet körningar. */
+   uint32_t total_time_us;   /* Sammanlagd körtid mätt i mikrosekunder. */
+   uint16_t max_time_us;     /* Längsta körtid mätt i mikrosekunder. */
+};
+
+/********************************************************************************
+* scheduler_task: Strukt för en uppgift i schemaläggaren.
+********************************************************************************/
+struct scheduler_task
+{
+   void (*function)(void* arg);       /* Rutinen som ska köras. */
+   void* arg;                         /* Argument som passeras till rutinen. */
+   uint32_t next_run_ms;              /* Tidpunkt för nästa körning. */
+   uint16_t period_ms;                /* Periodtid, 0 = engångsuppgift. */
+   uint8_t priority;                  /* Prioritet, lägre värde går före. */
+   bool active;                       /* Indikerar ifall platsen används. */
+   struct scheduler_task_stats stats; /* Körtidsstatistik. */
+};
+
+/********************************************************************************
+* scheduler_add: Lägger till en uppgift i schemaläggaren. Systemticken
+*                startas vid behov. Ifall samtliga platser är upptagna
+*                returneras felkod 1, annars returneras 0.
+*
+*                - function : Rutinen som ska köras.
+*                - arg      : Argument som passeras till rutinen (eller null).
+*                - delay_ms : Fördröjning till första körningen.
+*                - period_ms: Periodtid, alternativt 0 för en engångsuppgift.
+*                - priority : Prioritet, där lägre värde går före.
+*                - id       : Pekare där uppgiftens id lagras (eller null).
+********************************************************************************/
+int scheduler_add(void (*function)(void* arg),
+                  void* arg,
+                  const uint16_t delay_ms,
+                  const uint16_t period_ms,
+                  const uint8_t priority,
+                  uint8_t* id);
+
+/********************************************************************************
+* scheduler_remove: Tar bort angiven uppgift ur schemaläggaren. Ifall id
+*                   inte motsvarar en aktiv uppgift returneras felkod 1,
+*                   annars returneras 0.
+*
+*                   - id: Uppgiftens id.
+********************************************************************************/
+int scheduler_remove(const uint8_t id);
+
+/********************************************************************************
+* scheduler_run_once: Kör den uppgift som är redo och har högst prioritet.
+*                     Returnerar true ifall en uppgift kördes, annars false.
+********************************************************************************/
+bool scheduler_run_once(void);
+
+/********************************************************************************
+* scheduler_has_ready_task: Indikerar ifall någon uppgift är redo att köras.
+*                           Kan anropas med avbrott inaktiverade före viloläge.
+********************************************************************************/
+bool scheduler_has_ready_task(void);
+
+/********************************************************************************
+* scheduler_get_stats: Läser av körtidsstatistik för angiven uppgift.
+*                      Statistiken för en avslutad engångsuppgift eller en
+*                      borttagen uppgift kan läsas av till dess att platsen
+*                      återanvänds av scheduler_add. Ifall id inte motsvarar
+*                      någon uppgift som är aktiv eller har körts returneras
+*                      felkod 1, annars returneras 0.
+*
+*                      - id   : Uppgiftens id.
+*                      - stats: Pekare till strukt där statistiken lagras.
+********************************************************************************/
+int scheduler_get_stats(const uint8_t id,
+                        struct scheduler_task_stats* stats);
+
+#endif /* SCHEDULER_H_ */
@@ -0,0 +1,296 @@
+/********************************************************************************
+* shift_register.c: Innehåller funktionsdefinitioner för utportar via en kedja
+*                   av skiftregister av typen 74HC595 samt avbrottsrutin för
+*                   avbrottsstyrd utskiftning via hårdvaru-SPI.
+********************************************************************************/
+#include "shift_register.h"
+
+/* Bitar på I/O-port B som används av hårdvaru-SPI: */
+#define SHIFT_REGISTER_LATCH 2 /* Låssignal (SS, pin 10). */
+#define SHIFT_REGISTER_MOSI  3 /* Seriell data (MOSI, pin 11). */
+#define SHIFT_REGISTER_SCK   5 /* Klocksignal (SCK, pin 13). */
+
+/* Statiska variabler: */
+static uint8_t shift_register_shadow[SHIFT_REGISTER_MAX_CHIPS]; /* Skuggbuffert. */
+static uint8_t shift_register_tx[SHIFT_REGISTER_MAX_CHIPS];     /* Ögonblicksbild under utskiftning. */
+static uint8_t shift_register_num_chips = 0;                    /* Antalet skiftregister. */
+static bool shift_register_use_interrupt = false;               /* Avbrottsstyrd utskiftning. */
+static volatile bool shift_register_dirty = false;              /* Ändringar sedan utskiftning. */
+static volatile bool shift_register_busy = false;               /* Utskiftning pågår. */
+static volatile uint8_t shift_register_tx_index = 0;            /* Nästa byte att skifta ut. */
+static volatile uint8_t shift_register_depth = 0;               /* Nästlingsdjup för grupper. */
+
+/* Statiska funktioner: */
+static void shift_register_latch(void);
+static void shift_register_transfer(void);
+static void shift_register_start(void);
+
+/********************************************************************************
+* shift_register_init: Initierar hårdvaru-SPI som master med SCK = F_CPU / 2
+*                      samt angivet antal skiftregister i kedjan, varefter
+*                      samtliga utgångar släcks. Ifall antalet är 0 eller
+*                      överstiger SHIFT_REGISTER_MAX_CHIPS returneras
+*                      felkod 1, annars returneras 0.
+*
+*                      - num_chips    : Antalet skiftregister i kedjan.
+*                      - use_interrupt: Indikerar ifall utskiftningen ska ske
+*                                       avbrottsstyrt i stället för blockerande.
+********************************************************************************/
+int shift_register_init(const uint8_t num_chips,
+                        const bool use_interrupt)
+{
+   if (num_chips == 0 || num_chips > SHIFT_REGISTER_MAX_CHIPS) return 1;
+   shift_register_flush();
+
+   REG_CLEAR(PORTB, 1 << SHIFT_REGISTER_LATCH);
+   REG_SET(DDRB, (1 << SHIFT_REGISTER_LATCH) | (1 << SHIFT_REGISTER_MOSI) | (1 << SHIFT_REGISTER_SCK));
+   REG_WRITE(SPCR, (1 << SPE) | (1 << MSTR));
+   REG_WRITE(SPSR, 1 << SPI2X);
+
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      for (uint8_t i = 0; i < SHIFT_REGISTER_MAX_CHIPS; ++i)
+      {
+         shift_register_shadow[i] = 0;
+      }
+
+      shift_register_num_chips = num_chips;
+      shift_register_use_interrupt = use_interrupt;
+      shift_register_depth = 0;
+      shift_register_dirty = true;
+   }
+
+   shift_register_commit();
+   return 0;
+}
+
+/********************************************************************************
+* shift_register_num_outputs: Returnerar antalet utgångar i kedjan.
+********************************************************************************/
+uint16_t shift_register_num_outputs(void)
+{
+   return (uint16_t)shift_register_num_chips * 8;
+}
+
+/********************************************************************************
+* shift_register_write: Sätter angiven utgång i skuggbufferten. Utgången
+*                       uppdateras först vid nästa shift_register_commit.
+*                       Utgångar utanför kedjan ignoreras.
+*
+*                       - output : Utgångens nummer.
+*                       - enabled: Indikerar ifall utgången ska vara hög.
+********************************************************************************/
+void shift_register_write(const uint8_t output,
+                          const bool enabled)
+{
+   const uint8_t mask = 1 << (output & 0x07);
+   if (output >= shift_register_num_outputs()) return;
+
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      uint8_t* byte = &shift_register_shadow[output >> 3];
+      const uint8_t value = enabled ? *byte | mask : *byte & ~mask;
+
+      if (value != *byte)
+      {
+         *byte = value;
+         shift_register_dirty = true;
+      }
+   }
+
+   return;
+}
+
+/********************************************************************************
+* shift_register_toggle: Togglar angiven utgång i skuggbufferten. Utgången
+*                        uppdateras först vid nästa shift_register_commit.
+*                        Utgångar utanför kedjan ignoreras.
+*
+*                        - output: Utgångens nummer.
+********************************************************************************/
+void shift_register_toggle(const uint8_t output)
+{
+   if (output >= shift_register_num_outputs()) return;
+
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      shift_register_shadow[output >> 3] ^= 1 << (output & 0x07);
+      shift_register_dirty = true;
+   }
+
+   return;
+}
+
+/********************************************************************************
+* shift_register_read: Indikerar ifall angiven utgång är hög i skuggbufferten.
+*
+*                      - output: Utgångens nummer.
+********************************************************************************/
+bool shift_register_read(const uint8_t output)
+{
+   if (output >= shift_register_num_outputs()) return false;
+   return shift_register_shadow[output >> 3] & (1 << (output & 0x07));
+}
+
+/********************************************************************************
+* shift_register_begin: Påbörjar en grupp av ändringar, så att
+*                       shift_register_commit inte skiftar ut bufferten förrän
+*                       motsvarande shift_register_end har anropats. Grupper
+*                       kan nästlas.
+********************************************************************************/
+void shift_register_begin(void)
+{
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      shift_register_depth++;
+   }
+
+   return;
+}
+
+/********************************************************************************
+* shift_register_end: Avslutar en grupp av ändringar påbörjad via
+*                     shift_register_begin. När den yttersta gruppen avslutas
+*                     skiftas eventuella ändringar ut i en enda skur.
+********************************************************************************/
+void shift_register_end(void)
+{
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      if (shift_register_depth) shift_register_depth--;
+   }
+
+   shift_register_commit();
+   return;
+}
+
+/********************************************************************************
+* shift_register_commit: Skiftar ut skuggbufferten till kedjan ifall den har
+*                        ändrats sedan föregående utskiftning. Inom en grupp
+*                        (se shift_register_begin) skjuts utskiftningen upp.
+*                        Vid avbrottsstyrd utskiftning returnerar funktionen
+*                        direkt. Pågår redan en utskiftning genomförs en ny
+*                        direkt efter denna, så att senaste tillstånd alltid
+*                        når utgångarna.
+*
+*                        Den blockerande utskiftningen sker med avbrott
+*                        inaktiverade, så att en utskiftning från
+*                        avbrottskontext aldrig kan avbryta en pågående skur.
+********************************************************************************/
+void shift_register_commit(void)
+{
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      if (!shift_register_depth && shift_register_dirty && shift_register_num_chips)
+      {
+         if (!shift_register_use_interrupt)
+         {
+            shift_register_transfer();
+         }
+         else if (!shift_register_busy)
+         {
+            shift_register_start();
+         }
+      }
+   }
+
+   return;
+}
+
+/********************************************************************************
+* shift_register_is_busy: Indikerar ifall en avbrottsstyrd utskiftning pågår.
+********************************************************************************/
+bool shift_register_is_busy(void)
+{
+   return shift_register_busy;
+}
+
+/********************************************************************************
+* shift_register_flush: Väntar tills eventuell pågående avbrottsstyrd
+*                       utskiftning är slutförd. Avbrott måste vara aktiverade.
+*                       Väntan sker på SPIE, som nollställs av avbrottsrutinen
+*                       när den sista utskiftningen är klar.
+********************************************************************************/
+void shift_register_flush(void)
+{
+   while (REG_READ(SPCR) & (1 << SPIE));
+   return;
+}
+
+/********************************************************************************
+* shift_register_latch: Genererar en puls på låssignalen, varvid innehållet i
+*                       skiftregistren förs över till utgångarna samtidigt.
+********************************************************************************/
+static void shift_register_latch(void)
+{
+   REG_SET(PORTB, 1 << SHIFT_REGISTER_LATCH);
+   REG_CLEAR(PORTB, 1 << SHIFT_REGISTER_LATCH);
+   return;
+}
+
+/********************************************************************************
+* shift_register_transfer: Skiftar ut skuggbufferten blockerande, med sista
+*                          skiftregistret i kedjan först, och låser sedan
+*                          utgångarna. Anropas med avbrott inaktiverade.
+********************************************************************************/
+static void shift_register_transfer(void)
+{
+   for (uint8_t i = shift_register_num_chips; i > 0; --i)
+   {
+      REG_WRITE(SPDR, shift_register_shadow[i - 1]);
+      while (!(REG_READ(SPSR) & (1 << SPIF)));
+   }
+
+   shift_register_dirty = false;
+   shift_register_latch();
+   return;
+}
+
+/********************************************************************************
+* shift_register_start: Tar en ögonblicksbild av skuggbufferten i
+*                       utskiftningsordning och startar avbrottsstyrd
+*                       utskiftning av första byten. Resterande byte skiftas
+*                       ut från SPI_STC_vect. Anropas med avbrott inaktiverade.
+********************************************************************************/
+static void shift_register_start(void)
+{
+   for (uint8_t i = 0; i < shift_register_num_chips; ++i)
+   {
+      shift_register_tx[i] = shift_register_shadow[shift_register_num_chips - 1 - i];
+   }
+
+   shift_register_dirty = false;
+   shift_register_busy = true;
+   shift_register_tx_index = 1;
+   REG_SET(SPCR, 1 << SPIE);
+   REG_WRITE(SPDR, shift_register_tx[0]);
+   return;
+}
+
+/********************************************************************************
+* ISR (SPI_STC_vect): Avbrottsrutin som anropas då en byte har skiftats ut.
+*                     Nästa byte i ögonblicksbilden skiftas ut, alternativt
+*                     låses utgångarna när samtliga byte är utskiftade. Har
+*                     skuggbufferten ändrats under tiden startas en ny
+*                     utskiftning direkt, annars inaktiveras avbrottet.
+********************************************************************************/
+ISR (SPI_STC_vect)
+{
+   if (shift_register_tx_index < shift_register_num_chips)
+   {
+      REG_WRITE(SPDR, shift_register_tx[shift_register_tx_index++]);
+      return;
+   }
+
+   shift_register_latch();
+
+   if (shift_register_dirty && !shift_register_depth)
+   {
+      shift_register_start();
+   }
+   else
+   {
+      REG_CLEAR(SPCR, 1 << SPIE);
+      shift_register_busy = false;
+   }
+}
@@ -0,0 +1,128 @@
+/********************************************************************************
+* shift_register.h: Innehåller funktionalitet för utportar via en kedja av
+*                   seriekopplade skiftregister av typen 74HC595, vilket
+*                   möjliggör betydligt fler lysdioder än de 20 pins som finns
+*                   på Arduino Uno.
+*
+*                   Utgångarnas tillstånd lagras i en skuggbuffert i RAM, där
+*                   utgång n motsvarar bit n % 8 i skiftregister n / 8, räknat
+*                   från det skiftregister som är anslutet till mikrodatorn.
+*                   Bufferten skiftas ut via hårdvaru-SPI (8 MHz) i en enda
+*                   skur per uppdatering, varefter samtliga utgångar
+*                   uppdateras samtidigt via en puls på låssignalen.
+*
+*                   Inkoppling (Arduino Uno):
+*
+*                   Signal              Pin      74HC595
+*                   MOSI                11 (B3)  SER (första skiftregistret)
+*                   SCK                 13 (B5)  SRCLK (samtliga)
+*                   Låssignal (SS)      10 (B2)  RCLK (samtliga)
+*
+*                   Q7' på varje skiftregister ansluts till SER på nästa.
+*                   Pin 10, 11 och 13 kan därmed inte användas för lysdioder
+*                   via led_init medan skiftregisterkedjan används.
+*
+*                   Utskiftningen sker antingen blockerande (cirka 1 us per
+*                   skiftregister) eller avbrottsstyrt via SPI_STC_vect, där
+*                   en ögonblicksbild av skuggbufferten skiftas ut i
+*                   bakgrunden.
+********************************************************************************/
+#ifndef SHIFT_REGISTER_H_
+#define SHIFT_REGISTER_H_
+
+/* Inkluderingsdirektiv: */
+#include "misc.h"
+
+/* Maximalt antal skiftregister i kedjan (8 utgångar per skiftregister): */
+#ifndef SHIFT_REGISTER_MAX_CHIPS
+#define SHIFT_REGISTER_MAX_CHIPS 8
+#endif
+
+#if SHIFT_REGISTER_MAX_CHIPS > 32
+#error "SHIFT_REGISTER_MAX_CHIPS får vara högst 32 (256 utgångar)."
+#endif
+
+/********************************************************************************
+* shift_register_init: Initierar hårdvaru-SPI som master med SCK = F_CPU / 2
+*                      samt angivet antal skiftregister i kedjan, varefter
+*                      samtliga utgångar släcks. Ifall antalet är 0 eller
+*                      överstiger SHIFT_REGISTER_MAX_CHIPS returneras
+*                      felkod 1, annars returneras 0.
+*
+*                      - num_chips    : Antalet skiftregister i kedjan.
+*                      - use_interrupt: Indikerar ifall utskiftningen ska ske
+*                                       avbrottsstyrt i stället för blockerande.
+********************************************************************************/
+int shift_register_init(const uint8_t num_chips,
+                        const bool use_interrupt);
+
+/********************************************************************************
+* shift_register_num_outputs: Returnerar antalet utgångar i kedjan.
+********************************************************************************/
+uint16_t shift_register_num_outputs(void);
+
+/********************************************************************************
+* shift_register_write: Sätter angiven utgång i skuggbufferten. Utgången
+*                       uppdateras först vid nästa shift_register_commit.
+*                       Utgångar utanför kedjan ignoreras.
+*
+*                       - output : Utgångens nummer.
+*                       - enabled: Indikerar ifall utgången ska vara hög.
+********************************************************************************/
+void shift_register_write(const uint8_t output,
+                          const bool enabled);
+
+/********************************************************************************
+* shift_register_toggle: Togglar angiven utgång i skuggbufferten. Utgången
+*                        uppdateras först vid nästa shift_register_commit.
+*                        Utgångar utanför kedjan ignoreras.
+*
+*                        - output: Utgångens nummer.
+********************************************************************************/
+void shift_register_toggle(const uint8_t output);
+
+/********************************************************************************
+* shift_register_read: Indikerar ifall angiven utgång är hög i skuggbufferten.
+*
+*                      - output: Utgångens nummer.
+********************************************************************************/
+bool shift_register_read(const uint8_t output);
+
+/********************************************************************************
+* shift_register_begin: Påbörjar en grupp av ändringar, så att
+*                       shift_register_commit inte skiftar ut bufferten förrän
+*                       motsvarande shift_register_end har anropats. Grupper
+*                       kan nästlas.
+********************************************************************************/
+void shift_register_begin(void);
+
+/********************************************************************************
+* shift_register_end: Avslutar en grupp av ändringar påbörjad via
+*                     shift_register_begin. När den yttersta gruppen avslutas
+*                     skiftas eventuella ändringar ut i en enda skur.
+********************************************************************************/
+void shift_register_end(void);
+
+/********************************************************************************
+* shift_register_commit: Skiftar ut skuggbufferten till kedjan ifall den har
+*                        ändrats sedan föregående utskiftning. Inom en grupp
+*                        (se shift_register_begin) skjuts utskiftningen upp.
+*                        Vid avbrottsstyrd utskiftning returnerar funktionen
+*                        direkt. Pågår redan en utskiftning genomförs en ny
+*                        direkt efter denna, så att senaste tillstånd alltid
+*                        når utgångarna.
+********************************************************************************/
+void shift_register_commit(void);
+
+/********************************************************************************
+* shift_register_is_busy: Indikerar ifall en avbrottsstyrd utskiftning pågår.
+********************************************************************************/
+bool shift_register_is_busy(void);
+
+/********************************************************************************
+* shift_register_flush: Väntar tills eventuell pågående avbrottsstyrd
+*                       utskiftning är slutförd. Avbrott måste vara aktiverade.
+********************************************************************************/
+void shift_register_flush(void);
+
+#endif /* SHIFT_REGISTER_H_ */
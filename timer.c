@@ -0,0 +1,183 @@
+/********************************************************************************
+* timer.c: Innehåller funktionsdefinitioner för systemticken på Timer 0.
+********************************************************************************/
+#include "timer.h"
+
+/* Statiska variabler: */
+static void (*timer_callbacks[TIMER_MAX_CALLBACKS])(void); /* Inkopplade rutiner. */
+static volatile uint8_t timer_num_callbacks = 0; /* Antalet inkopplade rutiner. */
+static volatile uint32_t timer_tick_counter = 0; /* Antalet ticks sedan start. */
+static bool timer_initialized = false;           /* Indikerar ifall ticken är igång. */
+
+/********************************************************************************
+* timer_init: Startar systemticken på Timer 0 samt aktiverar avbrott globalt.
+*             Ifall systemticken redan är igång sker ingen åtgärd.
+********************************************************************************/
+void timer_init(void)
+{
+   if (timer_initialized) return;
+
+   REG_WRITE(TCCR0A, 1 << WGM01);
+   REG_WRITE(TCCR0B, (1 << CS01) | (1 << CS00));
+   REG_WRITE(OCR0A, 249);
+   REG_SET(TIMSK0, 1 << OCIE0A);
+   timer_initialized = true;
+   sei();
+   return;
+}
+
+/********************************************************************************
+* timer_attach: Kopplar angiven callbackrutin till systemticken, så att den
+*               anropas från avbrottsrutinen en gång per millisekund.
+*               Systemticken startas automatiskt vid behov. Om rutinen redan
+*               är inkopplad sker ingen åtgärd. Ifall samtliga platser är
+*               upptagna returneras felkod 1, annars returneras 0.
+*
+*               - callback: Pekare till rutinen som ska anropas vid varje tick.
+********************************************************************************/
+int timer_attach(void (*callback)(void))
+{
+   for (uint8_t i = 0; i < timer_num_callbacks; ++i)
+   {
+      if (timer_callbacks[i] == callback) return 0;
+   }
+
+   if (timer_num_callbacks >= TIMER_MAX_CALLBACKS) return 1;
+
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      timer_callbacks[timer_num_callbacks++] = callback;
+   }
+
+   timer_init();
+   return 0;
+}
+
+/********************************************************************************
+* timer_detach: Kopplar bort angiven callbackrutin från systemticken.
+*
+*               - callback: Pekare till rutinen som ska kopplas bort.
+********************************************************************************/
+void timer_detach(void (*callback)(void))
+{
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      for (uint8_t i = 0; i < timer_num_callbacks; ++i)
+      {
+         if (timer_callbacks[i] == callback)
+         {
+            timer_callbacks[i] = timer_callbacks[--timer_num_callbacks];
+            break;
+         }
+      }
+   }
+
+   return;
+}
+
+/********************************************************************************
+* timer_ticks: Returnerar antalet ticks (millisekunder) sedan systemticken
+*              startades. Läsningen sker atomärt och kan därmed göras säkert
+*              även medan avbrott är aktiverade.
+********************************************************************************/
+uint32_t timer_ticks(void)
+{
+   uint32_t ticks;
+
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      ticks = timer_tick_counter;
+   }
+
+   return ticks;
+}
+
+/********************************************************************************
+* timer_is_running: Indikerar ifall systemticken har startats.
+********************************************************************************/
+bool timer_is_running(void)
+{
+   return timer_initialized;
+}
+
+/********************************************************************************
+* timer_millis: Returnerar monoton tid i millisekunder sedan systemticken
+*               startades.
+********************************************************************************/
+uint32_t timer_millis(void)
+{
+   return timer_ticks();
+}
+
+/********************************************************************************
+* timer_micros: Returnerar monoton tid i mikrosekunder sedan systemticken
+*               startades. Varje tick motsvarar 1000 us och varje räknesteg
+*               i TCNT0 motsvarar 4 us. Om flaggan OCF0A är ettställd
+*               medan TCNT0 redan har nollställts har en tick ännu inte
+*               räknats av avbrottsrutinen, varför den läggs till här.
+********************************************************************************/
+uint32_t timer_micros(void)
+{
+   uint32_t ticks;
+   uint8_t count;
+   bool pending;
+
+   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+   {
+      ticks = timer_tick_counter;
+      count = REG_READ(TCNT0);
+      pending = REG_READ(TIFR0) & (1 << OCF0A);
+   }
+
+   if (pending && count < 249) ticks++;
+   return ticks * 1000UL + count * 4UL;
+}
+
+/********************************************************************************
+* timer_deadline_reached: Indikerar ifall angiven tidpunkt mätt i
+*                         millisekunder har passerats.
+*
+*                         - deadline_ms: Tidpunkten, exempelvis
+*                                        timer_millis() + 100.
+********************************************************************************/
+bool timer_deadline_reached(const uint32_t deadline_ms)
+{
+   return (int32_t)(timer_millis() - deadline_ms) >= 0;
+}
+
+/********************************************************************************
+* timer_elapsed_ms: Returnerar antalet millisekunder som har förflutit sedan
+*                   angiven tidpunkt.
+*
+*                   - start_ms: Starttidpunkten, exempelvis från timer_millis.
+********************************************************************************/
+uint32_t timer_elapsed_ms(const uint32_t start_ms)
+{
+   return timer_millis() - start_ms;
+}
+
+/********************************************************************************
+* timer_elapsed_us: Returnerar antalet mikrosekunder som har förflutit sedan
+*                   angiven tidpunkt.
+*
+*                   - start_us: Starttidpunkten, exempelvis från timer_micros.
+********************************************************************************/
+uint32_t timer_elapsed_us(const uint32_t start_us)
+{
+   return timer_micros() - start_us;
+}
+
+/********************************************************************************
+* ISR (TIMER0_COMPA_vect): Avbrottsrutin som äger rum varje millisekund vid
+*                          compare match för Timer 0. Tickräknaren räknas upp,
+*                          varefter samtliga inkopplade callbackrutiner anropas.
+********************************************************************************/
+ISR (TIMER0_COMPA_vect)
+{
+   timer_tick_counter++;
+
+   for (uint8_t i = 0; i < timer_num_callbacks; ++i)
+   {
+      timer_callbacks[i]();
+   }
+}
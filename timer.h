@@ -0,0 +1,106 @@
+/********************************************************************************
+* timer.h: Innehåller funktionalitet för en systemtick på 1 ms, realiserad via
+*          Timer 0 i CTC-mode. Vid varje tick anropas de callbackrutiner som
+*          har kopplats in via timer_attach, vilket används för att driva
+*          blinkning och andra tidsstyrda förlopp utan fördröjningsrutiner.
+*
+*          Timer 0 räknar med prescaler 64, vilket vid 16 MHz ger 4 us per
+*          räknesteg. Med OCR0A = 249 genereras därmed avbrott var 250:e
+*          räknesteg, dvs. exakt en gång per millisekund.
+********************************************************************************/
+#ifndef TIMER_H_
+#define TIMER_H_
+
+/* Inkluderingsdirektiv: */
+#include "misc.h"
+
+/* Maximalt antal callbackrutiner som kan kopplas till systemticken: */
+#ifndef TIMER_MAX_CALLBACKS
+#define TIMER_MAX_CALLBACKS 8
+#endif
+
+/********************************************************************************
+* timer_init: Startar systemticken på Timer 0 samt aktiverar avbrott globalt.
+*             Ifall systemticken redan är igång sker ingen åtgärd.
+********************************************************************************/
+void timer_init(void);
+
+/********************************************************************************
+* timer_attach: Kopplar angiven callbackrutin till systemticken, så att den
+*               anropas från avbrottsrutinen en gång per millisekund.
+*               Systemticken startas automatiskt vid behov. Om rutinen redan
+*               är inkopplad sker ingen åtgärd. Ifall samtliga platser är
+*               upptagna returneras felkod 1, annars returneras 0.
+*
+*               Callbackrutinen exekveras i avbrottskontext och bör därför
+*               vara kort samt inte anropa blockerande funktioner.
+*
+*               - callback: Pekare till rutinen som ska anropas vid varje tick.
+********************************************************************************/
+int timer_attach(void (*callback)(void));
+
+/********************************************************************************
+* timer_detach: Kopplar bort angiven callbackrutin från systemticken.
+*
+*               - callback: Pekare till rutinen som ska kopplas bort.
+********************************************************************************/
+void timer_detach(void (*callback)(void));
+
+/********************************************************************************
+* timer_ticks: Returnerar antalet ticks (millisekunder) sedan systemticken
+*              startades. Läsningen sker atomärt och kan därmed göras säkert
+*              även medan avbrott är aktiverade.
+********************************************************************************/
+uint32_t timer_ticks(void);
+
+/********************************************************************************
+* timer_is_running: Indikerar ifall systemticken har startats.
+********************************************************************************/
+bool timer_is_running(void);
+
+/********************************************************************************
+* timer_millis: Returnerar monoton tid i millisekunder sedan systemticken
+*               startades. Värdet slår runt efter cirka 49,7 dygn, vilket
+*               hanteras av timer_deadline_reached samt timer_elapsed_ms.
+********************************************************************************/
+uint32_t timer_millis(void);
+
+/********************************************************************************
+* timer_micros: Returnerar monoton tid i mikrosekunder sedan systemticken
+*               startades, med en upplösning på 4 us (ett räknesteg för
+*               Timer 0). Räknarvärdet samt tickräknaren läses atomärt. Ifall
+*               en compare match har inträffat men avbrottsrutinen ännu inte
+*               har exekverats räknas denna tick med. Värdet slår runt efter
+*               cirka 71,6 minuter.
+********************************************************************************/
+uint32_t timer_micros(void);
+
+/********************************************************************************
+* timer_deadline_reached: Indikerar ifall angiven tidpunkt mätt i
+*                         millisekunder har passerats. Jämförelsen görs via
+*                         differensen som ett tal med tecken, vilket ger rätt
+*                         resultat även när klockan slår runt, förutsatt att
+*                         tidpunkten ligger mindre än cirka 24,8 dygn bort.
+*
+*                         - deadline_ms: Tidpunkten, exempelvis
+*                                        timer_millis() + 100.
+********************************************************************************/
+bool timer_deadline_reached(const uint32_t deadline_ms);
+
+/********************************************************************************
+* timer_elapsed_ms: Returnerar antalet millisekunder som har förflutit sedan
+*                   angiven tidpunkt, korrekt även när klockan slår runt.
+*
+*                   - start_ms: Starttidpunkten, exempelvis från timer_millis.
+********************************************************************************/
+uint32_t timer_elapsed_ms(const uint32_t start_ms);
+
+/********************************************************************************
+* timer_elapsed_us: Returnerar antalet mikrosekunder som har förflutit sedan
+*                   angiven tidpunkt, korrekt även när klockan slår runt.
+*
+*                   - start_us: Starttidpunkten, exempelvis från timer_micros.
+********************************************************************************/
+uint32_t timer_elapsed_us(const uint32_t start_us);
+
+#endif /* TIMER_H_ */